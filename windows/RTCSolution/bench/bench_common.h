@@ -0,0 +1,27 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace vrd {
+namespace bench {
+
+// Runs fn in batches for at least min_ms and returns the fastest batch in ns per call
+inline double measure(int min_ms, const std::function<void()>& fn) {
+    using Clock = std::chrono::steady_clock;
+    fn();
+    int batch = 1;
+    double best = 1e300;
+    auto begin = Clock::now();
+    while (std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count() < min_ms) {
+        auto start = Clock::now();
+        for (int i = 0; i < batch; i++) fn();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / batch;
+        best = std::min(best, ns);
+        if (ns * batch < 1e6) batch *= 2;
+    }
+    return best;
+}
+
+}  // namespace bench
+}  // namespace vrd
@@ -0,0 +1,430 @@
+// Measures the client-side hot paths that run without the SDK or a window.
+// Prints one CSV row per case: benchmark,case,ns_per_op,ops_per_s
+// Headless, QT_QPA_PLATFORM is not needed since only QtCore objects are created.
+// Exits non-zero when forwarding an SDK event through EventBus and BlobArena touches the heap.
+//
+// Usage: hotpath_bench [min_ms_per_case] [benchmark_filter]
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench/bench_common.h"
+#include "core/Util.h"
+#include "core/event_bus.h"
+#include "core/forward_event.h"
+#include "core/rtc_event.h"
+#include "core/session_message.h"
+#include "feature/logger.h"
+#include "videocall/core/participant_store.h"
+
+// Every heap allocation of the process, read around the code that must not allocate
+static std::atomic<uint64_t> g_allocations{ 0 };
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+namespace {
+
+int g_min_ms = 200;
+std::string g_filter;
+int g_failures = 0;
+
+bool enabled(const char* benchmark) {
+    return g_filter.empty() || std::string(benchmark).find(g_filter) != std::string::npos;
+}
+
+void report(const char* benchmark, const std::string& name, double ns) {
+    printf("%s,%s,%.1f,%.0f\n", benchmark, name.c_str(), ns, 1e9 / ns);
+    fflush(stdout);
+}
+
+double measure(const std::function<void()>& fn) {
+    return vrd::bench::measure(g_min_ms, fn);
+}
+
+// Dispatches ForwardEvents the way RtcEngineWrap and VideoCallManager do, and drains an EventBus on wake-up
+class Receiver : public QObject {
+public:
+    std::function<void()> on_wake;
+
+protected:
+    void customEvent(QEvent* e) override {
+        if (vrd::EventBusBase::isWakeEvent(e)) {
+            if (on_wake) on_wake();
+            return;
+        }
+        if (e->type() == QEvent::User) {
+            static_cast<ForwardEvent*>(e)->execTask();
+        }
+    }
+};
+
+void benchForwardEvent() {
+    if (!enabled("forward_event")) return;
+    const int kBurst = 1000;
+    Receiver receiver;
+    uint64_t handled = 0;
+
+    double ns = measure([&] {
+        for (int i = 0; i < kBurst; i++) {
+            ForwardEvent::PostEvent(&receiver, [&handled] { handled++; });
+        }
+        QCoreApplication::sendPostedEvents(&receiver);
+    });
+    report("forward_event", "post_dispatch_same_thread", ns / kBurst);
+
+    // The SDK posts from its own threads, the UI thread only dispatches
+    ns = measure([&] {
+        std::thread producer([&] {
+            for (int i = 0; i < kBurst; i++) {
+                ForwardEvent::PostEvent(&receiver, [&handled] { handled++; });
+            }
+        });
+        producer.join();
+        QCoreApplication::sendPostedEvents(&receiver);
+    });
+    report("forward_event", "post_dispatch_cross_thread", ns / kBurst);
+
+    // Same burst through the ring buffer bus the engine callbacks use
+    vrd::EventBus<uint64_t> bus(&receiver, [&handled](uint64_t& value) { handled += value; });
+    receiver.on_wake = [&bus] { bus.drain(); };
+    ns = measure([&] {
+        std::thread producer([&] {
+            for (int i = 0; i < kBurst; i++) {
+                bus.post(1);
+            }
+        });
+        producer.join();
+        QCoreApplication::sendPostedEvents(&receiver);
+    });
+    report("forward_event", "event_bus_cross_thread", ns / kBurst);
+    if (handled == 0) printf("# nothing dispatched\n");
+}
+
+template <size_t N>
+struct InlinePayload {
+    unsigned char bytes[N];
+};
+
+// Posts a burst of events with an N-byte inline payload and a short string blob the way RtcEngineWrap
+// forwards callbacks, half on each lane, and fails when posting or dispatching them allocates
+template <size_t N>
+void checkEventAllocations(Receiver& receiver) {
+    const std::string name = "no_alloc_inline_" + std::to_string(N) + "b";
+    const int kBurst = 1000;
+    vrd::BlobArena arena;
+    uint64_t handled = 0;
+    auto release = [&arena](vrd::RtcEvent& event) { arena.release(event.blob); };
+    vrd::PriorityEventBus<vrd::RtcEvent> bus(&receiver,
+        [&](vrd::RtcEvent& event) {
+            handled += event.payloadAs<InlinePayload<N>>().bytes[0] + strlen(arena.string(event.blob, 1));
+            release(event);
+        },
+        &vrd::rtcEventCoalesceKey, vrd::kRtcEventTypeCount, release);
+    receiver.on_wake = [&bus] { bus.drain(); };
+
+    InlinePayload<N> payload;
+    memset(payload.bytes, 1, N);
+    auto post = [&](int i) {
+        vrd::RtcEvent event;
+        event.type = i % 2 ? vrd::RtcEventType::kRoomStats : vrd::RtcEventType::kUserJoined;
+        event.room = i % 4 == 1 ? 1 : 0;
+        event.setPayload(payload);
+        event.blob = arena.storeStrings({ "bench_room_0001", "user_42" });
+        auto blob = event.blob;
+        auto lane = vrd::isRtcTelemetryEvent(event.type)
+            ? vrd::PriorityEventBus<vrd::RtcEvent>::Lane::kTelemetry
+            : vrd::PriorityEventBus<vrd::RtcEvent>::Lane::kControl;
+        if (!bus.post(std::move(event), lane)) arena.release(blob);
+    };
+
+    // The first post of a burst allocates the wake-up QEvent, that one is per burst and not per event
+    auto burst = [&] {
+        post(0);
+        auto before = g_allocations.load(std::memory_order_relaxed);
+        for (int i = 1; i < kBurst; i++) post(i);
+        bus.drain();
+        auto allocations = g_allocations.load(std::memory_order_relaxed) - before;
+        QCoreApplication::sendPostedEvents(&receiver);
+        return allocations;
+    };
+
+    burst();
+    auto allocations = burst();
+    double ns = measure([&] {
+        for (int i = 0; i < kBurst; i++) post(i);
+        QCoreApplication::sendPostedEvents(&receiver);
+    });
+    report("event_allocs", name, ns / kBurst);
+    receiver.on_wake = nullptr;
+
+    if (allocations || arena.stats().heap_fallbacks || arena.stats().in_use) {
+        fprintf(stderr, "event_allocs,%s: %llu allocations, %llu heap fallbacks, %zu blocks in use\n",
+            name.c_str(), static_cast<unsigned long long>(allocations),
+            static_cast<unsigned long long>(arena.stats().heap_fallbacks), arena.stats().in_use);
+        ++g_failures;
+    }
+    if (handled == 0) printf("# nothing dispatched\n");
+}
+
+void benchEventAllocations() {
+    if (!enabled("event_allocs")) return;
+    Receiver receiver;
+    checkEventAllocations<8>(receiver);
+    checkEventAllocations<64>(receiver);
+    checkEventAllocations<vrd::RtcEvent::kPayloadSize - 8>(receiver);
+}
+
+QJsonObject sampleContent() {
+    QJsonObject content;
+    content["login_token"] = "b0f1a3c5d7e9f1a3c5d7e9f1a3c5d7e9";
+    content["user_name"] = "bench_user";
+    content["room_id"] = "bench_room_0001";
+    content["camera"] = true;
+    content["mic"] = true;
+    return content;
+}
+
+std::string returnMessage(const QString& request_id) {
+    QJsonObject response;
+    response["user_id"] = "bench_user";
+    response["room_id"] = "bench_room_0001";
+    QJsonObject message;
+    message["message_type"] = "return";
+    message["request_id"] = request_id;
+    message["code"] = 200;
+    message["message"] = "ok";
+    message["response"] = response;
+    return vrd::session_message::encode(message);
+}
+
+std::string informMessage(const QString& event, int users) {
+    QJsonArray list;
+    for (int i = 0; i < users; i++) {
+        QJsonObject user;
+        user["user_id"] = QString("user_%1").arg(i);
+        user["user_name"] = QString("User %1").arg(i);
+        user["is_mic_on"] = true;
+        user["is_camera_on"] = i % 2 == 0;
+        list.append(user);
+    }
+    QJsonObject data;
+    data["room_id"] = "bench_room_0001";
+    data["user_list"] = list;
+    QJsonObject message;
+    message["message_type"] = "inform";
+    message["event"] = event;
+    message["data"] = data;
+    return vrd::session_message::encode(message);
+}
+
+void benchSessionMessages() {
+    if (!enabled("session_message")) return;
+    vrd::session_message::Request request;
+    request.app_id = "5f0c1d2e3a4b5c6d7e8f9a0b";
+    request.room_id = "bench_room_0001";
+    request.user_id = "bench_user";
+    request.event_name = "videocallJoinRoom";
+    request.request_id = "7c9e6679-7425-40de-944b-e07fc1f90ae7";
+    request.device_id = "3f2504e0-4f89-11d3-9a0c-0305e82c3301";
+    auto content = sampleContent();
+    size_t bytes = 0;
+
+    double ns = measure([&] {
+        auto message = vrd::session_message::buildRequest(request, content);
+        bytes += vrd::session_message::encode(message).size();
+    });
+    report("session_message", "emit_encode", ns);
+
+    // The same lookups SessionBase::onMessageReceived does after parsing
+    std::map<QString, std::function<void(const QJsonObject&)>> requests;
+    std::map<std::string, std::function<void(const QJsonObject&)>> listeners;
+    const char* kEvents[] = {
+        "videocallOnUserJoinRoom", "videocallOnUserLeaveRoom", "videocallOnFinishRoom",
+        "videocallOnUpdateMicStatus", "videocallOnUpdateCameraStatus", "videocallOnShareScreenStarted",
+        "videocallOnShareScreenStopped", "videocallOnCloseRoom", "videocallOnUserKickedOff",
+    };
+    for (auto event : kEvents) {
+        listeners[event] = [&bytes](const QJsonObject& data) { bytes += data.size(); };
+    }
+
+    auto reply = returnMessage(request.request_id);
+    ns = measure([&] {
+        requests[request.request_id] = [&bytes](const QJsonObject& response) { bytes += response.size(); };
+        auto incoming = vrd::session_message::parse(reply);
+        auto it = requests.find(incoming.request_id);
+        if (it != requests.end()) {
+            it->second(incoming.message);
+            requests.erase(it);
+        }
+    });
+    report("session_message", "receive_return", ns);
+
+    for (int users : { 1, 16, 100 }) {
+        auto inform = informMessage("videocallOnUserJoinRoom", users);
+        ns = measure([&] {
+            auto incoming = vrd::session_message::parse(inform);
+            auto it = listeners.find(incoming.event_name);
+            if (it != listeners.end()) it->second(incoming.data);
+        });
+        report("session_message", "receive_inform_users_" + std::to_string(users), ns);
+    }
+    if (bytes == 0) printf("# nothing encoded\n");
+}
+
+void benchMemoryPool() {
+    if (!enabled("memory_pool")) return;
+    struct Case {
+        const char* name;
+        unsigned int size;
+    };
+    const Case kCases[] = {
+        { "64b", 64 },
+        { "4kb", 4096 },
+        { "i420_360p", 640 * 360 * 3 / 2 },
+        { "i420_1080p", 1920 * 1080 * 3 / 2 },
+    };
+
+    for (bool zero : { true, false }) {
+        util::SimpleMemoryPool pool(zero);
+        for (const auto& c : kCases) {
+            double ns = measure([&] {
+                auto block = pool.Malloc(c.size);
+                block[0] = 1;
+                pool.Free(block);
+            });
+            report("memory_pool", std::string(zero ? "zeroed_" : "raw_") + c.name, ns);
+        }
+    }
+
+    // Frames are produced on a decode thread and released on the UI thread
+    util::SimpleMemoryPool pool(false);
+    const int kFrames = 256;
+    std::vector<unsigned char*> frames(kFrames);
+    double ns = measure([&] {
+        std::thread producer([&] {
+            for (auto& frame : frames) frame = pool.Malloc(640 * 360 * 3 / 2);
+        });
+        producer.join();
+        for (auto frame : frames) pool.Free(frame);
+    });
+    report("memory_pool", "cross_thread_i420_360p", ns / kFrames);
+
+    double baseline = measure([&] {
+        auto block = new unsigned char[640 * 360 * 3 / 2];
+        block[0] = 1;
+        delete[] block;
+    });
+    report("memory_pool", "new_delete_i420_360p", baseline);
+}
+
+void benchSpeakerVolumes() {
+    if (!enabled("speaker_volumes")) return;
+    for (int count : { 9, 50, 100 }) {
+        // Stored the way VideoCallManager folds a volume report into DataMgr's participants
+        videocall::ParticipantStore participants;
+        std::vector<std::pair<vrd::IdHandle, unsigned int>> report_items;
+        for (int i = 0; i < count; i++) {
+            videocall::User user;
+            user.user_handle = static_cast<vrd::IdHandle>(i + 1);
+            participants.add(user);
+            report_items.emplace_back(static_cast<vrd::IdHandle>(count - i), (i * 37) % 256);
+        }
+        participants.takeChanges();
+        vrd::IdHandle highlight = vrd::kInvalidIdHandle;
+        double ns = measure([&] {
+            videocall::SpeakerVolumes volumes([&participants](vrd::IdHandle uid, unsigned int volume) {
+                participants.update(uid, 0, [volume](videocall::Participant& participant) {
+                    participant.user.audio_volume = volume;
+                });
+            });
+            for (const auto& item : report_items) {
+                volumes.apply(item.first, item.second);
+            }
+            highlight = volumes.highlight();
+        });
+        report("speaker_volumes", "users_" + std::to_string(count), ns);
+        if (highlight == vrd::kInvalidIdHandle) printf("# no highlight\n");
+    }
+}
+
+void benchLogger() {
+    if (!enabled("log_output")) return;
+    // Test mode keeps the log file out of the real application data folder
+    QStandardPaths::setTestModeEnabled(true);
+    QMessageLogContext context;
+    const QString line = QStringLiteral("RtcEngineWrap::onRemoteStreamStats uid: user_42, kbps: 512, loss: 0.01");
+    double ns = measure([&] {
+        Common::log::outputMessage(QtDebugMsg, context, line);
+    });
+    report("log_output", "debug_line", ns);
+
+    ns = measure([&] {
+        std::thread first([&] {
+            for (int i = 0; i < 64; i++) Common::log::outputMessage(QtInfoMsg, context, line);
+        });
+        for (int i = 0; i < 64; i++) Common::log::outputMessage(QtInfoMsg, context, line);
+        first.join();
+    });
+    report("log_output", "two_threads", ns / 128);
+
+    auto dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/vertc_log";
+    QDir(dir).removeRecursively();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) g_min_ms = std::max(1, atoi(argv[1]));
+    if (argc > 2) g_filter = argv[2];
+
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("hotpath_bench");
+
+    printf("benchmark,case,ns_per_op,ops_per_s\n");
+    benchForwardEvent();
+    benchEventAllocations();
+    benchSessionMessages();
+    benchMemoryPool();
+    benchSpeakerVolumes();
+    benchLogger();
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+// Compares the image kernels at every SIMD level against the Qt path the thumbnails used to take.
+// Prints one CSV row per case: kernel,source,impl,ns_per_op,mpix_per_s
+// Before timing, checks that every SIMD level writes the same pixels as the scalar kernels over odd sizes and
+// padded strides, and exits non-zero without timing anything when one does not.
+//
+// Usage: image_kernels_bench [min_ms_per_case]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "bench/bench_common.h"
+#include "core/image_kernels.h"
+
+#ifdef VRD_BENCH_WITH_QT
+#include <QImage>
+#endif
+
+using namespace vrd::image;
+
+namespace {
+
+struct Size {
+    int width;
+    int height;
+};
+
+const Size kSizes[] = {
+    { 160, 90 }, { 320, 180 }, { 640, 360 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 },
+};
+const Size kThumbnail = { 160, 90 };
+// Widths and heights that leave a remainder after every vector width, including a single pixel
+const Size kOddSizes[] = {
+    { 1, 1 }, { 3, 1 }, { 1, 5 }, { 3, 3 }, { 7, 5 }, { 9, 7 }, { 15, 9 }, { 17, 17 }, { 31, 33 },
+    { 33, 31 }, { 63, 35 }, { 97, 55 }, { 161, 91 }, { 641, 361 },
+};
+
+int g_min_ms = 200;
+
+double measure(const std::function<void()>& fn) {
+    return vrd::bench::measure(g_min_ms, fn);
+}
+
+void report(const char* kernel, Size source, const std::string& impl, double ns, double pixels) {
+    printf("%s,%dx%d,%s,%.0f,%.1f\n", kernel, source.width, source.height, impl.c_str(), ns,
+        pixels / ns * 1e3);
+}
+
+std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> result;
+    for (int level = 0; level <= static_cast<int>(detectedSimdLevel()); level++) {
+        result.push_back(static_cast<SimdLevel>(level));
+    }
+    return result;
+}
+
+std::vector<uint8_t> randomBytes(size_t count) {
+    std::vector<uint8_t> bytes(count);
+    uint32_t state = 12345;
+    for (auto& b : bytes) {
+        state = state * 1664525u + 1013904223u;
+        b = static_cast<uint8_t>(state >> 24);
+    }
+    return bytes;
+}
+
+// Output of one kernel call into a buffer with padded rows, only the width * 4 bytes of each row are compared
+struct Output {
+    int stride;
+    std::vector<uint8_t> bytes;
+};
+
+Output run(Size dst, const std::function<void(uint8_t*, int)>& kernel) {
+    Output out;
+    out.stride = dst.width * 4 + 36;
+    out.bytes.assign(static_cast<size_t>(out.stride) * dst.height, 0);
+    kernel(out.bytes.data(), out.stride);
+    return out;
+}
+
+int g_mismatches = 0;
+
+// Runs kernel at the scalar level and at every SIMD level the CPU has, and reports the first differing pixel
+void verify(const char* kernel, Size source, Size dst, const std::function<void(uint8_t*, int)>& fn) {
+    setSimdLevel(SimdLevel::kScalar);
+    const auto expected = run(dst, fn);
+    for (auto level : levels()) {
+        if (level == SimdLevel::kScalar) continue;
+        setSimdLevel(level);
+        const auto actual = run(dst, fn);
+        for (int row = 0; row < dst.height; row++) {
+            auto want = expected.bytes.data() + static_cast<size_t>(row) * expected.stride;
+            auto got = actual.bytes.data() + static_cast<size_t>(row) * actual.stride;
+            auto diff = std::mismatch(want, want + dst.width * 4, got);
+            if (diff.first == want + dst.width * 4) continue;
+            const auto offset = diff.first - want;
+            fprintf(stderr, "%s %dx%d -> %dx%d: %s differs from scalar at pixel (%d,%d) byte %d: %d != %d\n",
+                kernel, source.width, source.height, dst.width, dst.height, simdLevelName(level),
+                static_cast<int>(offset / 4), row, static_cast<int>(offset % 4), *diff.second, *diff.first);
+            g_mismatches++;
+            break;
+        }
+    }
+}
+
+void verifyKernels(Size s) {
+    // Padded rows on every plane, odd strides for the byte planes
+    const int src_stride = s.width * 4 + 20;
+    const int y_stride = s.width + 13;
+    const int chroma_width = (s.width + 1) / 2;
+    const int chroma_height = (s.height + 1) / 2;
+    const int chroma_stride = chroma_width + 7;
+    const int uv_stride = chroma_width * 2 + 11;
+    const auto src = randomBytes(static_cast<size_t>(src_stride) * s.height);
+    const auto y = randomBytes(static_cast<size_t>(y_stride) * s.height);
+    const auto u = randomBytes(static_cast<size_t>(chroma_stride) * chroma_height);
+    const auto v = randomBytes(static_cast<size_t>(chroma_stride) * chroma_height + 1);
+    const auto uv = randomBytes(static_cast<size_t>(uv_stride) * chroma_height);
+
+    verify("copy_rgb32", s, s, [&](uint8_t* dst, int dst_stride) {
+        copyRgb32(src.data(), src_stride, dst, dst_stride, s.width, s.height);
+    });
+    verify("i420_to_rgb32", s, s, [&](uint8_t* dst, int dst_stride) {
+        i420ToRgb32(y.data(), y_stride, u.data(), chroma_stride, v.data() + 1, chroma_stride,
+            dst, dst_stride, s.width, s.height);
+    });
+    verify("nv12_to_rgb32", s, s, [&](uint8_t* dst, int dst_stride) {
+        nv12ToRgb32(y.data(), y_stride, uv.data(), uv_stride, dst, dst_stride, s.width, s.height);
+    });
+
+    Size thumbnail;
+    fitSize(s.width, s.height, kThumbnail.width / 3, kThumbnail.height / 3, thumbnail.width, thumbnail.height);
+    const Size targets[] = {
+        thumbnail, { std::max(1, s.width / 2 + 1), std::max(1, s.height / 3) }, { s.width + 5, s.height + 3 },
+    };
+    for (auto target : targets) {
+        verify("downscale_box", s, target, [&](uint8_t* dst, int dst_stride) {
+            scaleRgb32(src.data(), src_stride, s.width, s.height, dst, dst_stride, target.width, target.height,
+                ScaleFilter::kBox);
+        });
+        verify("downscale_bilinear", s, target, [&](uint8_t* dst, int dst_stride) {
+            scaleRgb32(src.data(), src_stride, s.width, s.height, dst, dst_stride, target.width, target.height,
+                ScaleFilter::kBilinear);
+        });
+    }
+}
+
+void benchCopy(Size s) {
+    // Padded source rows like an SDK plane
+    int src_stride = s.width * 4 + 64;
+    auto src = randomBytes(static_cast<size_t>(src_stride) * s.height);
+    auto dst = PixelBufferPool::instance().acquire(s.width, s.height);
+    for (auto level : levels()) {
+        setSimdLevel(level);
+        double ns = measure([&] {
+            copyRgb32(src.data(), src_stride, dst.data(), dst.stride(), s.width, s.height);
+        });
+        report("copy_rgb32", s, simdLevelName(level), ns, double(s.width) * s.height);
+    }
+#ifdef VRD_BENCH_WITH_QT
+    double ns = measure([&] {
+        QImage image(src.data(), s.width, s.height, src_stride, QImage::Format_RGB32);
+        QImage copy = image.copy();
+        (void)copy;
+    });
+    report("copy_rgb32", s, "qt_copy", ns, double(s.width) * s.height);
+#endif
+}
+
+void benchYuv(Size s) {
+    int chroma_width = (s.width + 1) / 2;
+    int chroma_height = (s.height + 1) / 2;
+    auto y = randomBytes(static_cast<size_t>(s.width) * s.height);
+    auto u = randomBytes(static_cast<size_t>(chroma_width) * chroma_height);
+    auto v = randomBytes(static_cast<size_t>(chroma_width) * chroma_height);
+    auto uv = randomBytes(static_cast<size_t>(chroma_width) * 2 * chroma_height);
+    auto dst = PixelBufferPool::instance().acquire(s.width, s.height);
+    for (auto level : levels()) {
+        setSimdLevel(level);
+        double ns = measure([&] {
+            i420ToRgb32(y.data(), s.width, u.data(), chroma_width, v.data(), chroma_width,
+                dst.data(), dst.stride(), s.width, s.height);
+        });
+        report("i420_to_rgb32", s, simdLevelName(level), ns, double(s.width) * s.height);
+        ns = measure([&] {
+            nv12ToRgb32(y.data(), s.width, uv.data(), chroma_width * 2,
+                dst.data(), dst.stride(), s.width, s.height);
+        });
+        report("nv12_to_rgb32", s, simdLevelName(level), ns, double(s.width) * s.height);
+    }
+}
+
+void benchScale(Size s) {
+    int out_width = 0;
+    int out_height = 0;
+    fitSize(s.width, s.height, kThumbnail.width, kThumbnail.height, out_width, out_height);
+    if (out_width == s.width && out_height == s.height) return;
+
+    int src_stride = s.width * 4;
+    auto src = randomBytes(static_cast<size_t>(src_stride) * s.height);
+    auto dst = PixelBufferPool::instance().acquire(out_width, out_height);
+    for (auto level : levels()) {
+        setSimdLevel(level);
+        double ns = measure([&] {
+            scaleRgb32(src.data(), src_stride, s.width, s.height, dst.data(), dst.stride(),
+                out_width, out_height, ScaleFilter::kBox);
+        });
+        report("downscale_box", s, simdLevelName(level), ns, double(s.width) * s.height);
+        ns = measure([&] {
+            scaleRgb32(src.data(), src_stride, s.width, s.height, dst.data(), dst.stride(),
+                out_width, out_height, ScaleFilter::kBilinear);
+        });
+        report("downscale_bilinear", s, simdLevelName(level), ns, double(s.width) * s.height);
+    }
+#ifdef VRD_BENCH_WITH_QT
+    QImage image(src.data(), s.width, s.height, src_stride, QImage::Format_RGB32);
+    double ns = measure([&] {
+        QImage scaled = image.scaled(out_width, out_height, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        (void)scaled;
+    });
+    report("downscale_box", s, "qt_smooth", ns, double(s.width) * s.height);
+    ns = measure([&] {
+        QImage scaled = image.scaled(out_width, out_height, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+        (void)scaled;
+    });
+    report("downscale_bilinear", s, "qt_fast", ns, double(s.width) * s.height);
+#endif
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) g_min_ms = std::max(1, atoi(argv[1]));
+    for (auto s : kOddSizes) {
+        verifyKernels(s);
+    }
+    setSimdLevel(detectedSimdLevel());
+    if (g_mismatches) {
+        fprintf(stderr, "%d kernel outputs differ from the scalar reference\n", g_mismatches);
+        return 1;
+    }
+
+    printf("kernel,source,impl,ns_per_op,mpix_per_s\n");
+    for (auto s : kSizes) {
+        benchCopy(s);
+        benchYuv(s);
+        benchScale(s);
+    }
+    setSimdLevel(detectedSimdLevel());
+    return 0;
+}
@@ -0,0 +1,267 @@
+// Drives RtcEngineWrap from vrd::MockRtcBackend at room sizes up to 100 people: the mock calls the engine's SDK
+// handlers from its own threads, the events cross the EventBus and come out as signals on the UI thread, which
+// feed SubscriptionManager the way the video call scene does.
+// Prints one CSV row per case:
+// case,peak_users,seconds,callbacks,callbacks_per_s,signals_per_s,volume_signals_per_s,shed,coalesced,join_p99_us
+// and exits non-zero when the UI thread saw something the SDK never does: a user joined twice, a leave without a
+// join, an accepted event that never reached its handler, a dropped control event, a subscribe call for someone
+// not in the room, or event blobs still in use once the bus is empty.
+// Headless, needs QtCore/QtGui and the SDK library RtcEngineWrap links against, the engine itself is never created.
+//
+// Usage: mock_load_bench [seconds_per_case] [case_filter]
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QMetaObject>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "core/id_table.h"
+#include "core/mock/mock_rtc_backend.h"
+#include "core/rtc_engine_wrap.h"
+#include "videocall/core/subscription_manager.h"
+
+namespace {
+
+int g_seconds = 2;
+std::string g_filter;
+int g_failures = 0;
+
+// Tiles of one gallery page, the first people to join are the ones on screen
+const size_t kVisibleTiles = 9;
+
+bool enabled(const char* name) {
+    return g_filter.empty() || std::string(name).find(g_filter) != std::string::npos;
+}
+
+void fail(const char* name, const char* what) {
+    fprintf(stderr, "%s: %s\n", name, what);
+    ++g_failures;
+}
+
+/**
+* Listens to RtcEngineWrap like the video call scene: keeps the membership the signals describe, shows the
+* first joiners in a gallery page and follows the loudest speaker, and records the subscribe calls that
+* SubscriptionManager makes. UI thread only
+*/
+class SceneListener {
+public:
+    uint64_t signal_count = 0;
+    uint64_t volume_signals = 0;
+    uint64_t joins = 0;
+    uint64_t bad_joins = 0;
+    uint64_t bad_leaves = 0;
+    uint64_t requests = 0;
+    uint64_t bad_requests = 0;
+    size_t peak_users = 0;
+
+    SceneListener() {
+        auto& engine = RtcEngineWrap::instance();
+        auto& subscriptions = videocall::SubscriptionManager::instance();
+        subscriptions.reset(vrd::IdTable::instance().intern("mock_local"));
+        subscriptions.setRequestSink([this](const videocall::SubscriptionManager::Request& request) {
+            ++requests;
+            if (!users_.count(request.uid)) ++bad_requests;
+            return 0;
+        });
+
+        QObject::connect(&engine, &RtcEngineWrap::sigOnUserJoined, &scope_,
+            [this](UserInfoWrap info, int) {
+                ++signal_count;
+                ++joins;
+                if (!users_.insert(info.uid).second) {
+                    ++bad_joins;
+                    return;
+                }
+                order_.push_back(info.uid);
+                peak_users = std::max(peak_users, users_.size());
+                membershipChanged();
+            });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnUserLeave, &scope_,
+            [this](vrd::IdHandle uid, bytertc::UserOfflineReason) {
+                ++signal_count;
+                if (!users_.erase(uid)) {
+                    ++bad_leaves;
+                    return;
+                }
+                order_.erase(std::find(order_.begin(), order_.end(), uid));
+                videocall::SubscriptionManager::instance().onUserLeft(uid);
+                membershipChanged();
+            });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnUserPublishStream, &scope_,
+            [this](vrd::IdHandle uid, bytertc::MediaStreamType type) {
+                ++signal_count;
+                if (type & bytertc::kMediaStreamTypeVideo) {
+                    videocall::SubscriptionManager::instance().onVideoPublished(uid, true);
+                }
+            });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnUserUnPublishStream, &scope_,
+            [this](vrd::IdHandle uid, bytertc::MediaStreamType type, bytertc::StreamRemoveReason) {
+                ++signal_count;
+                if (type & bytertc::kMediaStreamTypeVideo) {
+                    videocall::SubscriptionManager::instance().onVideoPublished(uid, false);
+                }
+            });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnRemoteAudioVolumeIndication, &scope_,
+            [this](AudioVolumeSnapshot speakers, int) {
+                ++signal_count;
+                ++volume_signals;
+                auto loudest = std::max_element(speakers.begin(), speakers.end(),
+                    [](const AudioVolumeInfoWrap& a, const AudioVolumeInfoWrap& b) {
+                        return a.volume < b.volume;
+                    });
+                // A report queued before a leave can arrive after it, nobody who left is followed
+                if (loudest != speakers.end() && users_.count(loudest->uid)) {
+                    videocall::SubscriptionManager::instance().setActiveSpeaker(loudest->uid);
+                }
+            });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnLocalAudioVolumeIndication, &scope_,
+            [this](AudioVolumeSnapshot) { ++signal_count; });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnLogReport, &scope_,
+            [this](std::string, std::string) { ++signal_count; });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnAudioDeviceStateChanged, &scope_,
+            [this](const std::string&, bytertc::RTCAudioDeviceType, bytertc::MediaDeviceState,
+                bytertc::MediaDeviceError) { ++signal_count; });
+        QObject::connect(&engine, &RtcEngineWrap::sigOnVideoDeviceStateChanged, &scope_,
+            [this](const std::string&, bytertc::RTCVideoDeviceType, bytertc::MediaDeviceState,
+                bytertc::MediaDeviceError) { ++signal_count; });
+    }
+
+    ~SceneListener() {
+        videocall::SubscriptionManager::instance().setRequestSink(nullptr);
+    }
+
+    size_t present() const { return users_.size(); }
+
+    // Every camera subscription should have gone with its user
+    size_t subscribed() const { return videocall::SubscriptionManager::instance().stats().subscribed; }
+
+private:
+    void membershipChanged() {
+        auto& subscriptions = videocall::SubscriptionManager::instance();
+        subscriptions.setParticipantCount(static_cast<int>(users_.size()) + 1);
+        std::vector<videocall::SubscriptionManager::VisibleTile> tiles;
+        for (size_t i = 0; i < order_.size() && tiles.size() < kVisibleTiles; i++) {
+            videocall::SubscriptionManager::VisibleTile tile;
+            tile.uid = order_[i];
+            tile.width = 640;
+            tile.height = 360;
+            tiles.push_back(tile);
+        }
+        subscriptions.setVisibleTiles(tiles);
+    }
+
+    std::unordered_set<vrd::IdHandle> users_;
+    std::vector<vrd::IdHandle> order_;
+    // Declared last so the lambdas are disconnected before the state they touch goes
+    QObject scope_;
+};
+
+// Runs the backend for the case on a driver thread while the UI thread dispatches, then checks what came out
+void runCase(const char* name, const vrd::MockLoadProfile& profile, const std::vector<vrd::MockLoadStep>& script) {
+    if (!enabled(name)) return;
+    auto& engine = RtcEngineWrap::instance();
+    const auto bus_before = engine.eventBusStats();
+    engine.resetEventLatency();
+    SceneListener listener;
+    vrd::MockRtcBackend backend(&engine, &engine);
+
+    auto begin = std::chrono::steady_clock::now();
+    QEventLoop loop;
+    std::thread driver([&] {
+        backend.start(profile);
+        if (script.empty()) {
+            std::this_thread::sleep_for(std::chrono::seconds(g_seconds));
+        }
+        else {
+            backend.runScript(script);
+        }
+        backend.stop();
+        QMetaObject::invokeMethod(&loop, "quit", Qt::QueuedConnection);
+    });
+    loop.exec();
+    driver.join();
+    // Whatever the last callbacks posted after the quit request
+    while (engine.eventBusStats().depth) {
+        QCoreApplication::sendPostedEvents(&engine);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    const auto stats = backend.stats();
+    const auto bus = engine.eventBusStats();
+    const auto posted = bus.posted - bus_before.posted;
+    const auto dispatched = bus.dispatched - bus_before.dispatched;
+    const auto coalesced = bus.coalesced - bus_before.coalesced;
+    const auto join_latency = engine.eventLatency(vrd::RtcEventType::kUserJoined);
+    printf("%s,%zu,%.2f,%llu,%.0f,%.0f,%.1f,%llu,%llu,%llu\n", name, listener.peak_users, seconds,
+        static_cast<unsigned long long>(stats.callbacks), stats.callbacks / seconds, listener.signal_count / seconds,
+        listener.volume_signals / seconds, static_cast<unsigned long long>(bus.shed - bus_before.shed),
+        static_cast<unsigned long long>(coalesced), static_cast<unsigned long long>(join_latency.p99_us));
+    fflush(stdout);
+
+    if (bus.dropped != bus_before.dropped) fail(name, "control events were dropped");
+    if (posted != dispatched + coalesced) fail(name, "accepted events did not all reach their handler");
+    if (engine.eventArenaStats().in_use) fail(name, "event blobs still in use after the bus drained");
+    if (listener.joins != stats.joins) fail(name, "join signals and backend joins differ");
+    if (listener.bad_joins) fail(name, "a user joined twice");
+    if (listener.bad_leaves) fail(name, "a user left without joining");
+    if (listener.bad_requests) fail(name, "subscribe call for a user not in the room");
+    if (listener.present() != 0 || stats.users != 0) fail(name, "users remain after stop");
+    if (listener.subscribed() != 0) fail(name, "subscriptions remain after everyone left");
+    if (stats.joins != stats.leaves) fail(name, "joins and leaves do not balance");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    if (argc > 1) g_seconds = std::max(1, atoi(argv[1]));
+    if (argc > 2) g_filter = argv[2];
+
+    printf("case,peak_users,seconds,callbacks,callbacks_per_s,signals_per_s,volume_signals_per_s,"
+        "shed,coalesced,join_p99_us\n");
+
+    vrd::MockLoadProfile profile;
+    profile.remote_users = 8;
+    runCase("steady_8", profile, {});
+
+    profile.remote_users = 100;
+    profile.worker_threads = 4;
+    runCase("steady_100", profile, {});
+
+    // Someone joins or leaves every 50ms on top of devices coming and going and a chatty log
+    profile.remote_users = 50;
+    profile.churn_interval_ms = 50;
+    profile.device_event_interval_ms = 500;
+    profile.log_interval_ms = 100;
+    runCase("churn_50", profile, {});
+
+    // Ten people at a time up to 100, then everyone leaves in the same steps
+    profile = vrd::MockLoadProfile();
+    profile.remote_users = 0;
+    profile.worker_threads = 4;
+    std::vector<vrd::MockLoadStep> ramp;
+    const int hold_ms = g_seconds * 1000 / 20;
+    for (int i = 0; i < 10; i++) {
+        vrd::MockLoadStep step;
+        step.join = 10;
+        step.hold_ms = hold_ms;
+        ramp.push_back(step);
+    }
+    for (int i = 0; i < 10; i++) {
+        vrd::MockLoadStep step;
+        step.leave = 10;
+        step.hold_ms = hold_ms;
+        ramp.push_back(step);
+    }
+    runCase("ramp_100", profile, ramp);
+
+    return g_failures ? 1 : 0;
+}
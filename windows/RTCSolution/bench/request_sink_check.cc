@@ -0,0 +1,342 @@
+// Drives the videocall components that issue SDK calls through a request sink and checks the calls they make.
+// Prints one CSV row per case: case,requests,result
+// and exits non-zero when a case sees calls the SDK should not get.
+// Headless and without the SDK, the sinks record the requests instead of calling the engine.
+//
+// Usage: request_sink_check [case_filter]
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "core/id_table.h"
+#include "core/simulcast_layers.h"
+#include "videocall/core/canvas_bindings.h"
+#include "videocall/core/subscription_manager.h"
+
+namespace {
+
+std::string g_filter;
+int g_failures = 0;
+
+bool enabled(const char* name) {
+    return g_filter.empty() || std::string(name).find(g_filter) != std::string::npos;
+}
+
+// Collects the failures of one case and prints its row
+class Case {
+public:
+    explicit Case(const char* name) : name_(name) {}
+
+    void expect(bool ok, const char* what) {
+        if (ok) return;
+        fprintf(stderr, "%s: %s\n", name_, what);
+        failed_ = true;
+    }
+
+    void finish(size_t requests) {
+        printf("%s,%zu,%s\n", name_, requests, failed_ ? "fail" : "ok");
+        fflush(stdout);
+        if (failed_) ++g_failures;
+    }
+
+private:
+    const char* name_;
+    bool failed_ = false;
+};
+
+vrd::IdHandle uid(const char* id) {
+    return vrd::IdTable::instance().intern(id);
+}
+
+// Records every subscribe call, result is what the SDK answers
+struct SubscriptionRecorder {
+    std::vector<videocall::SubscriptionManager::Request> requests;
+    int result = 0;
+
+    SubscriptionRecorder() {
+        videocall::SubscriptionManager::instance().setRequestSink(
+            [this](const videocall::SubscriptionManager::Request& request) {
+                requests.push_back(request);
+                return result;
+            });
+    }
+
+    ~SubscriptionRecorder() {
+        videocall::SubscriptionManager::instance().setRequestSink(nullptr);
+    }
+
+    size_t count(bool subscribe) const {
+        size_t n = 0;
+        for (const auto& request : requests) {
+            if (request.subscribe == subscribe) n++;
+        }
+        return n;
+    }
+};
+
+// Records every canvas call, result is what the SDK answers
+struct CanvasRecorder {
+    std::vector<videocall::CanvasBindings::Request> requests;
+    int result = 0;
+
+    CanvasRecorder() {
+        videocall::CanvasBindings::instance().reset();
+        videocall::CanvasBindings::instance().setRequestSink(
+            [this](const videocall::CanvasBindings::Request& request) {
+                requests.push_back(request);
+                return result;
+            });
+    }
+
+    ~CanvasRecorder() {
+        videocall::CanvasBindings::instance().setRequestSink(nullptr);
+        videocall::CanvasBindings::instance().reset();
+    }
+
+    size_t count(bool bind) const {
+        size_t n = 0;
+        for (const auto& request : requests) {
+            if ((request.view != nullptr) == bind) n++;
+        }
+        return n;
+    }
+};
+
+videocall::CanvasBindings::StreamKey camera(const char* id) {
+    videocall::CanvasBindings::StreamKey key;
+    key.uid = uid(id);
+    return key;
+}
+
+// Any distinct non-null pointer stands in for a window
+void* window(int index) {
+    static char windows[16];
+    return &windows[index];
+}
+
+videocall::CanvasBindings::Binding binding(const char* id, int index) {
+    videocall::CanvasBindings::Binding b;
+    b.key = camera(id);
+    b.view = window(index);
+    return b;
+}
+
+videocall::SubscriptionManager& freshManager(int participants) {
+    auto& manager = videocall::SubscriptionManager::instance();
+    manager.reset(uid("local"));
+    manager.setParticipantCount(participants);
+    return manager;
+}
+
+videocall::SubscriptionManager::VisibleTile tile(const char* id, int width, int height) {
+    videocall::SubscriptionManager::VisibleTile visible;
+    visible.uid = uid(id);
+    visible.width = width;
+    visible.height = height;
+    return visible;
+}
+
+// Publishers and subscribers must agree on the ladder length whatever the camera setting
+void checkLadderLength() {
+    if (!enabled("ladder_length")) return;
+    Case c("ladder_length");
+    size_t ladders = 0;
+    for (int participants : { 1, 2, 3, 4, 5, 16, 100 }) {
+        const int count = vrd::SimulcastLayers::layerCount(participants);
+        for (int height : { 0, 1080, 720, 540, 360, 270, 180, 120 }) {
+            auto ladder = vrd::SimulcastLayers::publishLadder(participants, height);
+            c.expect(static_cast<int>(ladder.size()) == count, "published ladder is not layerCount long");
+            for (size_t i = 1; i < ladder.size(); i++) {
+                c.expect(ladder[i].height <= ladder[i - 1].height, "published ladder is not best first");
+            }
+            ladders++;
+        }
+        for (int height : { 90, 180, 270, 360, 540, 720, 1080, 2160 }) {
+            int layer = vrd::SimulcastLayers::select(participants, height * 16 / 9, height);
+            c.expect(layer >= 0 && layer < count, "selected layer is past the published ladder");
+        }
+    }
+    c.finish(ladders);
+}
+
+void checkVisibleTiles() {
+    if (!enabled("subscription_visible_tiles")) return;
+    Case c("subscription_visible_tiles");
+    SubscriptionRecorder recorder;
+    auto& manager = freshManager(3);
+    manager.onVideoPublished(uid("a"), true);
+    manager.onVideoPublished(uid("b"), true);
+    manager.onVideoPublished(uid("local"), true);
+    c.expect(recorder.requests.empty(), "subscribed a camera without a tile");
+
+    manager.setVisibleTiles({ tile("a", 1280, 720), tile("local", 640, 360) });
+    c.expect(recorder.requests.size() == 1, "expected one subscribe for the one remote tile");
+    if (!recorder.requests.empty()) {
+        const auto& request = recorder.requests.back();
+        c.expect(request.uid == uid("a") && request.subscribe && !request.is_screen, "wrong subscribe call");
+        c.expect(request.layer == vrd::SimulcastLayers::select(3, 1280, 720), "layer differs from select()");
+    }
+    c.expect(!manager.isVideoSubscribed(uid("local")), "subscribed the local user");
+
+    // The same tiles again make no call
+    manager.setVisibleTiles({ tile("a", 1280, 720), tile("local", 640, 360) });
+    c.expect(recorder.requests.size() == 1, "unchanged tiles made a call");
+
+    // Shrinking far enough moves to a smaller layer without unsubscribing first
+    manager.setVisibleTiles({ tile("a", 320, 180) });
+    c.expect(recorder.requests.size() == 2 && recorder.count(false) == 0, "expected one layer switch");
+    c.expect(manager.videoLayer(uid("a")) == vrd::SimulcastLayers::layerCount(3) - 1, "not on the smallest layer");
+    c.expect(manager.stats().layer_switches >= 1, "layer switch not counted");
+
+    // Scrolled away, the camera is dropped
+    manager.setVisibleTiles({});
+    c.expect(recorder.count(false) == 1 && !manager.isVideoSubscribed(uid("a")), "expected one unsubscribe");
+    c.finish(recorder.requests.size());
+}
+
+void checkActiveSpeaker() {
+    if (!enabled("subscription_active_speaker")) return;
+    Case c("subscription_active_speaker");
+    SubscriptionRecorder recorder;
+    auto& manager = freshManager(8);
+    manager.onVideoPublished(uid("a"), true);
+    manager.onVideoPublished(uid("b"), true);
+
+    // A speaker without a tile gets the smallest layer the publishers send
+    manager.setActiveSpeaker(uid("a"));
+    c.expect(recorder.requests.size() == 1, "expected one subscribe for the speaker");
+    c.expect(manager.videoLayer(uid("a")) == vrd::SimulcastLayers::layerCount(8) - 1,
+        "speaker not on the smallest layer");
+
+    // Silence keeps the speaker, the next speaker replaces it
+    manager.setActiveSpeaker(vrd::kInvalidIdHandle);
+    c.expect(manager.isVideoSubscribed(uid("a")), "silence dropped the speaker");
+    manager.setActiveSpeaker(uid("b"));
+    c.expect(!manager.isVideoSubscribed(uid("a")) && manager.isVideoSubscribed(uid("b")), "speaker not replaced");
+    c.expect(recorder.count(true) == 2 && recorder.count(false) == 1, "expected subscribe, subscribe, unsubscribe");
+
+    // The SDK drops the subscription with the stream, no call is made
+    const auto before = recorder.requests.size();
+    manager.onVideoPublished(uid("b"), false);
+    c.expect(recorder.requests.size() == before && !manager.isVideoSubscribed(uid("b")), "unpublish made a call");
+    c.finish(recorder.requests.size());
+}
+
+void checkTierChange() {
+    if (!enabled("subscription_tier_change")) return;
+    Case c("subscription_tier_change");
+    SubscriptionRecorder recorder;
+    auto& manager = freshManager(3);
+    manager.onVideoPublished(uid("a"), true);
+    manager.setVisibleTiles({ tile("a", 640, 360) });
+    c.expect(manager.videoLayer(uid("a")) == vrd::SimulcastLayers::select(3, 640, 360), "wrong layer at 3 people");
+
+    // Growing within the tier keeps the subscription, crossing into the next one picks the layer again
+    const auto before = recorder.requests.size();
+    manager.setParticipantCount(4);
+    c.expect(recorder.requests.size() == before, "a count inside the tier made a call");
+    manager.setParticipantCount(100);
+    const int layer = manager.videoLayer(uid("a"));
+    c.expect(layer == vrd::SimulcastLayers::select(100, 640, 360), "layer not picked again for the new tier");
+    c.expect(layer >= 0 && layer < vrd::SimulcastLayers::layerCount(100), "layer past the new tier's ladder");
+    c.expect(recorder.requests.size() == before + 1 && recorder.count(false) == 0,
+        "expected one layer switch for the new tier");
+    c.finish(recorder.requests.size());
+}
+
+void checkScreenAndFailures() {
+    if (!enabled("subscription_screen_and_failures")) return;
+    Case c("subscription_screen_and_failures");
+    SubscriptionRecorder recorder;
+    auto& manager = freshManager(3);
+
+    manager.onScreenPublished(uid("a"), true);
+    c.expect(recorder.requests.size() == 1 && recorder.requests.back().is_screen
+        && recorder.requests.back().layer == -1, "screen share not subscribed without a layer");
+    manager.onScreenPublished(uid("local"), true);
+    c.expect(recorder.requests.size() == 1, "subscribed the local screen share");
+
+    // A rejected subscribe is not recorded and is asked for again on the next pass
+    recorder.result = -1;
+    manager.onVideoPublished(uid("b"), true);
+    manager.setVisibleTiles({ tile("b", 640, 360) });
+    c.expect(!manager.isVideoSubscribed(uid("b")), "a failed subscribe was recorded");
+    recorder.result = 0;
+    manager.setVisibleTiles({ tile("b", 640, 360) });
+    c.expect(manager.isVideoSubscribed(uid("b")), "a failed subscribe was not retried");
+
+    manager.onUserLeft(uid("b"));
+    c.expect(!manager.isVideoSubscribed(uid("b")), "left user still subscribed");
+    c.finish(recorder.requests.size());
+}
+
+void checkCanvasSwap() {
+    if (!enabled("canvas_swap")) return;
+    Case c("canvas_swap");
+    CanvasRecorder recorder;
+    auto& bindings = videocall::CanvasBindings::instance();
+    bindings.assignCameras({ binding("a", 0), binding("b", 1), binding("c", 2) });
+    c.expect(recorder.requests.size() == 3 && recorder.count(true) == 3, "expected three binds");
+
+    // The same layout again makes no call
+    recorder.requests.clear();
+    bindings.assignCameras({ binding("a", 0), binding("b", 1), binding("c", 2) });
+    c.expect(recorder.requests.empty(), "unchanged layout made a call");
+
+    // Two tiles swapping users rebind each stream once and never unbind
+    bindings.assignCameras({ binding("b", 0), binding("a", 1), binding("c", 2) });
+    c.expect(recorder.count(true) == 2, "swap did not make exactly two binds");
+    c.expect(recorder.count(false) == 0, "swap unbound a stream");
+    c.expect(bindings.view(camera("a")) == window(1) && bindings.view(camera("b")) == window(0),
+        "swapped streams not in their new windows");
+    c.finish(recorder.requests.size());
+}
+
+void checkCanvasDropAndFailures() {
+    if (!enabled("canvas_drop_and_failures")) return;
+    Case c("canvas_drop_and_failures");
+    CanvasRecorder recorder;
+    auto& bindings = videocall::CanvasBindings::instance();
+    bindings.assignCameras({ binding("a", 0), binding("b", 1) });
+
+    // A stream left out of the layout is unbound, the one that stays is not touched
+    recorder.requests.clear();
+    bindings.assignCameras({ binding("a", 0) });
+    c.expect(recorder.requests.size() == 1 && recorder.count(false) == 1, "expected one unbind");
+    c.expect(!bindings.view(camera("b")), "dropped stream still bound");
+
+    // Screen shares are not part of the camera layout
+    videocall::CanvasBindings::StreamKey screen = camera("a");
+    screen.screen = true;
+    bindings.bind(screen, window(5));
+    bindings.assignCameras({ binding("a", 0) });
+    c.expect(bindings.view(screen) == window(5), "camera layout unbound a screen share");
+
+    // A rejected bind is not recorded and is asked for again on the next pass
+    recorder.result = -1;
+    bindings.assignCameras({ binding("a", 0), binding("c", 1) });
+    c.expect(!bindings.view(camera("c")), "a failed bind was recorded");
+    recorder.result = 0;
+    const auto before = recorder.requests.size();
+    bindings.assignCameras({ binding("a", 0), binding("c", 1) });
+    c.expect(recorder.requests.size() == before + 1 && bindings.view(camera("c")) == window(1),
+        "a failed bind was not retried");
+    c.finish(recorder.requests.size());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) g_filter = argv[1];
+
+    printf("case,requests,result\n");
+    checkLadderLength();
+    checkVisibleTiles();
+    checkActiveSpeaker();
+    checkTierChange();
+    checkScreenAndFailures();
+    checkCanvasSwap();
+    checkCanvasDropAndFailures();
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,245 @@
+// Measures the per-tile update cost of the video grid overlay under the offscreen QPA.
+// Prints one CSV row per case: benchmark,case,ns_per_op,ops_per_s
+// Every op is one setter on a shown tile followed by the repaint it causes. "qss_labels" replicates the
+// QStackedWidget/QLabel tile that restyled itself with setStyleSheet, "painted" is videocall::TileSurface.
+//
+// Usage: QT_QPA_PLATFORM=offscreen tile_overlay_bench [min_ms_per_case] [benchmark_filter]
+
+#include <QApplication>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QIcon>
+#include <QLabel>
+#include <QStackedWidget>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/bench_common.h"
+#include "videocall/core/tile_overlay.h"
+
+namespace {
+
+int g_min_ms = 200;
+std::string g_filter;
+
+bool enabled(const char* benchmark) {
+    return g_filter.empty() || std::string(benchmark).find(g_filter) != std::string::npos;
+}
+
+void report(const char* benchmark, const std::string& name, double ns) {
+    printf("%s,%s,%.1f,%.0f\n", benchmark, name.c_str(), ns, 1e9 / ns);
+    fflush(stdout);
+}
+
+double measure(const std::function<void()>& fn) {
+    return vrd::bench::measure(g_min_ms, fn);
+}
+
+// Runs the pending layout and paint events, the repaint is part of what a setter costs
+void flush() {
+    QApplication::processEvents();
+}
+
+// The tile as it was before the painted overlay: two stacked pages of labels restyled with setStyleSheet
+class QssTile : public QWidget {
+public:
+    explicit QssTile(QWidget* parent) : QWidget(parent) {
+        auto layout = new QHBoxLayout(this);
+        layout->setContentsMargins(0, 0, 0, 0);
+        stacked_ = new QStackedWidget(this);
+        layout->addWidget(stacked_);
+
+        has_video_ = new QWidget(stacked_);
+        has_video_->setObjectName("HasVideoWidget");
+        video_ = new QWidget(has_video_);
+        video_->setStyleSheet("background:#272e3B;");
+        has_chip_ = createChip(has_video_, &has_labels_);
+
+        no_video_ = new QWidget(stacked_);
+        no_video_->setObjectName("NoVideoWidget");
+        auto box = new QVBoxLayout(no_video_);
+        box->setContentsMargins(0, 0, 0, 0);
+        logo_ = new QLabel(no_video_);
+        logo_->setAlignment(Qt::AlignCenter);
+        logo_->setFixedSize(80, 80);
+        logo_->setStyleSheet("border-radius:40px; background:#4E5969;border:none;"
+            "font-family: 'Inter';font-weight: 500;font-size: 32px; ");
+        box->addWidget(logo_, 0, Qt::AlignCenter);
+        no_chip_ = createChip(no_video_, &no_labels_);
+
+        stacked_->addWidget(has_video_);
+        stacked_->addWidget(no_video_);
+    }
+
+    QWidget* video() const { return video_; }
+
+    void setHasVideo(bool has_video) {
+        stacked_->setCurrentIndex(!has_video);
+    }
+
+    void setUserName(const QString& name) {
+        has_labels_[2]->setText(name);
+        has_labels_[2]->setVisible(true);
+        no_labels_[2]->setText(name);
+        no_labels_[2]->setVisible(true);
+        logo_->setText(name.left(1).toUpper());
+        placeChips();
+    }
+
+    void setMic(bool on) {
+        for (auto labels : {has_labels_, no_labels_}) {
+            labels[0]->setVisible(true);
+            QIcon icon(on ? ":img/videocall_mic_on" : ":img/videocall_mic_off");
+            labels[0]->setPixmap(icon.pixmap(icon.actualSize(QSize(16, 16))));
+        }
+        placeChips();
+    }
+
+    void setHighLight(bool enabled) {
+        has_video_->setStyleSheet(enabled ? "#HasVideoWidget{border:2px solid #23C343;}"
+                                          : "#HasVideoWidget{border:none}");
+        no_video_->setStyleSheet(enabled
+            ? "#NoVideoWidget{background:#272E3B;font-family: \"Microsoft YaHei\";font-size: 12px;\n"
+              "border:2px solid #23C343;}"
+            : "#NoVideoWidget{background:#272E3B;font-family: \"Microsoft YaHei\";font-size: 12px;\n"
+              "border:none;}");
+    }
+
+protected:
+    void resizeEvent(QResizeEvent* e) override {
+        QWidget::resizeEvent(e);
+        video_->setGeometry(2, 2, width() - 4, height() - 4);
+        placeChips();
+    }
+
+private:
+    static QWidget* createChip(QWidget* parent, std::vector<QLabel*>* labels) {
+        auto chip = new QWidget(parent);
+        chip->setFixedHeight(32);
+        chip->setStyleSheet("font-family: \"Microsoft YaHei\";\nfont-size: 12px;\n");
+        auto layout = new QHBoxLayout(chip);
+        layout->setSpacing(8);
+        layout->setContentsMargins(8, 8, 8, 8);
+        for (int i = 0; i < 3; i++) {
+            auto label = new QLabel(chip);
+            label->setVisible(false);
+            layout->addWidget(label);
+            labels->push_back(label);
+        }
+        return chip;
+    }
+
+    void placeChips() {
+        for (auto chip : {has_chip_, no_chip_}) {
+            chip->resize(chip->layout()->sizeHint());
+            chip->move(2, height() - chip->height() - 2);
+        }
+    }
+
+    QStackedWidget* stacked_;
+    QWidget* has_video_;
+    QWidget* no_video_;
+    QWidget* video_;
+    QLabel* logo_;
+    QWidget* has_chip_;
+    QWidget* no_chip_;
+    std::vector<QLabel*> has_labels_;
+    std::vector<QLabel*> no_labels_;
+};
+
+// A 4x4 page of the grid, tiles are native like the ones the SDK renders into
+template <typename Tile>
+class Page {
+public:
+    explicit Page(bool has_video) {
+        window_.resize(1280, 720);
+        auto grid = new QGridLayout(&window_);
+        grid->setContentsMargins(8, 8, 8, 8);
+        for (int i = 0; i < kTiles; i++) {
+            auto tile = new Tile(&window_);
+            tile->video()->winId();
+            tile->setHasVideo(has_video);
+            tile->setUserName(QString("user_%1").arg(i));
+            tile->setMic(true);
+            grid->addWidget(tile, i / 4, i % 4);
+            tiles_.push_back(tile);
+        }
+        window_.show();
+        flush();
+    }
+
+    Tile* tile(int index) const { return tiles_[index % kTiles]; }
+
+    static const int kTiles = 16;
+
+private:
+    QWidget window_;
+    std::vector<Tile*> tiles_;
+};
+
+template <typename Tile>
+void benchTile(const char* impl, bool has_video) {
+    Page<Tile> page(has_video);
+    const std::string suffix = has_video ? "_video" : "_avatar";
+    bool on = false;
+    int speaker = 0;
+    int renames = 0;
+
+    if (enabled("mic")) {
+        report("mic", impl + suffix, measure([&] {
+            on = !on;
+            page.tile(0)->setMic(on);
+            flush();
+        }));
+    }
+    if (enabled("highlight")) {
+        report("highlight", impl + suffix, measure([&] {
+            on = !on;
+            page.tile(0)->setHighLight(on);
+            flush();
+        }));
+    }
+    if (enabled("name")) {
+        report("name", impl + suffix, measure([&] {
+            page.tile(0)->setUserName(QString("renamed_%1").arg(renames++ % 64));
+            flush();
+        }));
+    }
+    // A volume report moves the highlight from one speaker to the next
+    if (enabled("speaker_move")) {
+        report("speaker_move", impl + suffix, measure([&] {
+            page.tile(speaker)->setHighLight(false);
+            speaker++;
+            page.tile(speaker)->setHighLight(true);
+            flush();
+        }));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+    if (argc > 1) g_min_ms = std::max(1, atoi(argv[1]));
+    if (argc > 2) g_filter = argv[2];
+
+    printf("benchmark,case,ns_per_op,ops_per_s\n");
+    for (bool has_video : {true, false}) {
+        benchTile<QssTile>("qss_labels", has_video);
+        benchTile<videocall::TileSurface>("painted", has_video);
+    }
+    auto stats = videocall::TileOverlayCache::instance().stats();
+    printf("# overlay cache: %llu rasterized, %llu hits, %zu entries\n",
+        static_cast<unsigned long long>(stats.rasterized), static_cast<unsigned long long>(stats.hits),
+        stats.entries);
+    return 0;
+}
@@ -8,29 +8,26 @@
 #include <sstream>
 #include <QFont>
 
+#include "core/slab_allocator.h"
+
 namespace util {
+	/**
+	* Frame buffer pool backed by vrd::SlabAllocator
+	* Blocks come from size classes instead of exact-size matches and are zeroed unless zero_fill is false
+	*/
 	class SimpleMemoryPool {
-	private:
-		struct Item {
-			unsigned char* addr = nullptr;
-			unsigned int size = 0;
-			unsigned long ref = 0;
-
-			Item() = default;
-			Item(unsigned char* a, unsigned int s, unsigned long r) : addr(a), size(s), ref(r) {
-			}
-		};
-
 	public:
-		~SimpleMemoryPool();
-		unsigned char* Malloc(unsigned int size);
-		bool Free(unsigned char* addr);
-		void CleanFragment();
+		explicit SimpleMemoryPool(bool zero_fill = true) : mAllocator(zero_fill) {}
+		unsigned char* Malloc(unsigned int size) {
+			return static_cast<unsigned char*>(mAllocator.allocate(size));
+		}
+		bool Free(unsigned char* addr) { return mAllocator.release(addr); }
+		// Gives back the large free blocks that were not reused since the previous call
+		void CleanFragment() { mAllocator.trim(); }
+		vrd::SlabAllocator::Stats Stats() const { return mAllocator.stats(); }
 
 	private:
-		std::list<Item> mFreePools;
-		std::unordered_map<unsigned char*, Item> mAllocPools;
-		std::mutex mMutex;
+		vrd::SlabAllocator mAllocator;
 	};
 
 	std::string urlEncoder(const std::string &str);
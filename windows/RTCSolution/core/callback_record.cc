@@ -0,0 +1,536 @@
+#include "callback_record.h"
+
+#include <chrono>
+#include <thread>
+
+#include "core/latency_histogram.h"
+
+namespace vrd {
+
+namespace {
+
+const char kRecordMagic[8] = { 'V', 'R', 'D', 'C', 'B', 'R', 'E', 'C' };
+// 2 added the room of every record
+constexpr uint32_t kRecordVersion = 2;
+constexpr uint32_t kNullString = 0xffffffffu;
+// Anything larger is treated as a corrupt length rather than allocated
+constexpr uint32_t kMaxRecordSize = 16 * 1024 * 1024;
+
+// Set in RecordHeader::flags for callbacks of the main room
+constexpr uint16_t kMainRoomFlag = 1;
+
+// Followed by the body: the room id string, then the callback arguments
+struct RecordHeader {
+    uint32_t size;
+    uint16_t id;
+    uint16_t flags;
+    uint64_t timestamp_ns;
+};
+
+bool isRoomCallback(RecordedCallback id) {
+    switch (id) {
+    case RecordedCallback::kRoomStateChanged:
+    case RecordedCallback::kRoomStats:
+    case RecordedCallback::kLocalStreamStats:
+    case RecordedCallback::kRemoteStreamStats:
+    case RecordedCallback::kLeaveRoom:
+    case RecordedCallback::kUserJoined:
+    case RecordedCallback::kUserLeave:
+    case RecordedCallback::kUserPublishStream:
+    case RecordedCallback::kUserUnpublishStream:
+    case RecordedCallback::kUserPublishScreen:
+    case RecordedCallback::kUserUnpublishScreen:
+    case RecordedCallback::kStreamSubscribed:
+    case RecordedCallback::kStreamPublishSuccess:
+    case RecordedCallback::kRoomMessageReceived:
+    case RecordedCallback::kUserMessageReceived:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Bounds-checked cursor over one record body, strings point into the body itself
+class RecordReader {
+public:
+    RecordReader(const char* data, size_t size) : pos_(data), end_(data + size) {}
+
+    template <typename T>
+    T get() {
+        T value = T();
+        if (static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    const char* getString() {
+        auto len = get<uint32_t>();
+        if (!ok_ || len == kNullString) return nullptr;
+        if (static_cast<size_t>(end_ - pos_) < static_cast<size_t>(len) + 1) {
+            ok_ = false;
+            return "";
+        }
+        const char* str = pos_;
+        pos_ += len + 1;
+        return str;
+    }
+
+    bool ok() const { return ok_; }
+    size_t remaining() const { return static_cast<size_t>(end_ - pos_); }
+
+private:
+    const char* pos_;
+    const char* end_;
+    bool ok_ = true;
+};
+
+}  // namespace
+
+void RecordWriter::putString(const char* str) {
+    if (!str) {
+        put(kNullString);
+        return;
+    }
+    auto len = static_cast<uint32_t>(strlen(str));
+    put(len);
+    bytes_.append(str, len + 1);
+}
+
+namespace record_detail {
+
+void encode(RecordWriter& w, const char* str) {
+    w.putString(str);
+}
+
+void encode(RecordWriter& w, const bytertc::UserInfo& info) {
+    w.putString(info.uid);
+    w.putString(info.extra_info);
+}
+
+void encode(RecordWriter& w, const bytertc::RemoteStreamKey& key) {
+    w.put(key.stream_index);
+    w.putString(key.room_id);
+    w.putString(key.user_id);
+}
+
+void encode(RecordWriter& w, const bytertc::RemoteStreamStats& stats) {
+    w.put(stats);
+    w.putString(stats.uid);
+}
+
+void encode(RecordWriter&, const bytertc::ServerACKMsg&) {
+    // The ack body is an SDK-owned buffer that the UI never reads, only msgid and error are kept
+}
+
+void encode(RecordWriter& w, const RecordArray<bytertc::RemoteAudioPropertiesInfo>& infos) {
+    int count = infos.items && infos.count > 0 ? infos.count : 0;
+    w.put(count);
+    for (int i = 0; i < count; i++) {
+        w.put(infos.items[i]);
+        w.putString(infos.items[i].stream_key.room_id);
+        w.putString(infos.items[i].stream_key.user_id);
+    }
+}
+
+void encode(RecordWriter& w, const RecordArray<bytertc::LocalAudioPropertiesInfo>& infos) {
+    int count = infos.items && infos.count > 0 ? infos.count : 0;
+    w.put(count);
+    for (int i = 0; i < count; i++) {
+        w.put(infos.items[i]);
+    }
+}
+
+}  // namespace record_detail
+
+CallbackRecorder::~CallbackRecorder() {
+    stop();
+}
+
+bool CallbackRecorder::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) return false;
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) return false;
+
+    const char* sdk_version = bytertc::getSDKVersion();
+    auto version_len = static_cast<uint32_t>(sdk_version ? strlen(sdk_version) : 0);
+    fwrite(kRecordMagic, 1, sizeof(kRecordMagic), file_);
+    fwrite(&kRecordVersion, sizeof(kRecordVersion), 1, file_);
+    fwrite(&version_len, sizeof(version_len), 1, file_);
+    if (version_len) fwrite(sdk_version, 1, version_len, file_);
+
+    start_ns_ = steadyNowNs();
+    records_ = 0;
+    active_.store(true, std::memory_order_release);
+    return true;
+}
+
+void CallbackRecorder::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_.store(false, std::memory_order_release);
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+RecordWriter& CallbackRecorder::scratch() {
+    static thread_local RecordWriter writer;
+    return writer;
+}
+
+void CallbackRecorder::append(RecordedCallback id, bool main_room, const RecordWriter& body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+    // Stamped under the lock so timestamps never go backwards within the file
+    RecordHeader header;
+    header.size = static_cast<uint32_t>(body.bytes().size());
+    header.id = static_cast<uint16_t>(id);
+    header.flags = main_room ? kMainRoomFlag : 0;
+    header.timestamp_ns = steadyNowNs() - start_ns_;
+    fwrite(&header, sizeof(header), 1, file_);
+    if (header.size) fwrite(body.bytes().data(), 1, header.size, file_);
+    records_.fetch_add(1, std::memory_order_relaxed);
+}
+
+CallbackPlayer::CallbackPlayer(std::string path) : path_(std::move(path)) {}
+
+CallbackPlayer::~CallbackPlayer() {
+    if (file_) fclose(file_);
+}
+
+bool CallbackPlayer::open() {
+    if (file_) fclose(file_);
+    file_ = fopen(path_.c_str(), "rb");
+    if (!file_) return false;
+
+    char magic[sizeof(kRecordMagic)];
+    uint32_t version = 0;
+    uint32_t version_len = 0;
+    if (fread(magic, 1, sizeof(magic), file_) != sizeof(magic)
+        || memcmp(magic, kRecordMagic, sizeof(magic)) != 0
+        || fread(&version, sizeof(version), 1, file_) != 1
+        || version != kRecordVersion
+        || fread(&version_len, sizeof(version_len), 1, file_) != 1
+        || version_len > 256) {
+        fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    sdk_version_.resize(version_len);
+    if (version_len && fread(&sdk_version_[0], 1, version_len, file_) != version_len) {
+        fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+CallbackPlayer::Result CallbackPlayer::play(bytertc::IRTCVideoEventHandler* video_handler,
+        const RoomHandlers& room_handlers, Pace pace) {
+    Result result;
+    if (!file_ || !video_handler || !room_handlers) return result;
+
+    auto begin = std::chrono::steady_clock::now();
+    RecordHeader header;
+    result.ok = true;
+    while (fread(&header, sizeof(header), 1, file_) == 1) {
+        if (header.size > kMaxRecordSize) {
+            result.ok = false;
+            break;
+        }
+        body_.resize(header.size);
+        if (header.size && fread(body_.data(), 1, header.size, file_) != header.size) {
+            result.ok = false;
+            break;
+        }
+        if (pace == Pace::kOriginal) {
+            std::this_thread::sleep_until(begin + std::chrono::nanoseconds(header.timestamp_ns));
+        }
+        if (dispatch(static_cast<RecordedCallback>(header.id), (header.flags & kMainRoomFlag) != 0,
+                video_handler, room_handlers)) {
+            ++result.callbacks;
+        }
+        else {
+            ++result.skipped;
+        }
+    }
+    result.duration_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+    return result;
+}
+
+bool CallbackPlayer::dispatch(RecordedCallback id, bool main_room, bytertc::IRTCVideoEventHandler* video,
+        const RoomHandlers& room_handlers) {
+    RecordReader r(body_.data(), body_.size());
+    auto recorded_room = r.getString();
+    if (!r.ok()) return false;
+    bytertc::IRTCRoomEventHandler* room = nullptr;
+    if (isRoomCallback(id)) {
+        room = room_handlers(recorded_room, main_room);
+        if (!room) return false;
+    }
+    switch (id) {
+    case RecordedCallback::kRoomStateChanged: {
+        auto room_id = r.getString();
+        auto uid = r.getString();
+        auto state = r.get<int>();
+        auto extra_info = r.getString();
+        if (!r.ok()) return false;
+        room->onRoomStateChanged(room_id, uid, state, extra_info);
+        return true;
+    }
+    case RecordedCallback::kRoomStats: {
+        auto stats = r.get<bytertc::RtcRoomStats>();
+        if (!r.ok()) return false;
+        room->onRoomStats(stats);
+        return true;
+    }
+    case RecordedCallback::kLocalStreamStats: {
+        auto stats = r.get<bytertc::LocalStreamStats>();
+        if (!r.ok()) return false;
+        room->onLocalStreamStats(stats);
+        return true;
+    }
+    case RecordedCallback::kRemoteStreamStats: {
+        auto stats = r.get<bytertc::RemoteStreamStats>();
+        stats.uid = r.getString();
+        if (!r.ok()) return false;
+        room->onRemoteStreamStats(stats);
+        return true;
+    }
+    case RecordedCallback::kWarning: {
+        auto warn = r.get<int>();
+        if (!r.ok()) return false;
+        video->onWarning(warn);
+        return true;
+    }
+    case RecordedCallback::kError: {
+        auto err = r.get<int>();
+        if (!r.ok()) return false;
+        video->onError(err);
+        return true;
+    }
+    case RecordedCallback::kRemoteAudioPropertiesReport: {
+        auto count = r.get<int>();
+        // Every entry takes at least the struct and two string lengths, a larger count is a corrupt record
+        const size_t min_entry = sizeof(bytertc::RemoteAudioPropertiesInfo) + 2 * sizeof(uint32_t);
+        if (!r.ok() || count < 0 || static_cast<size_t>(count) > r.remaining() / min_entry) return false;
+        remote_audio_.resize(count);
+        for (auto& info : remote_audio_) {
+            info = r.get<bytertc::RemoteAudioPropertiesInfo>();
+            info.stream_key.room_id = r.getString();
+            info.stream_key.user_id = r.getString();
+        }
+        auto total_volume = r.get<int>();
+        if (!r.ok()) return false;
+        video->onRemoteAudioPropertiesReport(remote_audio_.data(), count, total_volume);
+        return true;
+    }
+    case RecordedCallback::kLocalAudioPropertiesReport: {
+        auto count = r.get<int>();
+        if (!r.ok() || count < 0
+            || static_cast<size_t>(count) > r.remaining() / sizeof(bytertc::LocalAudioPropertiesInfo)) {
+            return false;
+        }
+        local_audio_.resize(count);
+        for (auto& info : local_audio_) {
+            info = r.get<bytertc::LocalAudioPropertiesInfo>();
+        }
+        if (!r.ok()) return false;
+        video->onLocalAudioPropertiesReport(local_audio_.data(), count);
+        return true;
+    }
+    case RecordedCallback::kLeaveRoom: {
+        auto stats = r.get<bytertc::RtcRoomStats>();
+        if (!r.ok()) return false;
+        room->onLeaveRoom(stats);
+        return true;
+    }
+    case RecordedCallback::kUserJoined: {
+        bytertc::UserInfo info;
+        info.uid = r.getString();
+        info.extra_info = r.getString();
+        auto elapsed = r.get<int>();
+        if (!r.ok()) return false;
+        room->onUserJoined(info, elapsed);
+        return true;
+    }
+    case RecordedCallback::kUserLeave: {
+        auto uid = r.getString();
+        auto reason = r.get<bytertc::UserOfflineReason>();
+        if (!r.ok()) return false;
+        room->onUserLeave(uid, reason);
+        return true;
+    }
+    case RecordedCallback::kUserStartAudioCapture:
+    case RecordedCallback::kUserStopAudioCapture:
+    case RecordedCallback::kUserStartVideoCapture:
+    case RecordedCallback::kUserStopVideoCapture: {
+        auto room_id = r.getString();
+        auto user_id = r.getString();
+        if (!r.ok()) return false;
+        if (id == RecordedCallback::kUserStartAudioCapture) video->onUserStartAudioCapture(room_id, user_id);
+        else if (id == RecordedCallback::kUserStopAudioCapture) video->onUserStopAudioCapture(room_id, user_id);
+        else if (id == RecordedCallback::kUserStartVideoCapture) video->onUserStartVideoCapture(room_id, user_id);
+        else video->onUserStopVideoCapture(room_id, user_id);
+        return true;
+    }
+    case RecordedCallback::kFirstLocalAudioFrame: {
+        auto index = r.get<bytertc::StreamIndex>();
+        if (!r.ok()) return false;
+        video->onFirstLocalAudioFrame(index);
+        return true;
+    }
+    case RecordedCallback::kLogReport: {
+        auto log_type = r.getString();
+        auto log_content = r.getString();
+        if (!r.ok()) return false;
+        video->onLogReport(log_type, log_content);
+        return true;
+    }
+    case RecordedCallback::kUserPublishStream:
+    case RecordedCallback::kUserPublishScreen: {
+        auto uid = r.getString();
+        auto type = r.get<bytertc::MediaStreamType>();
+        if (!r.ok()) return false;
+        if (id == RecordedCallback::kUserPublishStream) room->onUserPublishStream(uid, type);
+        else room->onUserPublishScreen(uid, type);
+        return true;
+    }
+    case RecordedCallback::kUserUnpublishStream:
+    case RecordedCallback::kUserUnpublishScreen: {
+        auto uid = r.getString();
+        auto type = r.get<bytertc::MediaStreamType>();
+        auto reason = r.get<bytertc::StreamRemoveReason>();
+        if (!r.ok()) return false;
+        if (id == RecordedCallback::kUserUnpublishStream) room->onUserUnpublishStream(uid, type, reason);
+        else room->onUserUnpublishScreen(uid, type, reason);
+        return true;
+    }
+    case RecordedCallback::kStreamSubscribed: {
+        auto state = r.get<bytertc::SubscribeState>();
+        auto user_id = r.getString();
+        auto info = r.get<bytertc::SubscribeConfig>();
+        if (!r.ok()) return false;
+        room->onStreamSubscribed(state, user_id, info);
+        return true;
+    }
+    case RecordedCallback::kStreamPublishSuccess: {
+        auto user_id = r.getString();
+        auto is_screen = r.get<bool>();
+        if (!r.ok()) return false;
+        room->onStreamPublishSuccess(user_id, is_screen);
+        return true;
+    }
+    case RecordedCallback::kFirstLocalVideoFrameCaptured: {
+        auto index = r.get<bytertc::StreamIndex>();
+        auto info = r.get<bytertc::VideoFrameInfo>();
+        if (!r.ok()) return false;
+        video->onFirstLocalVideoFrameCaptured(index, info);
+        return true;
+    }
+    case RecordedCallback::kFirstRemoteVideoFrameDecoded: {
+        bytertc::RemoteStreamKey key;
+        key.stream_index = r.get<bytertc::StreamIndex>();
+        key.room_id = r.getString();
+        key.user_id = r.getString();
+        auto info = r.get<bytertc::VideoFrameInfo>();
+        if (!r.ok()) return false;
+        video->onFirstRemoteVideoFrameDecoded(key, info);
+        return true;
+    }
+    case RecordedCallback::kAudioDeviceStateChanged: {
+        auto device_id = r.getString();
+        auto type = r.get<bytertc::RTCAudioDeviceType>();
+        auto state = r.get<bytertc::MediaDeviceState>();
+        auto error = r.get<bytertc::MediaDeviceError>();
+        if (!r.ok()) return false;
+        video->onAudioDeviceStateChanged(device_id, type, state, error);
+        return true;
+    }
+    case RecordedCallback::kVideoDeviceStateChanged: {
+        auto device_id = r.getString();
+        auto type = r.get<bytertc::RTCVideoDeviceType>();
+        auto state = r.get<bytertc::MediaDeviceState>();
+        auto error = r.get<bytertc::MediaDeviceError>();
+        if (!r.ok()) return false;
+        video->onVideoDeviceStateChanged(device_id, type, state, error);
+        return true;
+    }
+    case RecordedCallback::kAudioPlaybackDeviceTestVolume: {
+        auto volume = r.get<int>();
+        if (!r.ok()) return false;
+        video->onAudioPlaybackDeviceTestVolume(volume);
+        return true;
+    }
+    case RecordedCallback::kLocalVideoStateChanged: {
+        auto index = r.get<bytertc::StreamIndex>();
+        auto state = r.get<bytertc::LocalVideoStreamState>();
+        auto error = r.get<bytertc::LocalVideoStreamError>();
+        if (!r.ok()) return false;
+        video->onLocalVideoStateChanged(index, state, error);
+        return true;
+    }
+    case RecordedCallback::kLocalAudioStateChanged: {
+        auto state = r.get<bytertc::LocalAudioStreamState>();
+        auto error = r.get<bytertc::LocalAudioStreamError>();
+        if (!r.ok()) return false;
+        video->onLocalAudioStateChanged(state, error);
+        return true;
+    }
+    case RecordedCallback::kSysStats: {
+        auto stats = r.get<bytertc::SysStats>();
+        if (!r.ok()) return false;
+        video->onSysStats(stats);
+        return true;
+    }
+    case RecordedCallback::kNetworkTypeChanged: {
+        auto type = r.get<bytertc::NetworkType>();
+        if (!r.ok()) return false;
+        video->onNetworkTypeChanged(type);
+        return true;
+    }
+    case RecordedCallback::kLoginResult: {
+        auto uid = r.getString();
+        auto error_code = r.get<int>();
+        auto elapsed = r.get<int>();
+        if (!r.ok()) return false;
+        video->onLoginResult(uid, error_code, elapsed);
+        return true;
+    }
+    case RecordedCallback::kServerParamsSetResult: {
+        auto error = r.get<int>();
+        if (!r.ok()) return false;
+        video->onServerParamsSetResult(error);
+        return true;
+    }
+    case RecordedCallback::kRoomMessageReceived:
+    case RecordedCallback::kUserMessageReceived:
+    case RecordedCallback::kUserMessageReceivedOutsideRoom: {
+        auto uid = r.getString();
+        auto message = r.getString();
+        if (!r.ok()) return false;
+        if (id == RecordedCallback::kRoomMessageReceived) room->onRoomMessageReceived(uid, message);
+        else if (id == RecordedCallback::kUserMessageReceived) room->onUserMessageReceived(uid, message);
+        else video->onUserMessageReceivedOutsideRoom(uid, message);
+        return true;
+    }
+    case RecordedCallback::kServerMessageSendResult: {
+        auto msgid = r.get<int64_t>();
+        auto error = r.get<int>();
+        if (!r.ok()) return false;
+        bytertc::ServerACKMsg msg = bytertc::ServerACKMsg();
+        video->onServerMessageSendResult(msgid, error, msg);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+}  // namespace vrd
@@ -0,0 +1,194 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bytertc_video_event_handler.h"
+#include "bytertc_room_event_handler.h"
+#include "core/id_table.h"
+
+namespace vrd {
+
+// Callback tags stored in recordings, append only so old recordings keep replaying
+enum class RecordedCallback : uint16_t {
+    kNone = 0,
+    kRoomStateChanged,
+    kRoomStats,
+    kLocalStreamStats,
+    kRemoteStreamStats,
+    kWarning,
+    kError,
+    kRemoteAudioPropertiesReport,
+    kLocalAudioPropertiesReport,
+    kLeaveRoom,
+    kUserJoined,
+    kUserLeave,
+    kUserStartAudioCapture,
+    kUserStopAudioCapture,
+    kFirstLocalAudioFrame,
+    kLogReport,
+    kUserPublishStream,
+    kUserUnpublishStream,
+    kUserPublishScreen,
+    kUserUnpublishScreen,
+    kStreamSubscribed,
+    kStreamPublishSuccess,
+    kFirstLocalVideoFrameCaptured,
+    kFirstRemoteVideoFrameDecoded,
+    kUserStartVideoCapture,
+    kUserStopVideoCapture,
+    kAudioDeviceStateChanged,
+    kVideoDeviceStateChanged,
+    kAudioPlaybackDeviceTestVolume,
+    kLocalVideoStateChanged,
+    kLocalAudioStateChanged,
+    kSysStats,
+    kNetworkTypeChanged,
+    kLoginResult,
+    kServerParamsSetResult,
+    kRoomMessageReceived,
+    kUserMessageReceived,
+    kUserMessageReceivedOutsideRoom,
+    kServerMessageSendResult,
+};
+
+// Callback argument that is an SDK-owned array
+template <typename T>
+struct RecordArray {
+    const T* items;
+    int count;
+};
+
+/**
+* Append-only byte buffer for one record body
+* Plain structs are stored as raw bytes, so a recording is only replayable with the SDK headers it was made with
+*/
+class RecordWriter {
+public:
+    void clear() { bytes_.clear(); }
+    const std::string& bytes() const { return bytes_; }
+
+    template <typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "record fields must be trivially copyable");
+        bytes_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    // Length-prefixed and NUL-terminated so the player can hand out pointers into the record
+    void putString(const char* str);
+
+private:
+    std::string bytes_;
+};
+
+namespace record_detail {
+
+template <typename T>
+typename std::enable_if<!std::is_pointer<T>::value>::type encode(RecordWriter& w, const T& value) {
+    w.put(value);
+}
+void encode(RecordWriter& w, const char* str);
+void encode(RecordWriter& w, const bytertc::UserInfo& info);
+void encode(RecordWriter& w, const bytertc::RemoteStreamKey& key);
+void encode(RecordWriter& w, const bytertc::RemoteStreamStats& stats);
+void encode(RecordWriter& w, const bytertc::ServerACKMsg& msg);
+void encode(RecordWriter& w, const RecordArray<bytertc::RemoteAudioPropertiesInfo>& infos);
+void encode(RecordWriter& w, const RecordArray<bytertc::LocalAudioPropertiesInfo>& infos);
+
+inline void encodeAll(RecordWriter&) {}
+
+template <typename First, typename... Rest>
+void encodeAll(RecordWriter& w, const First& first, const Rest&... rest) {
+    encode(w, first);
+    encodeAll(w, rest...);
+}
+
+}  // namespace record_detail
+
+/**
+* Writes SDK callbacks with their arguments, the room they came through and a monotonic timestamp to a binary file
+* record() is called from SDK threads and costs one relaxed load while no recording is active
+*/
+class CallbackRecorder {
+public:
+    ~CallbackRecorder();
+
+    bool start(const std::string& path);
+    void stop();
+    bool active() const { return active_.load(std::memory_order_relaxed); }
+    uint64_t recordCount() const { return records_.load(std::memory_order_relaxed); }
+    // Callbacks of this room are flagged as main room ones, so a replay can route them to whatever room is main then
+    void setMainRoom(IdHandle room) { main_room_.store(room, std::memory_order_relaxed); }
+
+    // room is the room whose handler received the callback, kInvalidIdHandle for engine callbacks
+    template <typename... Args>
+    void record(IdHandle room, RecordedCallback id, const Args&... args) {
+        if (!active()) return;
+        auto& writer = scratch();
+        writer.clear();
+        writer.putString(room != kInvalidIdHandle ? IdTable::instance().str(room).c_str() : nullptr);
+        record_detail::encodeAll(writer, args...);
+        append(id, room != kInvalidIdHandle && room == main_room_.load(std::memory_order_relaxed), writer);
+    }
+
+private:
+    static RecordWriter& scratch();
+    void append(RecordedCallback id, bool main_room, const RecordWriter& body);
+
+    std::atomic<bool> active_{ false };
+    std::atomic<IdHandle> main_room_{ kInvalidIdHandle };
+    std::atomic<uint64_t> records_{ 0 };
+    std::mutex mutex_;
+    FILE* file_ = nullptr;
+    uint64_t start_ns_ = 0;
+};
+
+/**
+* Re-injects a recording into SDK event handlers on the calling thread
+* Engine callbacks go to the video handler, room callbacks to the handler RoomHandlers picks for their room
+*/
+class CallbackPlayer {
+public:
+    enum class Pace { kOriginal, kAsFastAsPossible };
+
+    // Handler of the recorded room, room_id is null for callbacks recorded outside any room and main_room
+    // tells the main room of the recording. nullptr skips the callback, e.g. a sub-room that is not open
+    using RoomHandlers = std::function<bytertc::IRTCRoomEventHandler*(const char* room_id, bool main_room)>;
+
+    struct Result {
+        bool ok = false;
+        uint64_t callbacks = 0;
+        // records with an unknown tag, e.g. made by a newer build, or of a room without a handler
+        uint64_t skipped = 0;
+        uint64_t duration_ns = 0;
+    };
+
+    explicit CallbackPlayer(std::string path);
+    ~CallbackPlayer();
+
+    // Reads the file header, false if the file is missing or not a recording
+    bool open();
+    // SDK version the recording was made with
+    const std::string& sdkVersion() const { return sdk_version_; }
+
+    Result play(bytertc::IRTCVideoEventHandler* video_handler, const RoomHandlers& room_handlers, Pace pace);
+
+private:
+    bool dispatch(RecordedCallback id, bool main_room, bytertc::IRTCVideoEventHandler* video_handler,
+        const RoomHandlers& room_handlers);
+
+    std::string path_;
+    FILE* file_ = nullptr;
+    std::string sdk_version_;
+    std::vector<char> body_;
+    std::vector<bytertc::RemoteAudioPropertiesInfo> remote_audio_;
+    std::vector<bytertc::LocalAudioPropertiesInfo> local_audio_;
+};
+
+}  // namespace vrd
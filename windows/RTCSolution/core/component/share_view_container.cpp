@@ -33,9 +33,18 @@ void ShareViewContainer::addItem(const SnapshotAttr& item, QPixmap&& map) {
     ++item_count_;
 }
 
+void ShareViewContainer::updateItem(int index, QPixmap&& map) {
+    if (index < 0 || index >= static_cast<int>(share_wnds_.size())) return;
+    auto w = share_wnds_[index].first;
+    w->setPixMap(map);
+    w->update();
+}
+
 void ShareViewContainer::clear() {
     for (auto& pair : share_wnds_) {
         lay_->removeWidget(pair.first);
         pair.first->deleteLater();
     }
+    share_wnds_.clear();
+    item_count_ = 0;
 }
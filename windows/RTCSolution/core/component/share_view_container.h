@@ -12,6 +12,8 @@ class ShareViewContainer : public QWidget {
   ~ShareViewContainer();
 
   void addItem(const SnapshotAttr& item, QPixmap&& map);
+  // Replaces the thumbnail of the index-th added item
+  void updateItem(int index, QPixmap&& map);
   void clear();
  signals:
   void sigItemPressed(SnapshotAttr item);
@@ -0,0 +1,233 @@
+#include "device_registry.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vrd {
+
+namespace {
+
+// Size of the name and id buffers the SDK fills, see IDeviceCollection::getDevice
+constexpr size_t kDeviceStringSize = 512;
+
+bool sameDevices(const DeviceList& lhs, const DeviceList& rhs) {
+    if (lhs.selected != rhs.selected || lhs.capture_ok != rhs.capture_ok
+        || lhs.devices.size() != rhs.devices.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.devices.size(); i++) {
+        if (lhs.devices[i].device_id != rhs.devices[i].device_id
+            || lhs.devices[i].name != rhs.devices[i].name) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+DeviceRegistry::DeviceRegistry(int debounce_ms, int max_delay_ms)
+    : debounce_(debounce_ms), max_delay_(std::max(max_delay_ms, debounce_ms)) {}
+
+DeviceRegistry::~DeviceRegistry() {
+    stop();
+}
+
+void DeviceRegistry::start(bytertc::IAudioDeviceManager* audio_manager,
+        bytertc::IVideoDeviceManager* video_manager, ChangedFn on_changed) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(enumerate_mutex_);
+        audio_manager_ = audio_manager;
+        video_manager_ = video_manager;
+        on_changed_ = std::move(on_changed);
+        for (int i = 0; i < kDeviceKindCount; i++) {
+            store(static_cast<DeviceKind>(i), nullptr);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        running_ = true;
+        dirty_ = 0;
+    }
+    worker_ = std::thread(&DeviceRegistry::workerLoop, this);
+}
+
+void DeviceRegistry::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wait_cv_.notify_all();
+    worker_.join();
+
+    std::lock_guard<std::mutex> lock(enumerate_mutex_);
+    audio_manager_ = nullptr;
+    video_manager_ = nullptr;
+    on_changed_ = nullptr;
+}
+
+void DeviceRegistry::invalidate(DeviceKind kind) {
+    ++invalidations_;
+    {
+        std::lock_guard<std::mutex> lock(wait_mutex_);
+        if (!running_) return;
+        dirty_ |= 1u << static_cast<int>(kind);
+        last_invalidate_ = std::chrono::steady_clock::now();
+    }
+    wait_cv_.notify_all();
+}
+
+std::shared_ptr<const DeviceList> DeviceRegistry::devices(DeviceKind kind) {
+    if (auto list = load(kind)) return list;
+    // Cold start only, a UI read raced the worker's first enumeration
+    std::lock_guard<std::mutex> lock(enumerate_mutex_);
+    if (auto list = load(kind)) return list;
+    std::shared_ptr<const DeviceList> list = enumerate(kind);
+    store(kind, list);
+    return list;
+}
+
+bool DeviceRegistry::select(DeviceKind kind, int index) {
+    std::lock_guard<std::mutex> lock(enumerate_mutex_);
+    auto current = load(kind);
+    if (!current || index < 0 || index >= static_cast<int>(current->devices.size())) {
+        return false;
+    }
+    if (current->selected == index) return true;
+    auto next = std::make_shared<DeviceList>(*current);
+    next->selected = index;
+    next->generation = ++generation_;
+    store(kind, std::move(next));
+    return true;
+}
+
+DeviceRegistry::Stats DeviceRegistry::stats() const {
+    Stats s;
+    s.invalidations = invalidations_.load();
+    s.enumerations = enumerations_.load();
+    s.probes = probes_.load();
+    s.unchanged = unchanged_.load();
+    return s;
+}
+
+void DeviceRegistry::workerLoop() {
+    for (int i = 0; i < kDeviceKindCount; i++) {
+        refresh(static_cast<DeviceKind>(i), false);
+    }
+    while (unsigned dirty = waitDirty()) {
+        for (int i = 0; i < kDeviceKindCount; i++) {
+            if (dirty & (1u << i)) refresh(static_cast<DeviceKind>(i), true);
+        }
+    }
+}
+
+unsigned DeviceRegistry::waitDirty() {
+    std::unique_lock<std::mutex> lock(wait_mutex_);
+    wait_cv_.wait(lock, [this] { return !running_ || dirty_ != 0; });
+    // Hold off until the device events go quiet, but never longer than max_delay_ so a
+    // device that keeps flapping still gets its list refreshed
+    auto give_up = std::chrono::steady_clock::now() + max_delay_;
+    while (running_) {
+        auto deadline = std::min(last_invalidate_ + debounce_, give_up);
+        if (std::chrono::steady_clock::now() >= deadline) break;
+        wait_cv_.wait_until(lock, deadline, [this] { return !running_; });
+    }
+    if (!running_) return 0;
+    unsigned dirty = dirty_;
+    dirty_ = 0;
+    return dirty;
+}
+
+void DeviceRegistry::refresh(DeviceKind kind, bool notify) {
+    ChangedFn on_changed;
+    {
+        std::lock_guard<std::mutex> lock(enumerate_mutex_);
+        auto previous = load(kind);
+        auto next = enumerate(kind);
+        if (previous && sameDevices(*previous, *next)) {
+            ++unchanged_;
+            return;
+        }
+        store(kind, std::move(next));
+        if (notify && previous) on_changed = on_changed_;
+    }
+    if (on_changed) on_changed(kind);
+}
+
+std::shared_ptr<DeviceList> DeviceRegistry::enumerate(DeviceKind kind) {
+    auto list = std::make_shared<DeviceList>();
+    list->generation = ++generation_;
+
+    bytertc::IDeviceCollection* collection = nullptr;
+    int type = RtcDeviceTypeAudioRecord;
+    char selected_id[kDeviceStringSize] = { 0 };
+    switch (kind) {
+    case DeviceKind::kAudioInput:
+        if (!audio_manager_) return list;
+        collection = audio_manager_->enumerateAudioCaptureDevices();
+        audio_manager_->getAudioCaptureDevice(selected_id);
+        break;
+    case DeviceKind::kAudioOutput:
+        if (!audio_manager_) return list;
+        collection = audio_manager_->enumerateAudioPlaybackDevices();
+        audio_manager_->getAudioPlaybackDevice(selected_id);
+        type = RtcDeviceTypeAudioPlayout;
+        break;
+    case DeviceKind::kVideoCapture:
+        if (!video_manager_) return list;
+        collection = video_manager_->enumerateVideoCaptureDevices();
+        video_manager_->getVideoCaptureDevice(selected_id);
+        type = RtcDeviceTypeVideoCapture;
+        break;
+    default:
+        return list;
+    }
+    if (!collection) return list;
+    ++enumerations_;
+
+    // getDevice writes NUL-terminated strings, the buffers only need a terminator up front
+    char name[kDeviceStringSize];
+    char id[kDeviceStringSize];
+    int count = collection->getCount();
+    list->devices.reserve(std::max(count, 0));
+    for (int i = 0; i < count; ++i) {
+        name[0] = '\0';
+        id[0] = '\0';
+        if (collection->getDevice(i, name, id) != 0) continue;
+        if (strcmp(selected_id, id) == 0) {
+            list->selected = static_cast<int>(list->devices.size());
+        }
+        RtcDevice device;
+        device.type = type;
+        device.name = name;
+        device.device_id = id;
+        list->devices.push_back(std::move(device));
+    }
+    collection->release();
+
+    if (list->selected < 0 && !list->devices.empty()) list->selected = 0;
+
+    // Opening a microphone is slow, the result is kept with the list until the next device change
+    if (kind == DeviceKind::kAudioInput) {
+        for (const auto& device : list->devices) {
+            ++probes_;
+            if (audio_manager_->initAudioCaptureDeviceForTest(device.device_id.c_str()) == 0) {
+                list->capture_ok = true;
+                break;
+            }
+        }
+    }
+    return list;
+}
+
+std::shared_ptr<const DeviceList> DeviceRegistry::load(DeviceKind kind) const {
+    return std::atomic_load(&lists_[static_cast<int>(kind)]);
+}
+
+void DeviceRegistry::store(DeviceKind kind, std::shared_ptr<const DeviceList> list) {
+    std::atomic_store(&lists_[static_cast<int>(kind)], std::move(list));
+}
+
+}  // namespace vrd
@@ -0,0 +1,121 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bytertc_video.h"
+
+enum {
+    RtcDeviceTypeVideoCapture = 0,
+    RtcDeviceTypeAudioRecord,
+    RtcDeviceTypeAudioPlayout,
+};
+
+struct RtcDevice {
+    std::string name;
+    std::string device_id;
+    int type;
+};
+
+namespace vrd {
+
+enum class DeviceKind : int {
+    kAudioInput = 0,
+    kAudioOutput,
+    kVideoCapture,
+    kCount,
+};
+
+static constexpr int kDeviceKindCount = static_cast<int>(DeviceKind::kCount);
+
+/**
+* Immutable result of one enumeration, shared by every reader until the next one is published
+*/
+struct DeviceList {
+    std::vector<RtcDevice> devices;
+    // Index of the device the engine is using, -1 when the list is empty
+    int selected = -1;
+    // Audio input only, at least one capture device passed initAudioCaptureDeviceForTest
+    bool capture_ok = false;
+    uint64_t generation = 0;
+};
+
+/**
+* Cache of the audio and video device lists kept up to date by a background thread
+* Enumeration and capture health probing run on the worker when a device state change invalidates a list,
+* bursts of invalidations within the debounce window collapse into one enumeration per kind.
+* Readers get the published list in O(1) and never call into the device managers
+*/
+class DeviceRegistry {
+public:
+    // Called on the worker thread after a republished list differs from the previous one
+    using ChangedFn = std::function<void(DeviceKind)>;
+
+    struct Stats {
+        uint64_t invalidations = 0;
+        uint64_t enumerations = 0;
+        uint64_t probes = 0;
+        uint64_t unchanged = 0;
+    };
+
+    explicit DeviceRegistry(int debounce_ms = 300, int max_delay_ms = 1000);
+    ~DeviceRegistry();
+
+    DeviceRegistry(const DeviceRegistry&) = delete;
+    DeviceRegistry& operator=(const DeviceRegistry&) = delete;
+
+    // The managers must outlive stop(), every list is enumerated once on the worker right away
+    void start(bytertc::IAudioDeviceManager* audio_manager,
+        bytertc::IVideoDeviceManager* video_manager, ChangedFn on_changed);
+    void stop();
+
+    // Any thread, typically an SDK device callback
+    void invalidate(DeviceKind kind);
+    // Any thread, only enumerates on the calling thread if the worker has not published the list yet
+    std::shared_ptr<const DeviceList> devices(DeviceKind kind);
+    // Records a selection made through the device manager, false if index is out of range
+    bool select(DeviceKind kind, int index);
+    Stats stats() const;
+
+private:
+    void workerLoop();
+    // Waits out the debounce window, returns the dirty kinds or 0 when stopping
+    unsigned waitDirty();
+    void refresh(DeviceKind kind, bool notify);
+    std::shared_ptr<DeviceList> enumerate(DeviceKind kind);
+    std::shared_ptr<const DeviceList> load(DeviceKind kind) const;
+    void store(DeviceKind kind, std::shared_ptr<const DeviceList> list);
+
+    const std::chrono::milliseconds debounce_;
+    const std::chrono::milliseconds max_delay_;
+
+    bytertc::IAudioDeviceManager* audio_manager_ = nullptr;
+    bytertc::IVideoDeviceManager* video_manager_ = nullptr;
+    ChangedFn on_changed_;
+
+    std::shared_ptr<const DeviceList> lists_[kDeviceKindCount];
+    // Serializes enumeration and selection, the device managers are not called concurrently
+    std::mutex enumerate_mutex_;
+
+    std::thread worker_;
+    bool running_ = false;
+    unsigned dirty_ = 0;
+    std::chrono::steady_clock::time_point last_invalidate_;
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    std::atomic<uint64_t> invalidations_{ 0 };
+    std::atomic<uint64_t> enumerations_{ 0 };
+    std::atomic<uint64_t> probes_{ 0 };
+    std::atomic<uint64_t> unchanged_{ 0 };
+    std::atomic<uint64_t> generation_{ 0 };
+};
+
+}  // namespace vrd
@@ -0,0 +1,72 @@
+#include "event_bus.h"
+
+#include <QCoreApplication>
+
+namespace vrd {
+
+static QEvent::Type wakeEventType() {
+    static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+    return type;
+}
+
+EventBusBase::EventBusBase(QObject* receiver) : receiver_(receiver) {}
+
+void EventBusBase::onPushed(size_t depth) {
+    posted_.fetch_add(1, std::memory_order_relaxed);
+
+    auto max_depth = max_depth_.load(std::memory_order_relaxed);
+    while (depth > max_depth &&
+        !max_depth_.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed)) {
+    }
+
+    if (!wake_pending_.exchange(true)) {
+        wake();
+    }
+}
+
+void EventBusBase::onDropped() {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventBusBase::onShed() {
+    shed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventBusBase::onCoalesced() {
+    coalesced_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventBusBase::beginDrain() {
+    // Clear the flag before popping, an item pushed after this point posts its own wake-up
+    wake_pending_.exchange(false);
+}
+
+void EventBusBase::endDrain(size_t count, bool backlog) {
+    dispatched_.fetch_add(count, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    if (backlog && !wake_pending_.exchange(true)) {
+        wake();
+    }
+}
+
+EventBusBase::Stats EventBusBase::counters() const {
+    Stats s;
+    s.max_depth = max_depth_.load(std::memory_order_relaxed);
+    s.posted = posted_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.dispatched = dispatched_.load(std::memory_order_relaxed);
+    s.batches = batches_.load(std::memory_order_relaxed);
+    s.shed = shed_.load(std::memory_order_relaxed);
+    s.coalesced = coalesced_.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool EventBusBase::isWakeEvent(const QEvent* e) {
+    return e->type() == wakeEventType();
+}
+
+void EventBusBase::wake() {
+    QCoreApplication::postEvent(receiver_, new QEvent(wakeEventType()));
+}
+
+}  // namespace vrd
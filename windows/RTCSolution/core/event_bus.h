@@ -0,0 +1,312 @@
+#pragma once
+#include <QEvent>
+#include <QObject>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace vrd {
+
+/**
+* Bounded multi-producer/single-consumer ring buffer
+* Producers claim a slot with one CAS and never block or allocate, a full ring rejects the push
+* Only one thread may pop
+*/
+template <typename T>
+class MpscRing {
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscRing(size_t capacity) {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        slots_.reset(new Slot[cap]);
+        for (size_t i = 0; i < cap; i++) {
+            slots_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    bool tryPush(T&& value) {
+        Slot* slot = nullptr;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread only
+    bool tryPop(T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot = &slots_[pos & mask_];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+        value = std::move(slot->value);
+        slot->value = T();
+        slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+        tail_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        auto head = head_.load(std::memory_order_acquire);
+        auto tail = tail_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+    alignas(64) std::atomic<size_t> head_{ 0 };
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+};
+
+/**
+* Non-template part of EventBus: wake-up posting and counters
+*/
+class EventBusBase {
+public:
+    struct Stats {
+        size_t capacity = 0;
+        // items waiting to be dispatched
+        size_t depth = 0;
+        // highest depth observed since construction
+        size_t max_depth = 0;
+        uint64_t posted = 0;
+        // items rejected because the ring was full
+        uint64_t dropped = 0;
+        uint64_t dispatched = 0;
+        // number of drain passes, dispatched / batches is the average batch size
+        uint64_t batches = 0;
+        // low-priority items rejected because their lane was full
+        uint64_t shed = 0;
+        // low-priority items superseded by a newer one of the same key before dispatch
+        uint64_t coalesced = 0;
+    };
+
+    static bool isWakeEvent(const QEvent* e);
+
+protected:
+    explicit EventBusBase(QObject* receiver);
+
+    void onPushed(size_t depth);
+    void onDropped();
+    void onShed();
+    void onCoalesced();
+    void beginDrain();
+    void endDrain(size_t count, bool backlog);
+    Stats counters() const;
+
+private:
+    void wake();
+
+    QObject* receiver_;
+    std::atomic<bool> wake_pending_{ false };
+    std::atomic<size_t> max_depth_{ 0 };
+    std::atomic<uint64_t> posted_{ 0 };
+    std::atomic<uint64_t> dropped_{ 0 };
+    std::atomic<uint64_t> dispatched_{ 0 };
+    std::atomic<uint64_t> batches_{ 0 };
+    std::atomic<uint64_t> shed_{ 0 };
+    std::atomic<uint64_t> coalesced_{ 0 };
+};
+
+/**
+* Forwards items from worker threads to the thread owning the receiver
+* Items are queued in a preallocated ring, and only the first item after a drain posts a wake-up event,
+* so a burst of callbacks costs one event loop iteration instead of one QEvent each
+*/
+template <typename T>
+class EventBus : public EventBusBase {
+public:
+    using Handler = std::function<void(T&)>;
+
+    EventBus(QObject* receiver, Handler handler, size_t capacity = 4096)
+        : EventBusBase(receiver), ring_(capacity), handler_(std::move(handler)) {}
+
+    // Any thread, returns false and counts a drop when the ring is full
+    bool post(T&& item) {
+        if (!ring_.tryPush(std::move(item))) {
+            onDropped();
+            return false;
+        }
+        onPushed(ring_.size());
+        return true;
+    }
+
+    // Receiver thread, called from customEvent when isWakeEvent returns true
+    size_t drain() {
+        beginDrain();
+        // Bound one pass to the ring size so continuous producers cannot starve the event loop
+        const size_t budget = ring_.capacity();
+        size_t count = 0;
+        T item;
+        while (count < budget && ring_.tryPop(item)) {
+            handler_(item);
+            ++count;
+        }
+        endDrain(count, count == budget && ring_.size() > 0);
+        return count;
+    }
+
+    Stats stats() const {
+        auto s = counters();
+        s.capacity = ring_.capacity();
+        s.depth = ring_.size();
+        return s;
+    }
+
+private:
+    MpscRing<T> ring_;
+    Handler handler_;
+};
+
+/**
+* EventBus with a control lane and a telemetry lane sharing one wake-up
+* Control items are always dispatched first, including ones that arrive while telemetry is being dispatched.
+* Telemetry has its own smaller ring and is shed when that ring is full, and within one drain pass
+* telemetry items with the same key collapse to the newest one
+*/
+template <typename T>
+class PriorityEventBus : public EventBusBase {
+public:
+    enum class Lane { kControl, kTelemetry };
+
+    using Handler = std::function<void(T&)>;
+    // Coalescing key of a telemetry item in [0, key_count), negative to never coalesce it
+    using KeyFn = int (*)(const T&);
+    // Releases whatever a superseded telemetry item still owns, it is not passed to the handler
+    using DiscardFn = std::function<void(T&)>;
+
+    PriorityEventBus(QObject* receiver, Handler handler, KeyFn key, size_t key_count, DiscardFn discard,
+            size_t control_capacity = 4096, size_t telemetry_capacity = 1024)
+        : EventBusBase(receiver),
+          control_(control_capacity),
+          telemetry_(telemetry_capacity),
+          handler_(std::move(handler)),
+          key_(key),
+          discard_(std::move(discard)),
+          key_slots_(key_count, -1) {
+        batch_.reserve(telemetry_.capacity());
+    }
+
+    // Any thread, returns false when the lane is full, the item is left untouched for the caller to release
+    bool post(T&& item, Lane lane) {
+        auto& ring = lane == Lane::kControl ? control_ : telemetry_;
+        if (!ring.tryPush(std::move(item))) {
+            if (lane == Lane::kControl) {
+                onDropped();
+            }
+            else {
+                onShed();
+            }
+            return false;
+        }
+        onPushed(control_.size() + telemetry_.size());
+        return true;
+    }
+
+    // Receiver thread, called from customEvent when isWakeEvent returns true
+    size_t drain() {
+        beginDrain();
+        const size_t budget = control_.capacity();
+        size_t count = drainControl(budget);
+        if (count == budget) {
+            // Still flooded with control items, telemetry waits for the next pass
+            endDrain(count, true);
+            return count;
+        }
+
+        T item;
+        while (batch_.size() < telemetry_.capacity() && telemetry_.tryPop(item)) {
+            int key = key_(item);
+            if (key < 0 || static_cast<size_t>(key) >= key_slots_.size()) {
+                batch_.push_back(std::move(item));
+                continue;
+            }
+            int& slot = key_slots_[key];
+            if (slot < 0) {
+                slot = static_cast<int>(batch_.size());
+                batch_.push_back(std::move(item));
+            }
+            else {
+                discard_(batch_[slot]);
+                batch_[slot] = std::move(item);
+                onCoalesced();
+            }
+        }
+
+        for (auto& telemetry : batch_) {
+            count += drainControl(budget);
+            handler_(telemetry);
+            ++count;
+        }
+        batch_.clear();
+        std::fill(key_slots_.begin(), key_slots_.end(), -1);
+
+        endDrain(count, control_.size() > 0 || telemetry_.size() > 0);
+        return count;
+    }
+
+    Stats stats() const {
+        auto s = counters();
+        s.capacity = control_.capacity() + telemetry_.capacity();
+        s.depth = control_.size() + telemetry_.size();
+        return s;
+    }
+
+private:
+    size_t drainControl(size_t budget) {
+        size_t count = 0;
+        T item;
+        while (count < budget && control_.tryPop(item)) {
+            handler_(item);
+            ++count;
+        }
+        return count;
+    }
+
+    MpscRing<T> control_;
+    MpscRing<T> telemetry_;
+    Handler handler_;
+    KeyFn key_;
+    DiscardFn discard_;
+    // Receiver thread scratch: telemetry popped in the current pass and the batch index of each key
+    std::vector<T> batch_;
+    std::vector<int> key_slots_;
+};
+
+}  // namespace vrd
@@ -0,0 +1,23 @@
+#pragma once
+#include <QCoreApplication>
+#include <QEvent>
+#include <QObject>
+#include <functional>
+
+/**
+* Qt custom event class, used to forward the data of the worker thread 
+*  to the main thread for processing
+*/
+class ForwardEvent : public QEvent {
+public:
+    ForwardEvent(std::function<void(void)>&& task)
+        : QEvent(User), task_(std::move(task)) {}
+    void execTask() {
+        if (task_) task_();
+    }
+    static void PostEvent(QObject* obj, std::function<void()>&& task) {
+        ForwardEvent* event = new ForwardEvent(std::move(task));
+        QCoreApplication::postEvent(obj, event);
+    }
+    std::function<void(void)> task_;
+};
@@ -0,0 +1,138 @@
+#include "id_table.h"
+
+#include <cstring>
+
+namespace vrd {
+
+static uint32_t hashId(const char* str, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+IdTable& IdTable::instance() {
+    static IdTable table;
+    return table;
+}
+
+IdTable::Index::Index(size_t bucket_count)
+    : mask(bucket_count - 1),
+      buckets(new std::atomic<IdHandle>[bucket_count]) {
+    for (size_t i = 0; i < bucket_count; i++) {
+        buckets[i].store(kInvalidIdHandle, std::memory_order_relaxed);
+    }
+}
+
+IdTable::IdTable() : chunks_(new std::atomic<Entry*>[kMaxChunks]) {
+    for (size_t i = 0; i < kMaxChunks; i++) {
+        chunks_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    // The first chunk also holds the empty entry of kInvalidIdHandle
+    chunk_storage_.emplace_back(new Entry[kChunkSize]);
+    chunks_[0].store(chunk_storage_.back().get(), std::memory_order_relaxed);
+    indexes_.emplace_back(new Index(kChunkSize * 2));
+    index_.store(indexes_.back().get(), std::memory_order_release);
+}
+
+IdHandle IdTable::intern(const char* str) {
+    if (str == nullptr || *str == '\0') return kInvalidIdHandle;
+    auto len = strlen(str);
+    auto hash = hashId(str, len);
+    auto handle = lookup(str, len, hash);
+    if (handle != kInvalidIdHandle) return handle;
+
+    std::lock_guard<std::mutex> lock(insert_mutex_);
+    handle = lookup(str, len, hash);
+    if (handle != kInvalidIdHandle) return handle;
+
+    auto count = count_.load(std::memory_order_relaxed);
+    if (count >= kMaxIds) return kInvalidIdHandle;
+    handle = count + 1;
+    const size_t chunk = handle / kChunkSize;
+    if (!chunks_[chunk].load(std::memory_order_relaxed)) {
+        chunk_storage_.emplace_back(new Entry[kChunkSize]);
+        chunks_[chunk].store(chunk_storage_.back().get(), std::memory_order_release);
+    }
+    auto& added = chunks_[chunk].load(std::memory_order_relaxed)[handle % kChunkSize];
+    added.str.assign(str, len);
+    added.hash = hash;
+
+    auto index = index_.load(std::memory_order_relaxed);
+    if ((static_cast<size_t>(handle) + 1) * 2 > index->mask + 1) {
+        grow();
+        index = index_.load(std::memory_order_relaxed);
+    }
+    // Publishes the entry written above, to str() first and then to lookups, so a handle anyone can find
+    // always has its string
+    count_.store(handle, std::memory_order_release);
+    insert(*index, handle, hash);
+    return handle;
+}
+
+IdHandle IdTable::intern(const std::string& str) {
+    return intern(str.c_str());
+}
+
+IdHandle IdTable::find(const char* str) const {
+    if (str == nullptr || *str == '\0') return kInvalidIdHandle;
+    auto len = strlen(str);
+    return lookup(str, len, hashId(str, len));
+}
+
+IdHandle IdTable::find(const std::string& str) const {
+    return find(str.c_str());
+}
+
+const std::string& IdTable::str(IdHandle handle) const {
+    if (handle > count_.load(std::memory_order_acquire)) handle = kInvalidIdHandle;
+    return entry(handle).str;
+}
+
+size_t IdTable::size() const {
+    return count_.load(std::memory_order_acquire);
+}
+
+const IdTable::Entry& IdTable::entry(IdHandle handle) const {
+    return chunks_[handle / kChunkSize].load(std::memory_order_acquire)[handle % kChunkSize];
+}
+
+IdHandle IdTable::lookup(const char* str, size_t len, uint32_t hash) const {
+    const auto& index = *index_.load(std::memory_order_acquire);
+    size_t idx = hash & index.mask;
+    for (;;) {
+        auto handle = index.buckets[idx].load(std::memory_order_acquire);
+        if (handle == kInvalidIdHandle) return kInvalidIdHandle;
+        const auto& candidate = entry(handle);
+        if (candidate.hash == hash && candidate.str.size() == len
+            && memcmp(candidate.str.data(), str, len) == 0) {
+            return handle;
+        }
+        idx = (idx + 1) & index.mask;
+    }
+}
+
+void IdTable::insert(Index& index, IdHandle handle, uint32_t hash) {
+    size_t idx = hash & index.mask;
+    while (index.buckets[idx].load(std::memory_order_relaxed) != kInvalidIdHandle) {
+        idx = (idx + 1) & index.mask;
+    }
+    index.buckets[idx].store(handle, std::memory_order_release);
+}
+
+void IdTable::grow() {
+    const auto& current = *index_.load(std::memory_order_relaxed);
+    std::unique_ptr<Index> larger(new Index((current.mask + 1) * 2));
+    const auto count = count_.load(std::memory_order_relaxed);
+    for (IdHandle handle = 1; handle <= count; handle++) {
+        insert(*larger, handle, entry(handle).hash);
+    }
+    // Readers switch to the new index on their next lookup, the old one stays valid for those still probing it
+    index_.store(larger.get(), std::memory_order_release);
+    indexes_.push_back(std::move(larger));
+}
+
+}  // namespace vrd
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vrd {
+
+// Compact handle of an interned user or room id, 0 is never assigned
+using IdHandle = uint32_t;
+static constexpr IdHandle kInvalidIdHandle = 0;
+
+/**
+* Process-wide table mapping user and room id strings to integer handles
+* Looking up an id that was already seen is lock-free and allocation-free, only the first
+* sighting of an id takes the insert lock. Entries are never removed, so a handle and the
+* string behind it stay valid for the lifetime of the process. The table grows with the ids
+* seen, a long-running client meeting new users in every room never runs out of handles
+*/
+class IdTable {
+public:
+    static IdTable& instance();
+
+    // Any thread, returns the handle of str and assigns one on first use,
+    // kInvalidIdHandle for an empty id or past kMaxIds
+    IdHandle intern(const char* str);
+    IdHandle intern(const std::string& str);
+    // Any thread, never inserts, kInvalidIdHandle if the id was not interned yet
+    IdHandle find(const char* str) const;
+    IdHandle find(const std::string& str) const;
+    // Any thread, an empty string for kInvalidIdHandle or an unknown handle
+    const std::string& str(IdHandle handle) const;
+    size_t size() const;
+
+    // Entries are allocated a chunk at a time and never move, far more ids than a process meets
+    static constexpr size_t kChunkSize = 8192;
+    static constexpr size_t kMaxChunks = 4096;
+    static constexpr size_t kMaxIds = kChunkSize * kMaxChunks - 1;
+
+private:
+    struct Entry {
+        uint32_t hash = 0;
+        std::string str;
+    };
+
+    // Open addressing over handles, kept at twice the id count so probe sequences stay short
+    // and always hit an empty bucket
+    struct Index {
+        explicit Index(size_t bucket_count);
+        size_t mask;
+        std::unique_ptr<std::atomic<IdHandle>[]> buckets;
+    };
+
+    IdTable();
+    IdTable(const IdTable&) = delete;
+    IdTable& operator=(const IdTable&) = delete;
+
+    const Entry& entry(IdHandle handle) const;
+    IdHandle lookup(const char* str, size_t len, uint32_t hash) const;
+    static void insert(Index& index, IdHandle handle, uint32_t hash);
+    // Insert lock held, replaces the index with one twice as large
+    void grow();
+
+    std::unique_ptr<std::atomic<Entry*>[]> chunks_;
+    std::atomic<Index*> index_{ nullptr };
+    // Every index ever published, a lock-free reader may still probe a replaced one
+    std::vector<std::unique_ptr<Index>> indexes_;
+    std::vector<std::unique_ptr<Entry[]>> chunk_storage_;
+    std::atomic<uint32_t> count_{ 0 };
+    std::mutex insert_mutex_;
+};
+
+}  // namespace vrd
@@ -0,0 +1,676 @@
+#include "image_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define VRD_IMAGE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC emits any intrinsic regardless of /arch, GCC and Clang need the ISA enabled per function
+#if defined(VRD_IMAGE_X86) && !defined(_MSC_VER)
+#define VRD_TARGET_SSE2 __attribute__((target("sse2")))
+#define VRD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VRD_TARGET_SSE2
+#define VRD_TARGET_AVX2
+#endif
+
+namespace vrd {
+namespace image {
+
+namespace {
+
+constexpr int kRowAlign = 32;
+// A u16 accumulator holds the sum of at most this many 8-bit rows
+constexpr int kMaxU16Rows = 257;
+
+SimdLevel detectCpu() {
+#if defined(VRD_IMAGE_X86)
+    bool sse2 = false;
+    bool avx2 = false;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    sse2 = (info[3] >> 26) & 1;
+    bool osxsave = (info[2] >> 27) & 1;
+    bool avx = (info[2] >> 28) & 1;
+    // The OS must save the YMM registers on context switches as well
+    if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] >> 5) & 1;
+    }
+#else
+    __builtin_cpu_init();
+    sse2 = __builtin_cpu_supports("sse2");
+    avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return SimdLevel::kAvx2;
+    if (sse2) return SimdLevel::kSse2;
+#endif
+    return SimdLevel::kScalar;
+}
+
+std::atomic<int> g_simd_level{ -1 };
+
+inline uint8_t clamp255(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Fixed point with 6 fractional bits, the SIMD paths compute the same values in 16-bit lanes
+inline void yuvPixel(int y, int u, int v, uint8_t* dst) {
+    // 1.164 * 64 = 74.5, the half step comes from adding (y - 16) / 2
+    int c = (y - 16) * 74 + ((y - 16) >> 1) + 32;
+    int du = u - 128;
+    int dv = v - 128;
+    dst[0] = clamp255((c + 129 * du) >> 6);
+    dst[1] = clamp255((c - 25 * du - 52 * dv) >> 6);
+    dst[2] = clamp255((c + 102 * dv) >> 6);
+    dst[3] = 0xff;
+}
+
+// Row kernels, every SIMD version hands its unaligned tail to the scalar one
+
+void copyRowScalar(const uint8_t* src, uint8_t* dst, int width) {
+    for (int x = 0; x < width; x++) {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xff;
+        src += 4;
+        dst += 4;
+    }
+}
+
+void i420RowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst, int width) {
+    for (int x = 0; x < width; x++) {
+        yuvPixel(y[x], u[x >> 1], v[x >> 1], dst + x * 4);
+    }
+}
+
+void nv12RowScalar(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width) {
+    for (int x = 0; x < width; x++) {
+        yuvPixel(y[x], uv[(x >> 1) * 2], uv[(x >> 1) * 2 + 1], dst + x * 4);
+    }
+}
+
+void accumulateRowScalar(const uint8_t* src, uint16_t* acc, int count) {
+    for (int i = 0; i < count; i++) {
+        acc[i] = static_cast<uint16_t>(acc[i] + src[i]);
+    }
+}
+
+void blendRowsScalar(const uint8_t* a, const uint8_t* b, int weight, uint16_t* out, int count) {
+    const int inv = 256 - weight;
+    for (int i = 0; i < count; i++) {
+        out[i] = static_cast<uint16_t>(a[i] * inv + b[i] * weight);
+    }
+}
+
+#if defined(VRD_IMAGE_X86)
+
+VRD_TARGET_SSE2 void copyRowSse2(const uint8_t* src, uint8_t* dst, int width) {
+    const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_or_si128(p, alpha));
+    }
+    copyRowScalar(src + x * 4, dst + x * 4, width - x);
+}
+
+// Packs eight 16-bit B, G, R values and stores them as eight opaque BGRA pixels
+VRD_TARGET_SSE2 inline void storeBgra8(__m128i b, __m128i g, __m128i r, uint8_t* dst) {
+    __m128i b8 = _mm_packus_epi16(b, b);
+    __m128i g8 = _mm_packus_epi16(g, g);
+    __m128i r8 = _mm_packus_epi16(r, r);
+    __m128i bg = _mm_unpacklo_epi8(b8, g8);
+    __m128i ra = _mm_unpacklo_epi8(r8, _mm_set1_epi8(-1));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+// y, u and v hold eight 16-bit samples with the chroma already duplicated per pixel pair
+VRD_TARGET_SSE2 inline void yuvToBgra8Sse2(__m128i y, __m128i u, __m128i v, uint8_t* dst) {
+    __m128i luma = _mm_sub_epi16(y, _mm_set1_epi16(16));
+    __m128i c = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(luma, _mm_set1_epi16(74)),
+        _mm_srai_epi16(luma, 1)), _mm_set1_epi16(32));
+    __m128i du = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    __m128i dv = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    // Only B and R can leave the int16 range and only above 255, saturating keeps the clamped result exact
+    __m128i b = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(du, _mm_set1_epi16(129))), 6);
+    __m128i g = _mm_srai_epi16(_mm_sub_epi16(_mm_sub_epi16(c,
+        _mm_mullo_epi16(du, _mm_set1_epi16(25))), _mm_mullo_epi16(dv, _mm_set1_epi16(52))), 6);
+    __m128i r = _mm_srai_epi16(_mm_adds_epi16(c, _mm_mullo_epi16(dv, _mm_set1_epi16(102))), 6);
+    storeBgra8(b, g, r, dst);
+}
+
+VRD_TARGET_SSE2 void i420RowSse2(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+        uint8_t* dst, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int32_t u4, v4;
+        memcpy(&u4, u + x / 2, 4);
+        memcpy(&v4, v + x / 2, 4);
+        __m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero);
+        __m128i u16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(u4), zero);
+        __m128i v16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v4), zero);
+        yuvToBgra8Sse2(y16, _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), dst + x * 4);
+    }
+    i420RowScalar(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+}
+
+VRD_TARGET_SSE2 void nv12RowSse2(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low_byte = _mm_set1_epi16(0x00ff);
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i y16 = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + x)), zero);
+        __m128i pairs = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv + x));
+        __m128i u16 = _mm_and_si128(pairs, low_byte);
+        __m128i v16 = _mm_srli_epi16(pairs, 8);
+        yuvToBgra8Sse2(y16, _mm_unpacklo_epi16(u16, u16), _mm_unpacklo_epi16(v16, v16), dst + x * 4);
+    }
+    nv12RowScalar(y + x, uv + x, dst + x * 4, width - x);
+}
+
+VRD_TARGET_SSE2 void accumulateRowSse2(const uint8_t* src, uint16_t* acc, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i* a = reinterpret_cast<__m128i*>(acc + i);
+        _mm_storeu_si128(a, _mm_add_epi16(_mm_loadu_si128(a), _mm_unpacklo_epi8(s, zero)));
+        _mm_storeu_si128(a + 1, _mm_add_epi16(_mm_loadu_si128(a + 1), _mm_unpackhi_epi8(s, zero)));
+    }
+    accumulateRowScalar(src + i, acc + i, count - i);
+}
+
+VRD_TARGET_SSE2 void blendRowsSse2(const uint8_t* a, const uint8_t* b, int weight,
+        uint16_t* out, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16(static_cast<short>(256 - weight));
+    const __m128i wb = _mm_set1_epi16(static_cast<short>(weight));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i pa = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i pb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        // At most 255 * 256, the low 16 bits of the products are the whole value
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pa, zero), wa),
+            _mm_mullo_epi16(_mm_unpacklo_epi8(pb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pa, zero), wa),
+            _mm_mullo_epi16(_mm_unpackhi_epi8(pb, zero), wb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), hi);
+    }
+    blendRowsScalar(a + i, b + i, weight, out + i, count - i);
+}
+
+VRD_TARGET_AVX2 void copyRowAvx2(const uint8_t* src, uint8_t* dst, int width) {
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_or_si256(p, alpha));
+    }
+    copyRowSse2(src + x * 4, dst + x * 4, width - x);
+}
+
+// Sixteen pixels per call, the arithmetic is 256 bits wide and the packing is done per 128-bit half
+VRD_TARGET_AVX2 inline void yuvToBgra16Avx2(__m256i y, __m256i u, __m256i v, uint8_t* dst) {
+    __m256i luma = _mm256_sub_epi16(y, _mm256_set1_epi16(16));
+    __m256i c = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(luma, _mm256_set1_epi16(74)),
+        _mm256_srai_epi16(luma, 1)), _mm256_set1_epi16(32));
+    __m256i du = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+    __m256i dv = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+    __m256i b = _mm256_srai_epi16(_mm256_adds_epi16(c, _mm256_mullo_epi16(du, _mm256_set1_epi16(129))), 6);
+    __m256i g = _mm256_srai_epi16(_mm256_sub_epi16(_mm256_sub_epi16(c,
+        _mm256_mullo_epi16(du, _mm256_set1_epi16(25))), _mm256_mullo_epi16(dv, _mm256_set1_epi16(52))), 6);
+    __m256i r = _mm256_srai_epi16(_mm256_adds_epi16(c, _mm256_mullo_epi16(dv, _mm256_set1_epi16(102))), 6);
+    storeBgra8(_mm256_castsi256_si128(b), _mm256_castsi256_si128(g), _mm256_castsi256_si128(r), dst);
+    storeBgra8(_mm256_extracti128_si256(b, 1), _mm256_extracti128_si256(g, 1),
+        _mm256_extracti128_si256(r, 1), dst + 32);
+}
+
+VRD_TARGET_AVX2 inline __m256i combine(__m128i lo, __m128i hi) {
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+VRD_TARGET_AVX2 void i420RowAvx2(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+        uint8_t* dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i u8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2));
+        __m128i v8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2));
+        __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+        __m256i u16 = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8));
+        __m256i v16 = _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8));
+        yuvToBgra16Avx2(y16, u16, v16, dst + x * 4);
+    }
+    i420RowSse2(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+}
+
+VRD_TARGET_AVX2 void nv12RowAvx2(const uint8_t* y, const uint8_t* uv, uint8_t* dst, int width) {
+    const __m128i low_byte = _mm_set1_epi16(0x00ff);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i pairs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + x));
+        __m128i u = _mm_and_si128(pairs, low_byte);
+        __m128i v = _mm_srli_epi16(pairs, 8);
+        __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x)));
+        __m256i u16 = combine(_mm_unpacklo_epi16(u, u), _mm_unpackhi_epi16(u, u));
+        __m256i v16 = combine(_mm_unpacklo_epi16(v, v), _mm_unpackhi_epi16(v, v));
+        yuvToBgra16Avx2(y16, u16, v16, dst + x * 4);
+    }
+    nv12RowSse2(y + x, uv + x, dst + x * 4, width - x);
+}
+
+VRD_TARGET_AVX2 void accumulateRowAvx2(const uint8_t* src, uint16_t* acc, int count) {
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+        __m256i* a = reinterpret_cast<__m256i*>(acc + i);
+        _mm256_storeu_si256(a, _mm256_add_epi16(_mm256_loadu_si256(a), _mm256_cvtepu8_epi16(s0)));
+        _mm256_storeu_si256(a + 1, _mm256_add_epi16(_mm256_loadu_si256(a + 1), _mm256_cvtepu8_epi16(s1)));
+    }
+    accumulateRowSse2(src + i, acc + i, count - i);
+}
+
+VRD_TARGET_AVX2 void blendRowsAvx2(const uint8_t* a, const uint8_t* b, int weight,
+        uint16_t* out, int count) {
+    const __m256i wa = _mm256_set1_epi16(static_cast<short>(256 - weight));
+    const __m256i wb = _mm256_set1_epi16(static_cast<short>(weight));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i pa = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i pb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i),
+            _mm256_add_epi16(_mm256_mullo_epi16(pa, wa), _mm256_mullo_epi16(pb, wb)));
+    }
+    blendRowsSse2(a + i, b + i, weight, out + i, count - i);
+}
+
+#endif  // VRD_IMAGE_X86
+
+struct RowKernels {
+    void (*copy_row)(const uint8_t*, uint8_t*, int);
+    void (*i420_row)(const uint8_t*, const uint8_t*, const uint8_t*, uint8_t*, int);
+    void (*nv12_row)(const uint8_t*, const uint8_t*, uint8_t*, int);
+    void (*accumulate_row)(const uint8_t*, uint16_t*, int);
+    void (*blend_rows)(const uint8_t*, const uint8_t*, int, uint16_t*, int);
+};
+
+const RowKernels& rowKernels() {
+    static const RowKernels kScalar = {
+        copyRowScalar, i420RowScalar, nv12RowScalar, accumulateRowScalar, blendRowsScalar };
+#if defined(VRD_IMAGE_X86)
+    static const RowKernels kSse2 = {
+        copyRowSse2, i420RowSse2, nv12RowSse2, accumulateRowSse2, blendRowsSse2 };
+    static const RowKernels kAvx2 = {
+        copyRowAvx2, i420RowAvx2, nv12RowAvx2, accumulateRowAvx2, blendRowsAvx2 };
+    switch (simdLevel()) {
+    case SimdLevel::kAvx2:
+        return kAvx2;
+    case SimdLevel::kSse2:
+        return kSse2;
+    default:
+        break;
+    }
+#endif
+    return kScalar;
+}
+
+// Averages the column sums of one destination row, columns holds the first source byte and pixel count per column
+template <typename Sum>
+void boxRow(const Sum* acc, const std::vector<int>& columns, int rows, uint8_t* out, int dst_width) {
+    int last_count = 0;
+    uint64_t recip = 0;
+    for (int dx = 0; dx < dst_width; dx++) {
+        const Sum* p = acc + columns[dx * 2];
+        int count = columns[dx * 2 + 1];
+        // Column widths only take two values, so the division happens a couple of times per row
+        if (count != last_count) {
+            uint64_t area = static_cast<uint64_t>(count) * rows;
+            recip = ((1ull << 32) + area / 2) / area;
+            last_count = count;
+        }
+        uint32_t sum[3] = { 0, 0, 0 };
+        for (int x = 0; x < count; x++) {
+            sum[0] += p[x * 4];
+            sum[1] += p[x * 4 + 1];
+            sum[2] += p[x * 4 + 2];
+        }
+        for (int c = 0; c < 3; c++) {
+            out[dx * 4 + c] = static_cast<uint8_t>((sum[c] * recip + (1ull << 31)) >> 32);
+        }
+        out[dx * 4 + 3] = 0xff;
+    }
+}
+
+void scaleBox(const uint8_t* src, int src_stride, int src_width, int src_height,
+        uint8_t* dst, int dst_stride, int dst_width, int dst_height) {
+    const auto& kernels = rowKernels();
+    const int row_bytes = src_width * 4;
+    const bool narrow_sums = (src_height + dst_height - 1) / dst_height <= kMaxU16Rows;
+    thread_local std::vector<uint16_t> acc16;
+    thread_local std::vector<uint32_t> acc32;
+    thread_local std::vector<int> columns;
+    if (narrow_sums) {
+        acc16.resize(row_bytes);
+    }
+    else {
+        acc32.resize(row_bytes);
+    }
+    columns.resize(static_cast<size_t>(dst_width) * 2);
+    for (int dx = 0; dx < dst_width; dx++) {
+        int x0 = static_cast<int>(static_cast<int64_t>(dx) * src_width / dst_width);
+        int x1 = std::max(x0 + 1, static_cast<int>(static_cast<int64_t>(dx + 1) * src_width / dst_width));
+        columns[dx * 2] = x0 * 4;
+        columns[dx * 2 + 1] = x1 - x0;
+    }
+
+    for (int dy = 0; dy < dst_height; dy++) {
+        int y0 = static_cast<int>(static_cast<int64_t>(dy) * src_height / dst_height);
+        int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(dy + 1) * src_height / dst_height));
+        uint8_t* out = dst + static_cast<size_t>(dy) * dst_stride;
+
+        // Vertical pass over whole source rows, the only part that touches every source byte
+        if (narrow_sums) {
+            std::fill(acc16.begin(), acc16.end(), 0);
+            for (int y = y0; y < y1; y++) {
+                kernels.accumulate_row(src + static_cast<size_t>(y) * src_stride, acc16.data(), row_bytes);
+            }
+            boxRow(acc16.data(), columns, y1 - y0, out, dst_width);
+        }
+        else {
+            std::fill(acc32.begin(), acc32.end(), 0);
+            for (int y = y0; y < y1; y++) {
+                const uint8_t* row = src + static_cast<size_t>(y) * src_stride;
+                for (int i = 0; i < row_bytes; i++) acc32[i] += row[i];
+            }
+            boxRow(acc32.data(), columns, y1 - y0, out, dst_width);
+        }
+    }
+}
+
+// Source position of the center of destination sample i in 16.16 fixed point, clamped to the first sample
+inline int64_t sourcePosition(int i, int src_size, int dst_size) {
+    int64_t pos = ((2 * static_cast<int64_t>(i) + 1) * src_size << 16) / (2 * dst_size) - (1 << 15);
+    return std::max<int64_t>(pos, 0);
+}
+
+void scaleBilinear(const uint8_t* src, int src_stride, int src_width, int src_height,
+        uint8_t* dst, int dst_stride, int dst_width, int dst_height) {
+    const auto& kernels = rowKernels();
+    const int row_bytes = src_width * 4;
+    thread_local std::vector<uint16_t> blended;
+    thread_local std::vector<int> columns;
+    blended.resize(row_bytes);
+    // x0, x1 and weight per destination column
+    columns.resize(static_cast<size_t>(dst_width) * 3);
+    for (int dx = 0; dx < dst_width; dx++) {
+        int64_t pos = sourcePosition(dx, src_width, dst_width);
+        int x0 = std::min(static_cast<int>(pos >> 16), src_width - 1);
+        columns[dx * 3] = x0 * 4;
+        columns[dx * 3 + 1] = std::min(x0 + 1, src_width - 1) * 4;
+        columns[dx * 3 + 2] = static_cast<int>((pos & 0xffff) >> 8);
+    }
+
+    for (int dy = 0; dy < dst_height; dy++) {
+        int64_t pos = sourcePosition(dy, src_height, dst_height);
+        int y0 = std::min(static_cast<int>(pos >> 16), src_height - 1);
+        int y1 = std::min(y0 + 1, src_height - 1);
+        int wy = static_cast<int>((pos & 0xffff) >> 8);
+        kernels.blend_rows(src + static_cast<size_t>(y0) * src_stride,
+            src + static_cast<size_t>(y1) * src_stride, wy, blended.data(), row_bytes);
+
+        uint8_t* out = dst + static_cast<size_t>(dy) * dst_stride;
+        for (int dx = 0; dx < dst_width; dx++) {
+            const uint16_t* p0 = blended.data() + columns[dx * 3];
+            const uint16_t* p1 = blended.data() + columns[dx * 3 + 1];
+            uint32_t wx = static_cast<uint32_t>(columns[dx * 3 + 2]);
+            for (int c = 0; c < 3; c++) {
+                out[dx * 4 + c] = static_cast<uint8_t>((p0[c] * (256 - wx) + p1[c] * wx + (1 << 15)) >> 16);
+            }
+            out[dx * 4 + 3] = 0xff;
+        }
+    }
+}
+
+}  // namespace
+
+SimdLevel detectedSimdLevel() {
+    static const SimdLevel level = detectCpu();
+    return level;
+}
+
+SimdLevel simdLevel() {
+    int level = g_simd_level.load(std::memory_order_relaxed);
+    if (level < 0) {
+        level = static_cast<int>(detectedSimdLevel());
+        g_simd_level.store(level, std::memory_order_relaxed);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+void setSimdLevel(SimdLevel level) {
+    auto capped = std::min(static_cast<int>(level), static_cast<int>(detectedSimdLevel()));
+    g_simd_level.store(capped, std::memory_order_relaxed);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::kAvx2:
+        return "avx2";
+    case SimdLevel::kSse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+struct PixelBuffer::Block {
+    PixelBufferPool* pool = nullptr;
+    std::unique_ptr<uint8_t[]> storage;
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+};
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept {
+    if (this != &other) {
+        reset();
+        block_ = other.block_;
+        other.block_ = nullptr;
+    }
+    return *this;
+}
+
+void PixelBuffer::reset() {
+    if (!block_) return;
+    block_->pool->recycle(block_);
+    block_ = nullptr;
+}
+
+uint8_t* PixelBuffer::data() const {
+    return block_ ? block_->data : nullptr;
+}
+
+int PixelBuffer::width() const {
+    return block_ ? block_->width : 0;
+}
+
+int PixelBuffer::height() const {
+    return block_ ? block_->height : 0;
+}
+
+int PixelBuffer::stride() const {
+    return block_ ? block_->stride : 0;
+}
+
+PixelBuffer PixelBuffer::adopt(void* raw) {
+    return PixelBuffer(static_cast<Block*>(raw));
+}
+
+PixelBufferPool& PixelBufferPool::instance() {
+    static PixelBufferPool pool;
+    return pool;
+}
+
+PixelBufferPool::PixelBufferPool(size_t max_pooled_bytes) : max_pooled_bytes_(max_pooled_bytes) {}
+
+PixelBufferPool::~PixelBufferPool() {
+    trim();
+}
+
+PixelBuffer PixelBufferPool::acquire(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    int stride = (width * 4 + kRowAlign - 1) / kRowAlign * kRowAlign;
+    size_t bytes = static_cast<size_t>(stride) * height;
+
+    PixelBuffer::Block* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto best = free_.end();
+        for (auto it = free_.begin(); it != free_.end(); ++it) {
+            size_t capacity = (*it)->capacity;
+            if (capacity >= bytes && capacity / 2 <= bytes
+                && (best == free_.end() || capacity < (*best)->capacity)) {
+                best = it;
+            }
+        }
+        if (best != free_.end()) {
+            block = *best;
+            *best = free_.back();
+            free_.pop_back();
+            pooled_bytes_ -= block->capacity;
+            ++hits_;
+        }
+        else {
+            ++misses_;
+        }
+    }
+    if (!block) {
+        block = new PixelBuffer::Block();
+        block->pool = this;
+        block->capacity = bytes;
+        block->storage.reset(new uint8_t[bytes + kRowAlign - 1]);
+        auto addr = reinterpret_cast<uintptr_t>(block->storage.get());
+        block->data = reinterpret_cast<uint8_t*>((addr + kRowAlign - 1) & ~static_cast<uintptr_t>(kRowAlign - 1));
+    }
+    block->width = width;
+    block->height = height;
+    block->stride = stride;
+    return PixelBuffer(block);
+}
+
+void PixelBufferPool::recycle(PixelBuffer::Block* block) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pooled_bytes_ + block->capacity <= max_pooled_bytes_) {
+            free_.push_back(block);
+            pooled_bytes_ += block->capacity;
+            return;
+        }
+    }
+    delete block;
+}
+
+void PixelBufferPool::trim() {
+    std::vector<PixelBuffer::Block*> blocks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocks.swap(free_);
+        pooled_bytes_ = 0;
+    }
+    for (auto block : blocks) {
+        delete block;
+    }
+}
+
+PixelBufferPool::Stats PixelBufferPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s;
+    s.hits = hits_;
+    s.misses = misses_;
+    s.pooled_bytes = pooled_bytes_;
+    return s;
+}
+
+void copyRgb32(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride,
+        int width, int height) {
+    const auto& kernels = rowKernels();
+    for (int y = 0; y < height; y++) {
+        kernels.copy_row(src + static_cast<size_t>(y) * src_stride,
+            dst + static_cast<size_t>(y) * dst_stride, width);
+    }
+}
+
+void i420ToRgb32(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+        const uint8_t* v, int v_stride, uint8_t* dst, int dst_stride, int width, int height) {
+    const auto& kernels = rowKernels();
+    for (int row = 0; row < height; row++) {
+        kernels.i420_row(y + static_cast<size_t>(row) * y_stride,
+            u + static_cast<size_t>(row / 2) * u_stride, v + static_cast<size_t>(row / 2) * v_stride,
+            dst + static_cast<size_t>(row) * dst_stride, width);
+    }
+}
+
+void nv12ToRgb32(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+        uint8_t* dst, int dst_stride, int width, int height) {
+    const auto& kernels = rowKernels();
+    for (int row = 0; row < height; row++) {
+        kernels.nv12_row(y + static_cast<size_t>(row) * y_stride,
+            uv + static_cast<size_t>(row / 2) * uv_stride,
+            dst + static_cast<size_t>(row) * dst_stride, width);
+    }
+}
+
+void scaleRgb32(const uint8_t* src, int src_stride, int src_width, int src_height,
+        uint8_t* dst, int dst_stride, int dst_width, int dst_height, ScaleFilter filter) {
+    if (src_width <= 0 || src_height <= 0 || dst_width <= 0 || dst_height <= 0) return;
+    if (src_width == dst_width && src_height == dst_height) {
+        copyRgb32(src, src_stride, dst, dst_stride, src_width, src_height);
+        return;
+    }
+    if (filter == ScaleFilter::kBox && dst_width <= src_width && dst_height <= src_height) {
+        scaleBox(src, src_stride, src_width, src_height, dst, dst_stride, dst_width, dst_height);
+    }
+    else {
+        scaleBilinear(src, src_stride, src_width, src_height, dst, dst_stride, dst_width, dst_height);
+    }
+}
+
+void fitSize(int width, int height, int max_width, int max_height, int& out_width, int& out_height) {
+    out_width = width;
+    out_height = height;
+    if (width <= 0 || height <= 0 || max_width <= 0 || max_height <= 0) return;
+    if (width <= max_width && height <= max_height) return;
+    // Compare max_width / width with max_height / height without dividing
+    if (static_cast<int64_t>(max_width) * height <= static_cast<int64_t>(max_height) * width) {
+        out_width = max_width;
+        out_height = static_cast<int>(std::max<int64_t>(1,
+            (static_cast<int64_t>(height) * max_width + width / 2) / width));
+    }
+    else {
+        out_height = max_height;
+        out_width = static_cast<int>(std::max<int64_t>(1,
+            (static_cast<int64_t>(width) * max_height + height / 2) / height));
+    }
+}
+
+}  // namespace image
+}  // namespace vrd
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace vrd {
+namespace image {
+
+enum class SimdLevel {
+    kScalar = 0,
+    kSse2,
+    kAvx2,
+};
+
+// Best level supported by the CPU
+SimdLevel detectedSimdLevel();
+// Level the kernels dispatch to, defaults to detectedSimdLevel()
+SimdLevel simdLevel();
+// Caps dispatch at level, for benchmarks and for comparing against the scalar reference
+void setSimdLevel(SimdLevel level);
+const char* simdLevelName(SimdLevel level);
+
+/**
+* 32-bit pixel buffer with 32-byte aligned rows, recycled through a PixelBufferPool
+* Move-only, the memory goes back to the pool when the last owner lets go of it
+*/
+class PixelBuffer {
+public:
+    PixelBuffer() = default;
+    PixelBuffer(PixelBuffer&& other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+    PixelBuffer(const PixelBuffer&) = delete;
+    PixelBuffer& operator=(const PixelBuffer&) = delete;
+    ~PixelBuffer() { reset(); }
+
+    void reset();
+    bool empty() const { return block_ == nullptr; }
+    uint8_t* data() const;
+    int width() const;
+    int height() const;
+    // Bytes per row, a multiple of 32
+    int stride() const;
+
+    // Hands the buffer to a raw pointer, e.g. a QImage cleanup argument, adopt() takes it back
+    void* detach() {
+        auto raw = block_;
+        block_ = nullptr;
+        return raw;
+    }
+    static PixelBuffer adopt(void* raw);
+
+private:
+    friend class PixelBufferPool;
+    struct Block;
+
+    explicit PixelBuffer(Block* block) : block_(block) {}
+
+    Block* block_ = nullptr;
+};
+
+/**
+* Free list of pixel buffers, any thread
+* A request is served by the smallest free buffer that fits and wastes at most half of it,
+* buffers released past the byte budget are freed instead of kept
+*/
+class PixelBufferPool {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        size_t pooled_bytes = 0;
+    };
+
+    static PixelBufferPool& instance();
+
+    explicit PixelBufferPool(size_t max_pooled_bytes = 32 * 1024 * 1024);
+    ~PixelBufferPool();
+
+    PixelBufferPool(const PixelBufferPool&) = delete;
+    PixelBufferPool& operator=(const PixelBufferPool&) = delete;
+
+    PixelBuffer acquire(int width, int height);
+    void trim();
+    Stats stats() const;
+
+private:
+    friend class PixelBuffer;
+    void recycle(PixelBuffer::Block* block);
+
+    const size_t max_pooled_bytes_;
+    mutable std::mutex mutex_;
+    std::vector<PixelBuffer::Block*> free_;
+    size_t pooled_bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+// Strides are in bytes and may be larger than a row, e.g. padded SDK planes.
+// RGB32 is the QImage::Format_RGB32 layout, B G R A in memory with the alpha byte forced to 0xff
+
+// Copies 32-bit pixels row by row and sets every alpha byte to 0xff
+void copyRgb32(const uint8_t* src, int src_stride, uint8_t* dst, int dst_stride,
+    int width, int height);
+
+// BT.601 limited range, chroma planes are half width and half height rounded up
+void i420ToRgb32(const uint8_t* y, int y_stride, const uint8_t* u, int u_stride,
+    const uint8_t* v, int v_stride, uint8_t* dst, int dst_stride, int width, int height);
+void nv12ToRgb32(const uint8_t* y, int y_stride, const uint8_t* uv, int uv_stride,
+    uint8_t* dst, int dst_stride, int width, int height);
+
+enum class ScaleFilter {
+    // Area average, for large reductions such as screen-sized frames to thumbnails
+    kBox,
+    kBilinear,
+};
+
+// Resamples 32-bit pixels, kBox falls back to kBilinear when either dimension grows
+void scaleRgb32(const uint8_t* src, int src_stride, int src_width, int src_height,
+    uint8_t* dst, int dst_stride, int dst_width, int dst_height, ScaleFilter filter);
+
+// Largest size with the aspect ratio of width x height that fits max_width x max_height, never larger than the source
+void fitSize(int width, int height, int max_width, int max_height, int& out_width, int& out_height);
+
+}  // namespace image
+}  // namespace vrd
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace vrd {
+
+/**
+* Lock-free stack of free slot indexes in [0, count)
+* The head carries an ABA tag in its high 32 bits, so any thread may push or pop
+*/
+class IndexFreeList {
+public:
+    static constexpr uint32_t kEmpty = 0xffffffffu;
+
+    explicit IndexFreeList(size_t count)
+        : next_(new std::atomic<uint32_t>[count]),
+          head_(count ? 0 : kEmpty) {
+        for (size_t i = 0; i < count; i++) {
+            next_[i].store(i + 1 < count ? static_cast<uint32_t>(i + 1) : kEmpty,
+                std::memory_order_relaxed);
+        }
+    }
+
+    IndexFreeList(const IndexFreeList&) = delete;
+    IndexFreeList& operator=(const IndexFreeList&) = delete;
+
+    // Returns kEmpty when every index is taken
+    uint32_t pop() {
+        auto head = head_.load(std::memory_order_acquire);
+        for (;;) {
+            auto index = static_cast<uint32_t>(head);
+            if (index == kEmpty) return kEmpty;
+            auto next = next_[index].load(std::memory_order_relaxed);
+            auto tagged = ((head >> 32) + 1) << 32 | next;
+            if (head_.compare_exchange_weak(head, tagged,
+                std::memory_order_acquire, std::memory_order_acquire)) {
+                return index;
+            }
+        }
+    }
+
+    void push(uint32_t index) {
+        auto head = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            next_[index].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            auto tagged = ((head >> 32) + 1) << 32 | index;
+            if (head_.compare_exchange_weak(head, tagged,
+                std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;
+    std::atomic<uint64_t> head_;
+};
+
+}  // namespace vrd
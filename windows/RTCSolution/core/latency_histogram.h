@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace vrd {
+
+inline uint64_t steadyNowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+* Lock-free log-linear latency histogram in microseconds
+* Every power of two is split into 16 linear buckets, so a reported percentile is within ~6% of the true value.
+* Any thread may record, readers get an approximate but consistent-enough view without stopping writers
+*/
+class LatencyHistogram {
+public:
+    struct Summary {
+        uint64_t count = 0;
+        uint64_t p50_us = 0;
+        uint64_t p99_us = 0;
+        uint64_t max_us = 0;
+    };
+
+    void record(uint64_t us) {
+        if (us > kMaxValue) us = kMaxValue;
+        buckets_[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        auto max = max_.load(std::memory_order_relaxed);
+        while (us > max && !max_.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    Summary summary() const {
+        Summary s;
+        s.count = count_.load(std::memory_order_relaxed);
+        s.max_us = max_.load(std::memory_order_relaxed);
+        if (s.count == 0) return s;
+        s.p50_us = percentile(s.count, 50);
+        s.p99_us = percentile(s.count, 99);
+        return s;
+    }
+
+    void reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+    static constexpr uint64_t kMaxValue = 0xffffffffull;
+    static constexpr size_t kBucketCount = kSubBuckets + (32 - kSubBucketBits) * kSubBuckets;
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < kSubBuckets) return static_cast<size_t>(value);
+        int exponent = 0;
+        for (auto v = value; v >>= 1;) ++exponent;
+        auto shift = exponent - kSubBucketBits;
+        auto sub = (value >> shift) & (kSubBuckets - 1);
+        return static_cast<size_t>(kSubBuckets + shift * kSubBuckets + sub);
+    }
+
+    // Largest value that maps to the bucket
+    static uint64_t upperBoundOf(size_t bucket) {
+        if (bucket < kSubBuckets) return bucket;
+        auto shift = (bucket - kSubBuckets) / kSubBuckets;
+        auto sub = (bucket - kSubBuckets) % kSubBuckets;
+        return ((kSubBuckets + sub + 1) << shift) - 1;
+    }
+
+    uint64_t percentile(uint64_t count, uint64_t percent) const {
+        auto rank = (count * percent + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                auto bound = upperBoundOf(i);
+                auto max = max_.load(std::memory_order_relaxed);
+                return bound < max ? bound : max;
+            }
+        }
+        return max_.load(std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets_[kBucketCount] = {};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> max_{ 0 };
+};
+
+}  // namespace vrd
@@ -0,0 +1,315 @@
+#include "mock_rtc_backend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace vrd {
+
+namespace {
+
+// Worker threads wake at this granularity and fire whatever source is due
+constexpr int kTickMs = 5;
+
+uint32_t nextRandom(uint32_t& state) {
+    // xorshift32, cheap enough to call per volume entry
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+struct Deadline {
+    explicit Deadline(int interval_ms) : interval(interval_ms) {}
+
+    bool due(std::chrono::steady_clock::time_point now) {
+        if (interval <= 0 || now < next) return false;
+        next = now + std::chrono::milliseconds(interval);
+        return true;
+    }
+
+    int interval;
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+};
+
+}  // namespace
+
+MockRtcBackend::MockRtcBackend(bytertc::IRTCVideoEventHandler* video_handler,
+        bytertc::IRTCRoomEventHandler* room_handler, std::string room_id)
+    : video_handler_(video_handler), room_handler_(room_handler), room_id_(std::move(room_id)) {}
+
+MockRtcBackend::~MockRtcBackend() {
+    stop();
+}
+
+void MockRtcBackend::start(const MockLoadProfile& profile) {
+    if (running_.load()) return;
+    profile_ = profile;
+    profile_.max_users = std::max(profile_.max_users, 1);
+    profile_.worker_threads = std::max(profile_.worker_threads, 1);
+
+    if (user_ids_.size() != static_cast<size_t>(profile_.max_users)) {
+        user_ids_.clear();
+        char id[32];
+        for (int i = 0; i < profile_.max_users; i++) {
+            snprintf(id, sizeof(id), "mock_user_%03d", i);
+            user_ids_.emplace_back(id);
+        }
+        present_.reset(new std::atomic<bool>[profile_.max_users]);
+    }
+    for (int i = 0; i < profile_.max_users; i++) {
+        present_[i].store(false);
+    }
+    users_ = 0;
+
+    room_handler_->onRoomStateChanged(room_id_.c_str(), local_user_id_.c_str(), 0, "{}");
+    video_handler_->onFirstLocalAudioFrame(bytertc::kStreamIndexMain);
+    bytertc::VideoFrameInfo frame;
+    frame.width = 1280;
+    frame.height = 720;
+    video_handler_->onFirstLocalVideoFrameCaptured(bytertc::kStreamIndexMain, frame);
+    callbacks_ += 3;
+
+    running_ = true;
+    joinUsers(profile_.remote_users);
+    for (int i = 0; i < profile_.worker_threads; i++) {
+        workers_.emplace_back(&MockRtcBackend::workerLoop, this, i);
+    }
+}
+
+void MockRtcBackend::stop() {
+    if (!running_.exchange(false)) return;
+    wait_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(membership_mutex_);
+        for (int i = 0; i < profile_.max_users; i++) {
+            if (present_[i].load()) leaveSlot(i);
+        }
+    }
+    bytertc::RtcRoomStats stats;
+    room_handler_->onLeaveRoom(stats);
+    ++callbacks_;
+}
+
+bool MockRtcBackend::running() const {
+    return running_.load();
+}
+
+int MockRtcBackend::joinUsers(int count) {
+    std::lock_guard<std::mutex> lock(membership_mutex_);
+    if (!running_.load()) return 0;
+    int joined = 0;
+    for (int i = 0; i < profile_.max_users && joined < count; i++) {
+        if (!present_[i].load()) {
+            joinSlot(i);
+            ++joined;
+        }
+    }
+    return joined;
+}
+
+int MockRtcBackend::leaveUsers(int count) {
+    std::lock_guard<std::mutex> lock(membership_mutex_);
+    if (!running_.load()) return 0;
+    int left = 0;
+    for (int i = profile_.max_users - 1; i >= 0 && left < count; i--) {
+        if (present_[i].load()) {
+            leaveSlot(i);
+            ++left;
+        }
+    }
+    return left;
+}
+
+void MockRtcBackend::runScript(const std::vector<MockLoadStep>& steps) {
+    for (const auto& step : steps) {
+        if (!running_.load()) return;
+        if (step.join > 0) joinUsers(step.join);
+        if (step.leave > 0) leaveUsers(step.leave);
+        if (step.hold_ms > 0) {
+            std::unique_lock<std::mutex> lock(wait_mutex_);
+            wait_cv_.wait_for(lock, std::chrono::milliseconds(step.hold_ms),
+                [this] { return !running_.load(); });
+        }
+    }
+}
+
+MockRtcBackend::Stats MockRtcBackend::stats() const {
+    Stats s;
+    s.callbacks = callbacks_.load();
+    s.joins = joins_.load();
+    s.leaves = leaves_.load();
+    s.users = users_.load();
+    return s;
+}
+
+const std::string& MockRtcBackend::userId(int slot) const {
+    return user_ids_[slot];
+}
+
+void MockRtcBackend::joinSlot(int slot) {
+    const char* uid = user_ids_[slot].c_str();
+    bytertc::UserInfo info;
+    info.uid = uid;
+    info.extra_info = "";
+    room_handler_->onUserJoined(info, 0);
+    video_handler_->onUserStartAudioCapture(room_id_.c_str(), uid);
+    video_handler_->onUserStartVideoCapture(room_id_.c_str(), uid);
+    room_handler_->onUserPublishStream(uid, bytertc::kMediaStreamTypeBoth);
+
+    bytertc::RemoteStreamKey key;
+    key.room_id = room_id_.c_str();
+    key.user_id = uid;
+    key.stream_index = bytertc::kStreamIndexMain;
+    bytertc::VideoFrameInfo frame;
+    frame.width = 640;
+    frame.height = 360;
+    video_handler_->onFirstRemoteVideoFrameDecoded(key, frame);
+
+    present_[slot].store(true, std::memory_order_release);
+    callbacks_ += 5;
+    ++joins_;
+    ++users_;
+}
+
+void MockRtcBackend::leaveSlot(int slot) {
+    present_[slot].store(false, std::memory_order_release);
+    const char* uid = user_ids_[slot].c_str();
+    video_handler_->onUserStopVideoCapture(room_id_.c_str(), uid);
+    video_handler_->onUserStopAudioCapture(room_id_.c_str(), uid);
+    room_handler_->onUserUnpublishStream(uid, bytertc::kMediaStreamTypeBoth,
+        bytertc::kStreamRemoveReasonUnpublish);
+    room_handler_->onUserLeave(uid, bytertc::kUserOfflineReasonQuit);
+    callbacks_ += 4;
+    ++leaves_;
+    --users_;
+}
+
+void MockRtcBackend::workerLoop(int index) {
+    uint32_t rng = profile_.seed * 2654435761u + static_cast<uint32_t>(index) + 1;
+    const bool primary = index == 0;
+    const bool last = index == profile_.worker_threads - 1;
+
+    Deadline remote_stats(profile_.stats_interval_ms);
+    Deadline room_stats(primary ? profile_.stats_interval_ms : 0);
+    Deadline volume(primary ? profile_.volume_interval_ms : 0);
+    Deadline log(primary ? profile_.log_interval_ms : 0);
+    Deadline churn_deadline(last ? profile_.churn_interval_ms : 0);
+    Deadline device(last ? profile_.device_event_interval_ms : 0);
+
+    // Preallocated so the volume source does not allocate per report
+    std::vector<bytertc::RemoteAudioPropertiesInfo> infos(profile_.max_users);
+
+    while (running_.load(std::memory_order_relaxed)) {
+        auto now = std::chrono::steady_clock::now();
+        if (remote_stats.due(now)) emitRemoteStats(index);
+        if (room_stats.due(now)) emitRoomStats(rng);
+        if (volume.due(now)) emitVolume(infos, rng);
+        if (log.due(now)) {
+            video_handler_->onLogReport("mock", "{\"event\":\"mock_log\"}");
+            ++callbacks_;
+        }
+        if (churn_deadline.due(now)) churn(rng);
+        if (device.due(now)) emitDeviceEvent(rng);
+
+        std::unique_lock<std::mutex> lock(wait_mutex_);
+        wait_cv_.wait_for(lock, std::chrono::milliseconds(kTickMs),
+            [this] { return !running_.load(); });
+    }
+}
+
+void MockRtcBackend::emitRemoteStats(int worker) {
+    bytertc::RemoteStreamStats stats;
+    for (int i = worker; i < profile_.max_users; i += profile_.worker_threads) {
+        if (!present_[i].load(std::memory_order_acquire)) continue;
+        stats.uid = user_ids_[i].c_str();
+        stats.is_screen = false;
+        stats.audio_stats.received_kbitrate = 32 + i % 16;
+        stats.audio_stats.rtt = 40 + i % 30;
+        stats.video_stats.width = 640;
+        stats.video_stats.height = 360;
+        stats.video_stats.received_kbitrate = 500 + i % 200;
+        stats.video_stats.rtt = 40 + i % 30;
+        stats.video_stats.renderer_output_frame_rate = 15;
+        room_handler_->onRemoteStreamStats(stats);
+        ++callbacks_;
+    }
+}
+
+void MockRtcBackend::emitVolume(std::vector<bytertc::RemoteAudioPropertiesInfo>& infos, uint32_t& rng) {
+    int count = 0;
+    int total = 0;
+    for (int i = 0; i < profile_.max_users; i++) {
+        if (!present_[i].load(std::memory_order_acquire)) continue;
+        auto& info = infos[count++];
+        info.stream_key.room_id = room_id_.c_str();
+        info.stream_key.user_id = user_ids_[i].c_str();
+        info.stream_key.stream_index = bytertc::kStreamIndexMain;
+        // Mostly silence with the occasional speaker, like a real meeting
+        info.audio_properties_info.linear_volume = nextRandom(rng) % 8 == 0 ? nextRandom(rng) % 255 : 0;
+        total = std::max(total, info.audio_properties_info.linear_volume);
+    }
+    video_handler_->onRemoteAudioPropertiesReport(infos.data(), count, total);
+
+    bytertc::LocalAudioPropertiesInfo local;
+    local.stream_index = bytertc::kStreamIndexMain;
+    local.audio_properties_info.linear_volume = nextRandom(rng) % 64;
+    video_handler_->onLocalAudioPropertiesReport(&local, 1);
+    callbacks_ += 2;
+}
+
+void MockRtcBackend::emitRoomStats(uint32_t& rng) {
+    bytertc::RtcRoomStats room;
+    room.users = users_.load() + 1;
+    room_handler_->onRoomStats(room);
+
+    bytertc::LocalStreamStats local;
+    local.is_screen = false;
+    local.video_stats.sent_kbitrate = 800 + nextRandom(rng) % 200;
+    local.video_stats.sent_frame_rate = 15;
+    local.video_stats.encoded_frame_width = 1280;
+    local.video_stats.encoded_frame_height = 720;
+    room_handler_->onLocalStreamStats(local);
+
+    bytertc::SysStats sys;
+    sys.cpu_cores = std::thread::hardware_concurrency();
+    sys.cpu_app_usage = (nextRandom(rng) % 100) / 100.0;
+    sys.cpu_total_usage = sys.cpu_app_usage;
+    video_handler_->onSysStats(sys);
+    callbacks_ += 3;
+}
+
+void MockRtcBackend::emitDeviceEvent(uint32_t& rng) {
+    // Alternate removed and re-added so the device lists return to their original state
+    device_removed_ = !device_removed_;
+    auto state = device_removed_ ? bytertc::kMediaDeviceStateRemoved : bytertc::kMediaDeviceStateAdded;
+    if (nextRandom(rng) % 2) {
+        video_handler_->onAudioDeviceStateChanged("mock_microphone",
+            bytertc::kRTCAudioDeviceTypeCaptureDevice, state, bytertc::kMediaDeviceErrorOK);
+    }
+    else {
+        video_handler_->onVideoDeviceStateChanged("mock_camera",
+            bytertc::kRTCVideoDeviceTypeCaptureDevice, state, bytertc::kMediaDeviceErrorOK);
+    }
+    ++callbacks_;
+}
+
+void MockRtcBackend::churn(uint32_t& rng) {
+    std::lock_guard<std::mutex> lock(membership_mutex_);
+    // Stay within the initial population so churn does not grow the room
+    int range = std::min(std::max(profile_.remote_users, 1), profile_.max_users);
+    int slot = static_cast<int>(nextRandom(rng) % range);
+    if (present_[slot].load()) {
+        leaveSlot(slot);
+    }
+    else {
+        joinSlot(slot);
+    }
+}
+
+}  // namespace vrd
@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bytertc_video_event_handler.h"
+#include "bytertc_room_event_handler.h"
+
+namespace vrd {
+
+/**
+* Rates of the synthetic callback load, an interval of 0 disables that source
+*/
+struct MockLoadProfile {
+    // Remote users joined by start(), more can be added with joinUsers() up to max_users
+    int remote_users = 8;
+    int max_users = 128;
+    // Number of SDK-like callback threads, remote stream stats are spread across them
+    int worker_threads = 2;
+    // onRemoteStreamStats per user, onLocalStreamStats, onRoomStats and onSysStats
+    int stats_interval_ms = 2000;
+    // onRemoteAudioPropertiesReport and onLocalAudioPropertiesReport
+    int volume_interval_ms = 300;
+    // One random user leaves or a missing one rejoins
+    int churn_interval_ms = 0;
+    // A random audio or video device is removed or re-added
+    int device_event_interval_ms = 0;
+    // onLogReport
+    int log_interval_ms = 0;
+    uint32_t seed = 1;
+};
+
+// One step of a scripted run: join and leave users, then let the periodic load run for hold_ms
+struct MockLoadStep {
+    int join = 0;
+    int leave = 0;
+    int hold_ms = 0;
+};
+
+/**
+* In-process stand-in for the ByteRTC callback side
+* Drives IRTCVideoEventHandler / IRTCRoomEventHandler exactly as the SDK does, from its own worker threads,
+* so RtcEngineWrap and everything behind it can be exercised and measured without the SDK or a network.
+* Engine calls made by the UI are not intercepted, the generator decides who is in the room
+*/
+class MockRtcBackend {
+public:
+    struct Stats {
+        uint64_t callbacks = 0;
+        uint64_t joins = 0;
+        uint64_t leaves = 0;
+        int users = 0;
+    };
+
+    MockRtcBackend(bytertc::IRTCVideoEventHandler* video_handler,
+        bytertc::IRTCRoomEventHandler* room_handler, std::string room_id = "mock_room");
+    ~MockRtcBackend();
+
+    MockRtcBackend(const MockRtcBackend&) = delete;
+    MockRtcBackend& operator=(const MockRtcBackend&) = delete;
+
+    // Reports the local join, joins profile.remote_users users and starts the worker threads
+    void start(const MockLoadProfile& profile);
+    // Stops the workers, then reports every remaining user leaving and the local leave
+    void stop();
+    bool running() const;
+
+    // Any thread while running, the callbacks are issued on the calling thread like an SDK signalling thread
+    int joinUsers(int count);
+    int leaveUsers(int count);
+    // Blocking, runs the steps in order on the calling thread
+    void runScript(const std::vector<MockLoadStep>& steps);
+
+    Stats stats() const;
+    const std::string& userId(int slot) const;
+
+private:
+    void workerLoop(int index);
+    void joinSlot(int slot);
+    void leaveSlot(int slot);
+    void emitRemoteStats(int worker);
+    void emitVolume(std::vector<bytertc::RemoteAudioPropertiesInfo>& infos, uint32_t& rng);
+    void emitRoomStats(uint32_t& rng);
+    void emitDeviceEvent(uint32_t& rng);
+    void churn(uint32_t& rng);
+
+    bytertc::IRTCVideoEventHandler* video_handler_;
+    bytertc::IRTCRoomEventHandler* room_handler_;
+    const std::string room_id_;
+    const std::string local_user_id_ = "mock_local";
+    MockLoadProfile profile_;
+
+    std::vector<std::string> user_ids_;
+    std::unique_ptr<std::atomic<bool>[]> present_;
+    // Serializes join and leave so a slot's callbacks are never interleaved
+    std::mutex membership_mutex_;
+
+    std::vector<std::thread> workers_;
+    std::atomic<bool> running_{ false };
+    std::mutex wait_mutex_;
+    std::condition_variable wait_cv_;
+
+    std::atomic<uint64_t> callbacks_{ 0 };
+    std::atomic<uint64_t> joins_{ 0 };
+    std::atomic<uint64_t> leaves_{ 0 };
+    std::atomic<int> users_{ 0 };
+    // Only touched by the last worker thread
+    bool device_removed_ = false;
+};
+
+}  // namespace vrd
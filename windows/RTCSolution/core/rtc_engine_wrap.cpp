@@ -1,10 +1,18 @@
 #include "rtc_engine_wrap.h"
+
+#include <QDebug>
+#include <QTimer>
+#include <array>
+#include <cstring>
+
+#include "core/image_kernels.h"
+
 #define API_CALL_ERROR 999
 
 #define CHECK_POINTER(X, Y) \
   if (!X) return Y
 
-Q_DECLARE_METATYPE(std::vector<AudioVolumeInfoWrap>)
+Q_DECLARE_METATYPE(AudioVolumeSnapshot)
 
 RtcEngineWrap& RtcEngineWrap::instance() {
 	static RtcEngineWrap engine_wrap_;
@@ -24,7 +32,11 @@ RtcEngineWrap::RtcEngineWrap()
       audio_device_manager_(nullptr, [=](bytertc::IAudioDeviceManager*) {
         if (audio_device_manager_) {
         }
-      }) {}
+      }),
+      event_bus_(this,
+          [this](vrd::RtcEvent& event) { dispatch(event); },
+          &vrd::rtcEventCoalesceKey, vrd::kRtcEventTypeCount,
+          [this](vrd::RtcEvent& event) { discard(event); }) {}
 
 int RtcEngineWrap::startPlaybackDeviceTest(const std::string& str) {
   CHECK_POINTER(audio_device_manager_, -API_CALL_ERROR);
@@ -52,6 +64,8 @@ int RtcEngineWrap::setEnv(bytertc::Env env) {
 
 int RtcEngineWrap::setMainRoomId(const std::string& roomId) {
     instance().room_id_ = roomId;
+    instance().main_room_ = vrd::IdTable::instance().intern(roomId);
+    instance().callback_recorder_.setMainRoom(instance().main_room_);
     return 0;
 }
 
@@ -62,6 +76,13 @@ int RtcEngineWrap::SetDeviceId(const std::string& device_id) {
 
 void RtcEngineWrap::createEngine(const std::string& app_id) {
     video_engine_.reset(bytertc::createRTCVideo(app_id.c_str(), this, nullptr));
+
+    if (!latency_dump_timer_) {
+        latency_dump_timer_ = new QTimer(this);
+        QObject::connect(latency_dump_timer_, &QTimer::timeout,
+            this, &RtcEngineWrap::dumpEventLatency);
+    }
+    latency_dump_timer_->start(kLatencyDumpInterval);
 }
 
 std::string RtcEngineWrap::getSDKVersion() { 
@@ -69,18 +90,30 @@ std::string RtcEngineWrap::getSDKVersion() {
 }
 
 void RtcEngineWrap::destroyEngine() {
+    device_registry_.stop();
     video_engine_.reset();
+    if (latency_dump_timer_) {
+        latency_dump_timer_->stop();
+        dumpEventLatency();
+    }
 }
 
 int RtcEngineWrap::initDevices() {
+    for (auto& entry : rooms_) {
+        entry.second.channel->deleteLater();
+    }
     rooms_.clear();
     CHECK_POINTER(video_engine_, -API_CALL_ERROR);
     audio_device_manager_.reset(video_engine_->getAudioDeviceManager());
     video_device_manager_.reset(video_engine_->getVideoDeviceManager());
+    device_registry_.start(audio_device_manager_.get(), video_device_manager_.get(),
+        [this](vrd::DeviceKind kind) {
+            ForwardEvent::PostEvent(this, [this, kind] { emit sigOnDeviceListChanged(kind); });
+        });
 
     video_engine_->startVideoCapture();
     video_engine_->startAudioCapture();
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
+    if (auto rtcRoom = getRtcRoom(mainRoom())) {
         rtcRoom->unpublishStream(bytertc::MediaStreamType::kMediaStreamTypeBoth);
     }
 
@@ -94,45 +127,70 @@ int RtcEngineWrap::initDevices() {
 }
 
 void RtcEngineWrap::resetDevices() {
+	device_registry_.stop();
 	video_device_manager_.reset();
 	audio_device_manager_.reset();
 }
 
 std::shared_ptr<bytertc::IRTCRoom> RtcEngineWrap::createRtcRoom(
         const std::string& room_id) {
-    auto find_it = rooms_.find(room_id);
-    if (find_it != rooms_.cend()) return find_it->second;
+    auto handle = vrd::IdTable::instance().intern(room_id);
+    if (handle == vrd::kInvalidIdHandle) return nullptr;
+    auto find_it = rooms_.find(handle);
+    if (find_it != rooms_.cend()) return find_it->second.room;
 
     CHECK_POINTER(video_engine_, nullptr);
-    rooms_[room_id] = std::shared_ptr<bytertc::IRTCRoom>(
-        video_engine_->createRTCRoom(room_id.c_str()),
-        [=](bytertc::IRTCRoom* room) { room->destroy(); });
-    return rooms_[room_id];
+    auto rtc_room = video_engine_->createRTCRoom(room_id.c_str());
+    CHECK_POINTER(rtc_room, nullptr);
+    RoomEntry& entry = rooms_[handle];
+    entry.adapter.reset(new RtcRoomEventAdapter(*this, handle));
+    entry.room = std::shared_ptr<bytertc::IRTCRoom>(
+        rtc_room, [](bytertc::IRTCRoom* room) { room->destroy(); });
+    entry.room->setRTCRoomEventHandler(entry.adapter.get());
+    entry.channel = new RtcRoomChannel(handle, this);
+    return entry.room;
+}
+
+bool RtcEngineWrap::eraseRoom(vrd::IdHandle room) {
+    auto find_it = rooms_.find(room);
+    if (find_it == rooms_.end()) return false;
+    // Events of the room still queued find no channel and only reach the engine-wide signals
+    find_it->second.channel->deleteLater();
+    rooms_.erase(find_it);
+    return true;
 }
 
 int RtcEngineWrap::destoryRtcRoom(const std::string& room_id) {
     CHECK_POINTER(video_engine_, -API_CALL_ERROR);
-    auto find_it = rooms_.find(room_id);
-    if (find_it != rooms_.cend()) {
-        find_it->second.reset();
-        rooms_.erase(find_it);
-    }
+    eraseRoom(vrd::IdTable::instance().find(room_id));
     return 0;
 }
 
+vrd::IdHandle RtcEngineWrap::mainRoom() const {
+    return main_room_.load(std::memory_order_relaxed);
+}
+
+RtcRoomChannel* RtcEngineWrap::roomChannel(vrd::IdHandle room) const {
+    auto find_it = rooms_.find(room);
+    return find_it != rooms_.cend() ? find_it->second.channel : nullptr;
+}
+
 int RtcEngineWrap::joinRoom(const std::string& token,
                             const std::string& room_id,
                             const bytertc::UserInfo& userInfo,
-                            bytertc::RoomProfileType profileType) {
+                            bytertc::RoomProfileType profileType,
+                            SubscribeMode subscribeMode) {
   CHECK_POINTER(video_engine_, -API_CALL_ERROR);
   room_id_ = room_id;
+  main_room_ = vrd::IdTable::instance().intern(room_id);
+  callback_recorder_.setMainRoom(main_room_);
 
   bytertc::RTCRoomConfig config;
   config.room_profile_type = profileType;
   config.is_auto_publish = true;
   config.is_auto_subscribe_audio = true;
-  config.is_auto_subscribe_video = true;
-  if (auto rtcRoom = getRtcRoom(room_id_)) {
+  config.is_auto_subscribe_video = subscribeMode == AutoSubscribeMode;
+  if (auto rtcRoom = createRtcRoom(room_id_)) {
      return rtcRoom->joinRoom(token.c_str(), userInfo, config);
   }
   return -API_CALL_ERROR;
@@ -140,7 +198,7 @@ int RtcEngineWrap::joinRoom(const std::string& token,
 
 int RtcEngineWrap::setUserRole(bytertc::UserRoleType role) {
   CHECK_POINTER(video_engine_, -API_CALL_ERROR);
-  if (auto rtcRoom = getRtcRoom(room_id_)) {
+  if (auto rtcRoom = getRtcRoom(mainRoom())) {
        rtcRoom->setUserVisibility(role == bytertc::kUserRoleTypeBroadcaster 
            ? true : false);
   }
@@ -216,7 +274,7 @@ int RtcEngineWrap::enableLocalVideo(bool enabled) {
 
 int RtcEngineWrap::muteLocalVideo(bool enabled) {
   CHECK_POINTER(video_engine_, -API_CALL_ERROR);
-  if (auto rtcRoom = getRtcRoom(room_id_)) {
+  if (auto rtcRoom = getRtcRoom(mainRoom())) {
       enabled ? rtcRoom->unpublishStream(bytertc::MediaStreamType::kMediaStreamTypeVideo)
           : rtcRoom->publishStream(bytertc::MediaStreamType::kMediaStreamTypeVideo);
   }
@@ -225,7 +283,7 @@ int RtcEngineWrap::muteLocalVideo(bool enabled) {
 
 int RtcEngineWrap::muteLocalAudio(bool enabled) {
     CHECK_POINTER(video_engine_, -API_CALL_ERROR);
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
+    if (auto rtcRoom = getRtcRoom(mainRoom())) {
         enabled ? rtcRoom->unpublishStream(bytertc::MediaStreamType::kMediaStreamTypeAudio)
             : rtcRoom->publishStream(bytertc::MediaStreamType::kMediaStreamTypeAudio);
     }
@@ -233,7 +291,7 @@ int RtcEngineWrap::muteLocalAudio(bool enabled) {
 }
 
 int RtcEngineWrap::leaveRoom() {
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
+    if (auto rtcRoom = getRtcRoom(mainRoom())) {
         rtcRoom->leaveRoom();
     }
     destoryRtcRoom(room_id_);
@@ -241,32 +299,26 @@ int RtcEngineWrap::leaveRoom() {
 }
 
 int RtcEngineWrap::leaveSubRoom(const std::string& room_id) {
-    auto find_it = rooms_.find(room_id);
-    if (find_it != rooms_.cend()) {
-        find_it->second->leaveRoom();
+    if (auto rtcRoom = getRtcRoom(room_id)) {
+        rtcRoom->leaveRoom();
         return 0;
     }
     return -API_CALL_ERROR;
 }
 
 int RtcEngineWrap::destroySubRoom(const std::string& room_id) {
-    auto find_it = rooms_.find(room_id);
-    if (find_it != rooms_.cend()) {
-        rooms_.erase(find_it);
-        return 0;
-    }
-    return -API_CALL_ERROR;
+    return eraseRoom(vrd::IdTable::instance().find(room_id)) ? 0 : -API_CALL_ERROR;
 }
 
 int RtcEngineWrap::publish() {
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
+    if (auto rtcRoom = getRtcRoom(mainRoom())) {
         rtcRoom->publishStream(bytertc::MediaStreamType::kMediaStreamTypeBoth);
     }
     return 0;
 }
 
 int RtcEngineWrap::unPublish() {
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
+    if (auto rtcRoom = getRtcRoom(mainRoom())) {
         rtcRoom->unpublishStream(bytertc::MediaStreamType::kMediaStreamTypeBoth);
     }
     return 0;
@@ -286,22 +338,33 @@ int RtcEngineWrap::subscribeVideoStream(
     else if (!sub_video && sub_audio) {
         media_type = bytertc::MediaStreamType::kMediaStreamTypeAudio;
     }
+    else {
+        return -API_CALL_ERROR;
+    }
 
-    bytertc::SubscribeVideoConfig videoConfig;
-    videoConfig.priority = config.priority;
-    videoConfig.video_index = config.video_index;
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
+    auto rtcRoom = getRtcRoom(mainRoom());
+    CHECK_POINTER(rtcRoom, -API_CALL_ERROR);
+    if (!sub_video) {
         config.is_screen ? rtcRoom->subscribeScreen(uid.c_str(), media_type)
                         : rtcRoom->subscribeStream(uid.c_str(), media_type);
+        return 0;
     }
+    // video_index picks the simulcast layer, calling again for a subscribed stream switches layers
+    bytertc::SubscribeVideoConfig videoConfig;
+    videoConfig.priority = config.priority;
+    videoConfig.video_index = config.video_index;
+    rtcRoom->subscribeUserStream(uid.c_str(),
+        config.is_screen ? bytertc::kStreamIndexScreen : bytertc::kStreamIndexMain,
+        sub_audio ? bytertc::kRTCSubscribeMediaTypeVideoAndAudio : bytertc::kRTCSubscribeMediaTypeVideoOnly,
+        videoConfig);
     return 0;
 }
 
 int RtcEngineWrap::unSubscribeVideoStream(const std::string& uid,
-                                          bool is_screen) {
-    if (auto rtcRoom = getRtcRoom(room_id_)) {
-        is_screen ? rtcRoom->unsubscribeScreen(uid.c_str(), bytertc::MediaStreamType::kMediaStreamTypeBoth)
-            : rtcRoom->unsubscribeStream(uid.c_str(), bytertc::MediaStreamType::kMediaStreamTypeBoth);
+                                          bool is_screen, bytertc::MediaStreamType type) {
+    if (auto rtcRoom = getRtcRoom(mainRoom())) {
+        is_screen ? rtcRoom->unsubscribeScreen(uid.c_str(), type)
+            : rtcRoom->unsubscribeStream(uid.c_str(), type);
     }
     return 0;
 }
@@ -317,6 +380,12 @@ int RtcEngineWrap::setVideoProfiles(const bytertc::VideoEncoderConfig& config) {
     return video_engine_->setVideoEncoderConfig(config);
 }
 
+int RtcEngineWrap::setVideoProfiles(const std::vector<bytertc::VideoEncoderConfig>& layers) {
+    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
+    if (layers.empty()) return -API_CALL_ERROR;
+    return video_engine_->setVideoEncoderConfig(layers.data(), static_cast<int>(layers.size()));
+}
+
 int RtcEngineWrap::setAudioProfiles(bytertc::AudioProfileType type) {
     CHECK_POINTER(video_engine_, -API_CALL_ERROR);
     video_engine_->setAudioProfile(type);
@@ -382,8 +451,14 @@ int RtcEngineWrap::getShareList(std::vector<SnapshotAttr>& list) {
 QPixmap RtcEngineWrap::getThumbnail(SnapshotAttr::SnapshotType type,
                                     void* source_id, int max_width,
                                     int max_height) {
-    QPixmap pix_map;
-    CHECK_POINTER(video_engine_, pix_map);
+    return QPixmap::fromImage(getThumbnailImage(type, source_id, max_width, max_height));
+}
+
+QImage RtcEngineWrap::getThumbnailImage(SnapshotAttr::SnapshotType type,
+                                    void* source_id, int max_width,
+                                    int max_height) {
+    QImage image;
+    CHECK_POINTER(video_engine_, image);
 
     auto s_type = bytertc::kScreenCaptureSourceTypeUnknown;
     switch (type) {
@@ -396,63 +471,70 @@ QPixmap RtcEngineWrap::getThumbnail(SnapshotAttr::SnapshotType type,
     default:
         break;
     }
-    auto p = video_engine_->getThumbnail(s_type, source_id, max_width, max_height);
-    CHECK_POINTER(p, pix_map);
+    bytertc::IVideoFrame* p = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(thumbnail_mutex_);
+        p = video_engine_->getThumbnail(s_type, source_id, max_width, max_height);
+    }
+    CHECK_POINTER(p, image);
+
+    // The pixels are converted into a pooled buffer so the frame can be released,
+    // the image may outlive this call on another thread and returns the buffer when it goes
+    int width = p->width();
+    int height = p->height();
+    int out_width = width;
+    int out_height = height;
+    vrd::image::fitSize(width, height, max_width, max_height, out_width, out_height);
+    auto& pool = vrd::image::PixelBufferPool::instance();
+    auto buffer = pool.acquire(out_width, out_height);
+
+    const uint8_t* rgb = p->getPlaneData(0);
+    int rgb_stride = p->getPlaneStride(0);
+    vrd::image::PixelBuffer converted;
+    auto format = p->pixelFormat();
+    if (format == bytertc::kVideoPixelFormatI420 || format == bytertc::kVideoPixelFormatNV12) {
+        bool scaled = out_width != width || out_height != height;
+        if (scaled) converted = pool.acquire(width, height);
+        auto& target = scaled ? converted : buffer;
+        if (format == bytertc::kVideoPixelFormatI420) {
+            vrd::image::i420ToRgb32(p->getPlaneData(0), p->getPlaneStride(0),
+                p->getPlaneData(1), p->getPlaneStride(1), p->getPlaneData(2), p->getPlaneStride(2),
+                target.data(), target.stride(), width, height);
+        }
+        else {
+            vrd::image::nv12ToRgb32(p->getPlaneData(0), p->getPlaneStride(0),
+                p->getPlaneData(1), p->getPlaneStride(1), target.data(), target.stride(), width, height);
+        }
+        rgb = target.data();
+        rgb_stride = target.stride();
+    }
+    if (rgb != buffer.data()) {
+        vrd::image::scaleRgb32(rgb, rgb_stride, width, height, buffer.data(), buffer.stride(),
+            out_width, out_height, vrd::image::ScaleFilter::kBox);
+    }
+    p->release();
 
-    QImage img(reinterpret_cast<uchar*>(p->getPlaneData(0)), p->width(),
-        p->height(), QImage::Format::Format_RGB32);
-    return QPixmap::fromImage(img);
+    uint8_t* pixels = buffer.data();
+    int stride = buffer.stride();
+    return QImage(pixels, out_width, out_height, stride, QImage::Format_RGB32,
+        [](void* raw) { vrd::image::PixelBuffer::adopt(raw); }, buffer.detach());
 }
 
 int RtcEngineWrap::getAudioInputDevices(std::vector<RtcDevice>& devices) {
     CHECK_POINTER(this->audio_device_manager_, -API_CALL_ERROR);
-    char szName[512], szId[512];
-    std::string strSelectedDeviceId;
-
-    int devIdx = 0;
-    audio_input_devices_.clear();
-    bytertc::IDeviceCollection* pAudioRecordCollection =
-        audio_device_manager_->enumerateAudioCaptureDevices();
-    if (pAudioRecordCollection) {
-        memset(szName, 0, sizeof(szName));
-        memset(szId, 0, sizeof(szId));
-        devIdx = 0;
-
-        audio_device_manager_->getAudioCaptureDevice(szId);
-        strSelectedDeviceId = szId;
-
-        int nAudioRecNum = pAudioRecordCollection->getCount();
-        if (nAudioRecNum > 0) {
-            for (int i = 0; i < nAudioRecNum; ++i) {
-                memset(szName, 0, sizeof(szName));
-                memset(szId, 0, sizeof(szId));
-                if (pAudioRecordCollection->getDevice(i, szName, szId) == 0) {
-                    if (strSelectedDeviceId == szId) {
-                        current_audio_input_idx_ = i;
-                    }
-                    RtcDevice device;
-                    device.type = RtcDeviceTypeAudioRecord;
-                    device.name = szName;
-                    device.device_id = szId;
-                    audio_input_devices_.push_back(device);
-                }
-            }
-        }
-        devices = audio_input_devices_;
-        pAudioRecordCollection->release();
-        pAudioRecordCollection = nullptr;
-    }
+    devices = device_registry_.devices(vrd::DeviceKind::kAudioInput)->devices;
     return 0;
 }
 
 int RtcEngineWrap::setAudioInputDevice(int index) {
-    if (audio_input_devices_.size() <= static_cast<unsigned int>(index) ||
+    auto list = device_registry_.devices(vrd::DeviceKind::kAudioInput);
+    if (list->devices.size() <= static_cast<unsigned int>(index) ||
         index < 0)
         return -API_CALL_ERROR;
-    current_audio_input_idx_ = index;
+    device_registry_.select(vrd::DeviceKind::kAudioInput, index);
     audio_device_manager_->followSystemCaptureDevice(false);
     return audio_device_manager_->setAudioCaptureDevice(
-        audio_input_devices_[index].device_id.c_str());
+        list->devices[index].device_id.c_str());
 }
 
 int RtcEngineWrap::getAudioInputDevice(std::string& guid) {
@@ -462,66 +544,24 @@ int RtcEngineWrap::getAudioInputDevice(std::string& guid) {
 }
 
 int RtcEngineWrap::getCurrentAudioInputDeviceIndex() {
-    return current_audio_input_idx_;
+    return device_registry_.devices(vrd::DeviceKind::kAudioInput)->selected;
 }
 
 int RtcEngineWrap::getAudioOutputDevices(std::vector<RtcDevice>& devices) {
-    CHECK_POINTER(video_engine_, -API_CALL_ERROR);
-    std::string strSelectedDeviceId;
-    char szName[512], szId[512];
-    int devIdx = 0;
-
-    audio_output_devices_.clear();
-
-    bytertc::IAudioDeviceManager* pAudioDeviceManager =
-        video_engine_->getAudioDeviceManager();
-    if (pAudioDeviceManager) {
-    bytertc::IDeviceCollection* pAudioPlayoutCollection =
-        pAudioDeviceManager->enumerateAudioPlaybackDevices();
-    if (pAudioPlayoutCollection) {
-        memset(szName, 0, sizeof(szName));
-        memset(szId, 0, sizeof(szId));
-        devIdx = 0;
-
-        pAudioDeviceManager->getAudioPlaybackDevice(szId);
-        strSelectedDeviceId = szId;
-
-        int nAudioRecNum = pAudioPlayoutCollection->getCount();
-        if (nAudioRecNum > 0) {
-        for (int i = 0; i < nAudioRecNum; ++i) {
-            memset(szName, 0, sizeof(szName));
-            memset(szId, 0, sizeof(szId));
-
-            if (pAudioPlayoutCollection->getDevice(i, szName, szId) == 0) {
-            if (strSelectedDeviceId == szId) {
-                current_audio_output_idx_ = i;
-            }
-
-            RtcDevice device;
-            device.type = RtcDeviceTypeAudioPlayout;
-            device.name = szName;
-            device.device_id = szId;
-
-            audio_output_devices_.push_back(device);
-            }
-        }
-        }
-        devices = audio_output_devices_;
-        pAudioPlayoutCollection->release();
-        pAudioPlayoutCollection = nullptr;
-    }
-    }
+    CHECK_POINTER(this->audio_device_manager_, -API_CALL_ERROR);
+    devices = device_registry_.devices(vrd::DeviceKind::kAudioOutput)->devices;
     return 0;
 }
 
 int RtcEngineWrap::setAudioOutputDevice(int index) {
-    if (audio_output_devices_.size() >= static_cast<unsigned int>(index) 
+    auto list = device_registry_.devices(vrd::DeviceKind::kAudioOutput);
+    if (list->devices.size() <= static_cast<unsigned int>(index)
         || index < 0)
         return -API_CALL_ERROR;
-    current_audio_output_idx_ = index;
+    device_registry_.select(vrd::DeviceKind::kAudioOutput, index);
     audio_device_manager_->followSystemPlaybackDevice(false);
     return audio_device_manager_->setAudioPlaybackDevice(
-        audio_output_devices_[index].device_id.c_str());
+        list->devices[index].device_id.c_str());
 }
 
 int RtcEngineWrap::getAudioOutputDevice(std::string& guid) {
@@ -531,93 +571,28 @@ int RtcEngineWrap::getAudioOutputDevice(std::string& guid) {
 }
 
 int RtcEngineWrap::getCurrentAudioOutputDeviceIndex() {
-    return current_audio_output_idx_;
+    return device_registry_.devices(vrd::DeviceKind::kAudioOutput)->selected;
 }
 
 int RtcEngineWrap::getVideoCaptureDevices(std::vector<RtcDevice>& devices) {
-    std::string strSelectedDeviceId;
-    char szName[512], szId[512];
-    int devIdx = 0;
-
-    camera_devices_.clear();
-
-    bytertc::IDeviceCollection* pVideoRecordCollection =
-        video_device_manager_->enumerateVideoCaptureDevices();
-    if (pVideoRecordCollection) {
-    memset(szName, 0, sizeof(szName));
-    memset(szId, 0, sizeof(szId));
-    devIdx = 0;
-
-    video_device_manager_->getVideoCaptureDevice(szId);
-    strSelectedDeviceId = szId;
-
-    int nVideoCaptureNum = pVideoRecordCollection->getCount();
-    if (nVideoCaptureNum > 0) {
-        current_camera_idx_ = 0;
-        for (int i = 0; i < nVideoCaptureNum; ++i) {
-        memset(szName, 0, sizeof(szName));
-        memset(szId, 0, sizeof(szId));
-
-        if (pVideoRecordCollection->getDevice(i, szName, szId) == 0) {
-            if (strSelectedDeviceId == szId) {
-            current_camera_idx_ = i;
-            }
-
-            RtcDevice device;
-            device.type = RtcDeviceTypeVideoCapture;
-            device.name = szName;
-            device.device_id = szId;
-
-            camera_devices_.push_back(device);
-        }
-        }
-    }
-    devices = camera_devices_;
-
-    pVideoRecordCollection->release();
-    pVideoRecordCollection = nullptr;
-    }
+    CHECK_POINTER(this->video_device_manager_, -API_CALL_ERROR);
+    devices = device_registry_.devices(vrd::DeviceKind::kVideoCapture)->devices;
     return 0;
 }
 
 int RtcEngineWrap::setVideoCaptureDevice(int index) {
-    if (camera_devices_.size() <= static_cast<unsigned int>(index) || index < 0)
+    auto list = device_registry_.devices(vrd::DeviceKind::kVideoCapture);
+    if (list->devices.size() <= static_cast<unsigned int>(index) || index < 0)
         return -API_CALL_ERROR;
+    device_registry_.select(vrd::DeviceKind::kVideoCapture, index);
     return video_device_manager_->setVideoCaptureDevice(
-        camera_devices_[index].device_id.c_str());
+        list->devices[index].device_id.c_str());
 }
 
 bool RtcEngineWrap::audioReocrdDeviceTest() {
-    bool res = false;
-    char szName[512];
-    char szId[512];
-    if (audio_device_manager_) {
-        bytertc::IDeviceCollection* pAudioRecordCollection =
-            audio_device_manager_->enumerateAudioCaptureDevices();
-        if (pAudioRecordCollection) {
-            memset(szName, 0, sizeof(szName));
-            memset(szId, 0, sizeof(szId));
-
-            int nAudioRecNum = pAudioRecordCollection->getCount();
-            if (nAudioRecNum > 0) {
-                current_audio_input_idx_ = 0;
-                for (int i = 0; i < nAudioRecNum; ++i) {
-                    memset(szName, 0, sizeof(szName));
-
-                    if (pAudioRecordCollection->getDevice(i, szName, szId) == 0) {
-                        auto code =
-                            audio_device_manager_->initAudioCaptureDeviceForTest(szId);
-                        if (code == 0) {
-                            res = true;
-                        }
-                    }
-                }
-            }
-            pAudioRecordCollection->release();
-            pAudioRecordCollection = nullptr;
-        }
-    }
-    return res;
+    if (!audio_device_manager_) return false;
+    // Probed by the registry when the capture devices were last enumerated
+    return device_registry_.devices(vrd::DeviceKind::kAudioInput)->capture_ok;
 }
 
 int RtcEngineWrap::feedBack(bytertc::ProblemFeedbackOption* type, 
@@ -638,10 +613,325 @@ int RtcEngineWrap::setAudioVolumeIndicate(int indicate) {
     return 0;
 }
 
+namespace {
+
+// Room of the callback running on this thread, set by RtcRoomEventAdapter around the forwarded call
+thread_local vrd::IdHandle t_callback_room = vrd::kInvalidIdHandle;
+
+class CallbackRoomScope {
+public:
+    explicit CallbackRoomScope(vrd::IdHandle room) : previous_(t_callback_room) {
+        t_callback_room = room;
+    }
+    ~CallbackRoomScope() {
+        t_callback_room = previous_;
+    }
+
+private:
+    vrd::IdHandle previous_;
+};
+
+// Stream stats are keyed by user, the sub key packs the room and whether it is the screen stream
+int streamStatsSubKey(vrd::IdHandle room, bool is_screen) {
+    return static_cast<int>(room << 1) | (is_screen ? 1 : 0);
+}
+
+// Fixed-size payloads of the forwarded SDK callbacks, strings and arrays travel in the event blob
+struct RoomStatePayload {
+    vrd::IdHandle room_id;
+    vrd::IdHandle uid;
+    int state;
+};
+
+struct VolumePayload {
+    // Detached AudioVolumeSnapshot
+    void* speakers;
+    int total_volume;
+};
+
+struct UserJoinedPayload {
+    vrd::IdHandle uid;
+    int elapsed;
+};
+
+struct UserLeavePayload {
+    vrd::IdHandle uid;
+    bytertc::UserOfflineReason reason;
+};
+
+struct UserCapturePayload {
+    vrd::IdHandle room_id;
+    vrd::IdHandle uid;
+};
+
+struct PublishPayload {
+    vrd::IdHandle uid;
+    bytertc::MediaStreamType type;
+    bytertc::StreamRemoveReason reason;
+};
+
+struct SubscribedPayload {
+    bytertc::SubscribeState state;
+    vrd::IdHandle uid;
+    bytertc::SubscribeConfig info;
+};
+
+struct PublishSuccessPayload {
+    vrd::IdHandle uid;
+    bool is_screen;
+};
+
+struct LocalFramePayload {
+    bytertc::StreamIndex index;
+    bytertc::VideoFrameInfo info;
+};
+
+struct RemoteFramePayload {
+    RemoteStreamKeyWrap key;
+    bytertc::VideoFrameInfo info;
+};
+
+struct AudioDevicePayload {
+    bytertc::RTCAudioDeviceType type;
+    bytertc::MediaDeviceState state;
+    bytertc::MediaDeviceError error;
+};
+
+struct VideoDevicePayload {
+    bytertc::RTCVideoDeviceType type;
+    bytertc::MediaDeviceState state;
+    bytertc::MediaDeviceError error;
+};
+
+struct LocalVideoStatePayload {
+    bytertc::StreamIndex index;
+    bytertc::LocalVideoStreamState state;
+    bytertc::LocalVideoStreamError error;
+};
+
+struct LocalAudioStatePayload {
+    bytertc::LocalAudioStreamState state;
+    bytertc::LocalAudioStreamError error;
+};
+
+struct LoginPayload {
+    vrd::IdHandle uid;
+    int error_code;
+    int elapsed;
+};
+
+struct MessagePayload {
+    vrd::IdHandle uid;
+};
+
+// The ack body belongs to the SDK and is not valid once the callback returns, it travels in the event blob
+struct ServerAckPayload {
+    int64_t msgid;
+    int error;
+};
+
+template <typename P>
+vrd::RtcEvent makeEvent(vrd::RtcEventType type, const P& payload) {
+    vrd::RtcEvent event;
+    event.type = type;
+    event.timestamp_ns = vrd::steadyNowNs();
+    event.room = t_callback_room;
+    event.setPayload(payload);
+    return event;
+}
+
+// Never destroyed, snapshots may still be held by other singletons at exit
+vrd::SnapshotPool<AudioVolumeInfoWrap>& volumeSnapshots() {
+    static auto pool = new vrd::SnapshotPool<AudioVolumeInfoWrap>(64, 128);
+    return *pool;
+}
+
+// Room-scoped events reach the engine-wide signals only for the main room, and their room's channel if it exists
+template <typename... Args, typename... Values>
+void emitRoomSignal(RtcEngineWrap& self, const vrd::RtcEvent& e,
+        void (RtcEngineWrap::*wrap_signal)(Args...),
+        void (RtcRoomChannel::*room_signal)(Args...), const Values&... values) {
+    if (e.room == vrd::kInvalidIdHandle || e.room == self.mainRoom()) {
+        (self.*wrap_signal)(values...);
+    }
+    if (auto channel = self.roomChannel(e.room)) {
+        (channel->*room_signal)(values...);
+    }
+}
+
+using EventHandler = void (*)(RtcEngineWrap& self,
+    const vrd::BlobArena& arena, const vrd::RtcEvent& e);
+
+#define RTC_EVENT_HANDLER(TYPE)                                 \
+    table[static_cast<size_t>(vrd::RtcEventType::TYPE)] =       \
+        [](RtcEngineWrap& self, const vrd::BlobArena& arena, const vrd::RtcEvent& e)
+
+// Runs on the UI thread, turns each event record back into its Qt signal
+const std::array<EventHandler, vrd::kRtcEventTypeCount>& eventHandlers() {
+    static const std::array<EventHandler, vrd::kRtcEventTypeCount> handlers = [] {
+        std::array<EventHandler, vrd::kRtcEventTypeCount> table{};
+        RTC_EVENT_HANDLER(kRoomStateChanged) {
+            auto p = e.payloadAs<RoomStatePayload>();
+            auto& ids = vrd::IdTable::instance();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnRoomStateChanged,
+                &RtcRoomChannel::sigOnRoomStateChanged, ids.str(p.room_id), ids.str(p.uid), p.state,
+                arena.string(e.blob, 0));
+        };
+        RTC_EVENT_HANDLER(kRoomStats) {
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnRoomStats, &RtcRoomChannel::sigOnRoomStats,
+                e.payloadAs<bytertc::RtcRoomStats>());
+        };
+        RTC_EVENT_HANDLER(kWarning) {
+            emit self.sigOnWarning(e.payloadAs<int>());
+        };
+        RTC_EVENT_HANDLER(kError) {
+            emit self.sigOnError(e.payloadAs<int>());
+        };
+        RTC_EVENT_HANDLER(kRemoteAudioVolume) {
+            auto p = e.payloadAs<VolumePayload>();
+            emit self.sigOnRemoteAudioVolumeIndication(
+                AudioVolumeSnapshot::adopt(p.speakers), p.total_volume);
+        };
+        RTC_EVENT_HANDLER(kLocalAudioVolume) {
+            auto p = e.payloadAs<VolumePayload>();
+            emit self.sigOnLocalAudioVolumeIndication(AudioVolumeSnapshot::adopt(p.speakers));
+        };
+        RTC_EVENT_HANDLER(kLeaveRoom) {
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnLeaveRoom, &RtcRoomChannel::sigOnLeaveRoom,
+                e.payloadAs<bytertc::RtcRoomStats>());
+        };
+        RTC_EVENT_HANDLER(kUserJoined) {
+            auto p = e.payloadAs<UserJoinedPayload>();
+            UserInfoWrap wrap;
+            wrap.uid = p.uid;
+            wrap.extra_info = arena.string(e.blob, 0);
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnUserJoined, &RtcRoomChannel::sigOnUserJoined,
+                wrap, p.elapsed);
+        };
+        RTC_EVENT_HANDLER(kUserLeave) {
+            auto p = e.payloadAs<UserLeavePayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnUserLeave, &RtcRoomChannel::sigOnUserLeave,
+                p.uid, p.reason);
+        };
+        RTC_EVENT_HANDLER(kUserStartAudioCapture) {
+            auto p = e.payloadAs<UserCapturePayload>();
+            emit self.sigOnUserStartAudioCapture(p.room_id, p.uid);
+        };
+        RTC_EVENT_HANDLER(kUserStopAudioCapture) {
+            auto p = e.payloadAs<UserCapturePayload>();
+            emit self.sigOnUserStopAudioCapture(p.room_id, p.uid);
+        };
+        RTC_EVENT_HANDLER(kFirstLocalAudioFrame) {
+            emit self.sigOnFirstLocalAudioFrame(e.payloadAs<bytertc::StreamIndex>());
+        };
+        RTC_EVENT_HANDLER(kLogReport) {
+            emit self.sigOnLogReport(arena.string(e.blob, 0), arena.string(e.blob, 1));
+        };
+        RTC_EVENT_HANDLER(kUserPublishStream) {
+            auto p = e.payloadAs<PublishPayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnUserPublishStream,
+                &RtcRoomChannel::sigOnUserPublishStream, p.uid, p.type);
+        };
+        RTC_EVENT_HANDLER(kUserUnpublishStream) {
+            auto p = e.payloadAs<PublishPayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnUserUnPublishStream,
+                &RtcRoomChannel::sigOnUserUnPublishStream, p.uid, p.type, p.reason);
+        };
+        RTC_EVENT_HANDLER(kUserPublishScreen) {
+            auto p = e.payloadAs<PublishPayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnUserPublishScreen,
+                &RtcRoomChannel::sigOnUserPublishScreen, p.uid, p.type);
+        };
+        RTC_EVENT_HANDLER(kUserUnpublishScreen) {
+            auto p = e.payloadAs<PublishPayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnUserUnPublishScreen,
+                &RtcRoomChannel::sigOnUserUnPublishScreen, p.uid, p.type, p.reason);
+        };
+        RTC_EVENT_HANDLER(kStreamSubscribed) {
+            auto p = e.payloadAs<SubscribedPayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnStreamSubscribed,
+                &RtcRoomChannel::sigOnStreamSubscribed, p.state, p.uid, p.info);
+        };
+        RTC_EVENT_HANDLER(kStreamPublishSuccess) {
+            auto p = e.payloadAs<PublishSuccessPayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnStreamPublishSuccess,
+                &RtcRoomChannel::sigOnStreamPublishSuccess, p.uid, p.is_screen);
+        };
+        RTC_EVENT_HANDLER(kFirstLocalVideoFrameCaptured) {
+            auto p = e.payloadAs<LocalFramePayload>();
+            emit self.sigOnFirstLocalVideoFrameCaptured(p.index, p.info);
+        };
+        RTC_EVENT_HANDLER(kFirstRemoteVideoFrameDecoded) {
+            auto p = e.payloadAs<RemoteFramePayload>();
+            emit self.sigOnFirstRemoteVideoFrameDecoded(p.key, p.info);
+        };
+        RTC_EVENT_HANDLER(kUserStartVideoCapture) {
+            auto p = e.payloadAs<UserCapturePayload>();
+            emit self.sigOnUserStartVideoCapture(p.room_id, p.uid);
+        };
+        RTC_EVENT_HANDLER(kUserStopVideoCapture) {
+            auto p = e.payloadAs<UserCapturePayload>();
+            emit self.sigOnUserStopVideoCapture(p.room_id, p.uid);
+        };
+        RTC_EVENT_HANDLER(kAudioDeviceStateChanged) {
+            auto p = e.payloadAs<AudioDevicePayload>();
+            emit self.sigOnAudioDeviceStateChanged(arena.string(e.blob, 0), p.type, p.state, p.error);
+        };
+        RTC_EVENT_HANDLER(kVideoDeviceStateChanged) {
+            auto p = e.payloadAs<VideoDevicePayload>();
+            emit self.sigOnVideoDeviceStateChanged(arena.string(e.blob, 0), p.type, p.state, p.error);
+        };
+        RTC_EVENT_HANDLER(kAudioPlaybackDeviceTestVolume) {
+            emit self.sigOnAudioPlaybackDeviceTestVolume(e.payloadAs<int>());
+        };
+        RTC_EVENT_HANDLER(kLocalVideoStateChanged) {
+            auto p = e.payloadAs<LocalVideoStatePayload>();
+            emit self.sigOnLocalVideoStateChanged(p.index, p.state, p.error);
+        };
+        RTC_EVENT_HANDLER(kLocalAudioStateChanged) {
+            auto p = e.payloadAs<LocalAudioStatePayload>();
+            emit self.sigOnLocalAudioStateChanged(p.state, p.error);
+        };
+        RTC_EVENT_HANDLER(kSysStats) {
+            emit self.sigOnSysStats(e.payloadAs<bytertc::SysStats>());
+        };
+        RTC_EVENT_HANDLER(kNetworkTypeChanged) {
+            emit self.sigOnNetworkTypeChanged(e.payloadAs<bytertc::NetworkType>());
+        };
+        RTC_EVENT_HANDLER(kLoginResult) {
+            auto p = e.payloadAs<LoginPayload>();
+            emit self.sigOnLoginResult(vrd::IdTable::instance().str(p.uid), p.error_code, p.elapsed);
+        };
+        RTC_EVENT_HANDLER(kServerParamsSetResult) {
+            emit self.sigOnServerParamsSetResult(e.payloadAs<int>());
+        };
+        RTC_EVENT_HANDLER(kMessageReceived) {
+            auto p = e.payloadAs<MessagePayload>();
+            emitRoomSignal(self, e, &RtcEngineWrap::sigOnMessageReceived,
+                &RtcRoomChannel::sigOnMessageReceived, vrd::IdTable::instance().str(p.uid),
+                arena.string(e.blob, 0));
+        };
+        RTC_EVENT_HANDLER(kServerMessageSendResult) {
+            auto p = e.payloadAs<ServerAckPayload>();
+            bytertc::ServerACKMsg msg = bytertc::ServerACKMsg();
+            msg.length = static_cast<int>(e.blob.size);
+            msg.ACKMsg = msg.length ? const_cast<char*>(arena.data(e.blob)) : nullptr;
+            emit self.sigOnServerMessageSendResult(p.msgid, p.error, msg);
+        };
+        return table;
+    }();
+    return handlers;
+}
+
+#undef RTC_EVENT_HANDLER
+
+}  // namespace
+
 void RtcEngineWrap::emitOnRTSMessageArrived(const char* uid, const char* message) {
-	ForwardEvent::PostEvent(this, [=, uid = std::string(uid), message = std::string(message)]{
-	    emit sigOnMessageReceived(uid, message);
-	});
+    MessagePayload payload{ vrd::IdTable::instance().intern(uid) };
+    auto event = makeEvent(vrd::RtcEventType::kMessageReceived, payload);
+    event.blob = event_arena_.storeStrings({ message });
+    forward(std::move(event));
 }
 
 std::unique_ptr<bytertc::IRTCVideo, std::function<void(bytertc::IRTCVideo*)>>&
@@ -649,28 +939,179 @@ RtcEngineWrap::getRtcEngine() {
 	return video_engine_;
 }
 
+vrd::EventBusBase::Stats RtcEngineWrap::eventBusStats() const {
+    return event_bus_.stats();
+}
+
+uint64_t RtcEngineWrap::eventShedCount(vrd::RtcEventType type) const {
+    auto idx = static_cast<size_t>(type);
+    return idx < vrd::kRtcEventTypeCount ? event_shed_[idx].load(std::memory_order_relaxed) : 0;
+}
+
+vrd::BlobArena::Stats RtcEngineWrap::eventArenaStats() const {
+    return event_arena_.stats();
+}
+
+vrd::LatencyHistogram::Summary RtcEngineWrap::eventLatency(vrd::RtcEventType type) const {
+    auto idx = static_cast<size_t>(type);
+    return idx < vrd::kRtcEventTypeCount ? event_latency_[idx].summary()
+        : vrd::LatencyHistogram::Summary();
+}
+
+void RtcEngineWrap::resetEventLatency() {
+    for (auto& histogram : event_latency_) {
+        histogram.reset();
+    }
+}
+
+void RtcEngineWrap::dumpEventLatency() const {
+    auto bus = event_bus_.stats();
+    qInfo("rtc event bus: posted=%llu dropped=%llu shed=%llu coalesced=%llu batches=%llu max_depth=%zu",
+        static_cast<unsigned long long>(bus.posted), static_cast<unsigned long long>(bus.dropped),
+        static_cast<unsigned long long>(bus.shed), static_cast<unsigned long long>(bus.coalesced),
+        static_cast<unsigned long long>(bus.batches), bus.max_depth);
+    if (auto dropped = remote_stream_stats_.overflowCount()) {
+        qInfo("remote stream stats: %llu reports dropped, table holds %zu streams",
+            static_cast<unsigned long long>(dropped), kMaxRemoteStreams);
+    }
+    for (size_t i = 0; i < vrd::kRtcEventTypeCount; i++) {
+        auto s = event_latency_[i].summary();
+        auto shed = event_shed_[i].load(std::memory_order_relaxed);
+        if (s.count == 0 && shed == 0) continue;
+        qInfo("rtc event latency %s: count=%llu p50=%lluus p99=%lluus max=%lluus shed=%llu",
+            vrd::rtcEventTypeName(static_cast<vrd::RtcEventType>(i)),
+            static_cast<unsigned long long>(s.count), static_cast<unsigned long long>(s.p50_us),
+            static_cast<unsigned long long>(s.p99_us), static_cast<unsigned long long>(s.max_us),
+            static_cast<unsigned long long>(shed));
+    }
+}
+
+bool RtcEngineWrap::startCallbackRecording(const std::string& path) {
+    bool ok = callback_recorder_.start(path);
+    qInfo("callback recording %s: %s", ok ? "started" : "failed", path.c_str());
+    return ok;
+}
+
+void RtcEngineWrap::stopCallbackRecording() {
+    if (!callback_recorder_.active()) return;
+    callback_recorder_.stop();
+    qInfo("callback recording stopped, records=%llu",
+        static_cast<unsigned long long>(callback_recorder_.recordCount()));
+}
+
+vrd::CallbackPlayer::Result RtcEngineWrap::replayCallbackRecording(const std::string& path,
+        vrd::CallbackPlayer::Pace pace) {
+    vrd::CallbackPlayer player(path);
+    if (!player.open()) {
+        qWarning("callback replay: cannot open %s", path.c_str());
+        return vrd::CallbackPlayer::Result();
+    }
+    const char* sdk_version = bytertc::getSDKVersion();
+    if (player.sdkVersion() != (sdk_version ? sdk_version : "")) {
+        qWarning("callback replay: recorded with sdk %s, running %s",
+            player.sdkVersion().c_str(), sdk_version ? sdk_version : "");
+    }
+    // Main room callbacks replay into the current main room, sub-room ones into an open room of the same id
+    std::unordered_map<std::string, bytertc::IRTCRoomEventHandler*> handlers;
+    for (const auto& room : rooms_) {
+        handlers.emplace(vrd::IdTable::instance().str(room.first), room.second.adapter.get());
+    }
+    bytertc::IRTCRoomEventHandler* main_handler = this;
+    auto main_it = rooms_.find(mainRoom());
+    if (main_it != rooms_.end()) main_handler = main_it->second.adapter.get();
+    auto room_handlers = [&handlers, main_handler](const char* room_id, bool main_room)
+            -> bytertc::IRTCRoomEventHandler* {
+        if (main_room || !room_id) return main_handler;
+        auto find_it = handlers.find(room_id);
+        return find_it != handlers.end() ? find_it->second : nullptr;
+    };
+    return player.play(this, room_handlers, pace);
+}
+
+size_t RtcEngineWrap::collectRemoteStreamStats(RemoteStreamStatsTable::Cursor& cursor,
+        const std::function<void(const RemoteStreamStatsWrap&)>& fn, vrd::IdHandle room) const {
+    auto main_room = mainRoom();
+    if (room == vrd::kInvalidIdHandle) room = main_room;
+    return remote_stream_stats_.collect(cursor,
+        [&fn, room, main_room](const RemoteStreamStatsTable::Entry& entry) {
+            auto entry_room = static_cast<vrd::IdHandle>(entry.sub_key >> 1);
+            // Untagged reports come from callbacks delivered without an adapter, e.g. a replay
+            if (entry_room == vrd::kInvalidIdHandle) entry_room = main_room;
+            if (entry_room != room) return;
+            RemoteStreamStatsWrap wrap;
+            wrap.uid = entry.key;
+            wrap.room_id = entry_room;
+            wrap.is_screen = (entry.sub_key & 1) != 0;
+            wrap.audio_stats = entry.value.audio_stats;
+            wrap.video_stats = entry.value.video_stats;
+            wrap.remote_tx_quality = entry.value.remote_tx_quality;
+            wrap.remote_rx_quality = entry.value.remote_rx_quality;
+            fn(wrap);
+        });
+}
+
+bool RtcEngineWrap::latestLocalStreamStats(bool is_screen,
+        bytertc::LocalStreamStats& stats, uint64_t* version) const {
+    return local_stream_stats_[is_screen ? 1 : 0].load(stats, version);
+}
+
+bool RtcEngineWrap::forward(vrd::RtcEvent&& event) {
+    auto blob = event.blob;
+    auto idx = static_cast<size_t>(event.type);
+    auto lane = vrd::isRtcTelemetryEvent(event.type)
+        ? decltype(event_bus_)::Lane::kTelemetry : decltype(event_bus_)::Lane::kControl;
+    if (!event_bus_.post(std::move(event), lane)) {
+        if (idx < vrd::kRtcEventTypeCount) {
+            event_shed_[idx].fetch_add(1, std::memory_order_relaxed);
+        }
+        event_arena_.release(blob);
+        return false;
+    }
+    return true;
+}
+
+void RtcEngineWrap::dispatch(vrd::RtcEvent& event) {
+    auto idx = static_cast<size_t>(event.type);
+    if (idx < vrd::kRtcEventTypeCount && eventHandlers()[idx]) {
+        auto now = vrd::steadyNowNs();
+        if (event.timestamp_ns && now > event.timestamp_ns) {
+            event_latency_[idx].record((now - event.timestamp_ns) / 1000);
+        }
+        eventHandlers()[idx](*this, event_arena_, event);
+    }
+    event_arena_.release(event.blob);
+}
+
+void RtcEngineWrap::discard(vrd::RtcEvent& event) {
+    auto idx = static_cast<size_t>(event.type);
+    if (idx < vrd::kRtcEventTypeCount) {
+        event_shed_[idx].fetch_add(1, std::memory_order_relaxed);
+    }
+    // Volume events carry a snapshot reference that only the dispatched handler would adopt
+    if (event.type == vrd::RtcEventType::kRemoteAudioVolume
+        || event.type == vrd::RtcEventType::kLocalAudioVolume) {
+        AudioVolumeSnapshot::adopt(event.payloadAs<VolumePayload>().speakers);
+    }
+    event_arena_.release(event.blob);
+}
+
 void RtcEngineWrap::customEvent(QEvent* e) {
-  if (e->type() == QEvent::User) {
+  if (vrd::EventBusBase::isWakeEvent(e)) {
+    event_bus_.drain();
+  }
+  else if (e->type() == QEvent::User) {
     auto user_event = static_cast<ForwardEvent*>(e);
     user_event->execTask();
   }
 }
 
-std::shared_ptr<bytertc::IRTCRoom> RtcEngineWrap::getRtcRoom(const std::string& room_id) {
-    if (room_id.empty()) {
-        return nullptr;
-    }
+std::shared_ptr<bytertc::IRTCRoom> RtcEngineWrap::getRtcRoom(vrd::IdHandle room) const {
+    auto find_it = rooms_.find(room);
+    return find_it != rooms_.cend() ? find_it->second.room : nullptr;
+}
 
-    auto find_it = rooms_.find(room_id);
-    if (find_it != rooms_.cend()) {
-        return find_it->second;
-    }
-    CHECK_POINTER(video_engine_, nullptr);
-    rooms_[room_id] = std::shared_ptr<bytertc::IRTCRoom>(
-        video_engine_->createRTCRoom(room_id.c_str()),
-        [=](bytertc::IRTCRoom* room) { room->destroy(); });
-    rooms_[room_id]->setRTCRoomEventHandler(this);
-    return rooms_[room_id];
+std::shared_ptr<bytertc::IRTCRoom> RtcEngineWrap::getRtcRoom(const std::string& room_id) const {
+    return getRtcRoom(vrd::IdTable::instance().find(room_id));
 }
 
 int RtcEngineWrap::getVideoCaptureDevice(std::string& guid) {
@@ -680,12 +1121,17 @@ int RtcEngineWrap::getVideoCaptureDevice(std::string& guid) {
 }
 
 int RtcEngineWrap::getCurrentVideoCaptureDeviceIndex() {
-    return current_camera_idx_;
+    return device_registry_.devices(vrd::DeviceKind::kVideoCapture)->selected;
 }
 
 void RtcEngineWrap::followSystemCaptureDevice(bool enabled) {
     CHECK_POINTER(this->audio_device_manager_);
     audio_device_manager_->followSystemCaptureDevice(enabled);
+    device_registry_.invalidate(vrd::DeviceKind::kAudioInput);
+}
+
+vrd::DeviceRegistry::Stats RtcEngineWrap::deviceRegistryStats() const {
+    return device_registry_.stats();
 }
 
 int RtcEngineWrap::enableEffectBeauty(bool enabled) {
@@ -717,8 +1163,8 @@ int RtcEngineWrap::startScreenCapture(void* source_id,
   auto nRet =
       video_engine_->startScreenVideoCapture(screenSourceInfo, screenCaptureParams);
 
-  if (nRet == 0 && getRtcRoom(room_id_)) {
-      getRtcRoom(room_id_)->publishScreen(bytertc::kMediaStreamTypeBoth);
+  if (nRet == 0 && getRtcRoom(mainRoom())) {
+      getRtcRoom(mainRoom())->publishScreen(bytertc::kMediaStreamTypeBoth);
   }
   return nRet;
 }
@@ -735,8 +1181,8 @@ int RtcEngineWrap::startScreenCaptureByWindowId(void* window_id) {
       bytertc::kMouseCursorCaptureStateOff;
   auto nRet =
       video_engine_->startScreenVideoCapture(screenSourceInfo, screenCaptureParams);
-  if (nRet == 0 && getRtcRoom(room_id_)) {
-      getRtcRoom(room_id_)->publishScreen(bytertc::kMediaStreamTypeBoth);
+  if (nRet == 0 && getRtcRoom(mainRoom())) {
+      getRtcRoom(mainRoom())->publishScreen(bytertc::kMediaStreamTypeBoth);
   }
   return nRet;
 }
@@ -744,8 +1190,8 @@ int RtcEngineWrap::startScreenCaptureByWindowId(void* window_id) {
 int RtcEngineWrap::stopScreenCapture() {
     CHECK_POINTER(video_engine_, -API_CALL_ERROR);
     video_engine_->stopScreenVideoCapture();
-    if (getRtcRoom(room_id_)) {
-        getRtcRoom(room_id_)->unpublishScreen(bytertc::kMediaStreamTypeBoth);
+    if (getRtcRoom(mainRoom())) {
+        getRtcRoom(mainRoom())->unpublishScreen(bytertc::kMediaStreamTypeBoth);
     }
     return 0;
 }
@@ -764,250 +1210,387 @@ int RtcEngineWrap::stopScreenAudioCapture() {
 
 void RtcEngineWrap::onRoomStateChanged(const char* room_id, const char* uid,
                                        int state, const char* extra_info) {
-    ForwardEvent::PostEvent(
-        this, [=, rid = std::string(room_id), uid = std::string(uid),
-        extra_info = std::string(extra_info)]{
-            emit sigOnRoomStateChanged(rid, uid, state, extra_info);
-        });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kRoomStateChanged, room_id, uid, state, extra_info);
+    auto& ids = vrd::IdTable::instance();
+    RoomStatePayload payload{ ids.intern(room_id), ids.intern(uid), state };
+    auto event = makeEvent(vrd::RtcEventType::kRoomStateChanged, payload);
+    event.blob = event_arena_.storeStrings({ extra_info });
+    forward(std::move(event));
 }
 
 void RtcEngineWrap::onRoomStats(const bytertc::RtcRoomStats& stats) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnRoomStats(stats); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kRoomStats, stats);
+    forward(makeEvent(vrd::RtcEventType::kRoomStats, stats));
 }
 
 void RtcEngineWrap::onLocalStreamStats(const bytertc::LocalStreamStats& stats) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnLocalStreamStats(stats); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLocalStreamStats, stats);
+    // The local registers describe what we publish in the main room
+    if (t_callback_room != vrd::kInvalidIdHandle && t_callback_room != mainRoom()) return;
+    local_stream_stats_[stats.is_screen ? 1 : 0].store(stats);
 }
 
 void RtcEngineWrap::onRemoteStreamStats(
     const bytertc::RemoteStreamStats& stats) {
-    RemoteStreamStatsWrap wrap;
-    wrap.audio_stats = stats.audio_stats;
-    wrap.is_screen = stats.is_screen;
-    wrap.remote_rx_quality = stats.remote_rx_quality;
-    wrap.remote_tx_quality = stats.remote_tx_quality;
-    wrap.uid = stats.uid;
-    wrap.video_stats = stats.video_stats;
-    ForwardEvent::PostEvent(this, [=] { emit sigOnRemoteStreamStats(wrap); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kRemoteStreamStats, stats);
+    RemoteStreamStatsRecord record;
+    record.audio_stats = stats.audio_stats;
+    record.video_stats = stats.video_stats;
+    record.remote_tx_quality = stats.remote_tx_quality;
+    record.remote_rx_quality = stats.remote_rx_quality;
+    if (!remote_stream_stats_.update(vrd::IdTable::instance().intern(stats.uid),
+            streamStatsSubKey(t_callback_room, stats.is_screen), record)) {
+        // Logged on the 1st, 2nd, 4th, 8th... drop so a full table does not flood the log
+        auto dropped = remote_stream_stats_.overflowCount();
+        if ((dropped & (dropped - 1)) == 0) {
+            qWarning("remote stream stats table full (%zu streams), %llu reports dropped",
+                kMaxRemoteStreams, static_cast<unsigned long long>(dropped));
+        }
+    }
 }
 
 void RtcEngineWrap::onWarning(int warn) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnWarning(warn); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kWarning, warn);
+    forward(makeEvent(vrd::RtcEventType::kWarning, warn));
 }
 
 void RtcEngineWrap::onError(int err) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnError(err); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kError, err);
+    forward(makeEvent(vrd::RtcEventType::kError, err));
 }
 
 void RtcEngineWrap::onRemoteAudioPropertiesReport(
         const bytertc::RemoteAudioPropertiesInfo* audio_properties_infos,
         int audio_properties_info_number, int total_remote_volume) {
-    std::vector<AudioVolumeInfoWrap> vec_;
-    for (size_t i = 0; i < audio_properties_info_number; i++) {
-        AudioVolumeInfoWrap wrap{
-            audio_properties_infos[i].audio_properties_info.linear_volume,
-            audio_properties_infos[i].stream_key.stream_index,
-            audio_properties_infos[i].stream_key.user_id,
-            audio_properties_infos[i].stream_key.room_id
-        };
-        vec_.push_back(std::move(wrap));
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kRemoteAudioPropertiesReport,
+        vrd::RecordArray<bytertc::RemoteAudioPropertiesInfo>{ audio_properties_infos, audio_properties_info_number },
+        total_remote_volume);
+    auto& ids = vrd::IdTable::instance();
+    auto count = audio_properties_info_number > 0 ? audio_properties_info_number : 0;
+    auto speakers = volumeSnapshots().make(count, [&](AudioVolumeInfoWrap* items) {
+        for (int i = 0; i < count; i++) {
+            items[i].volume = audio_properties_infos[i].audio_properties_info.linear_volume;
+            items[i].stream_index = audio_properties_infos[i].stream_key.stream_index;
+            items[i].uid = ids.intern(audio_properties_infos[i].stream_key.user_id);
+            items[i].room_id = ids.intern(audio_properties_infos[i].stream_key.room_id);
+        }
+    });
+    VolumePayload payload{ speakers.detach(), total_remote_volume };
+    if (!forward(makeEvent(vrd::RtcEventType::kRemoteAudioVolume, payload))) {
+        AudioVolumeSnapshot::adopt(payload.speakers);
     }
-    ForwardEvent::PostEvent(
-        this, [=] { emit sigOnRemoteAudioVolumeIndication(vec_, total_remote_volume); });
 }
 
 void RtcEngineWrap::onLocalAudioPropertiesReport(const bytertc::LocalAudioPropertiesInfo* audio_properties_infos, int audio_properties_info_number) {
-    std::vector<AudioVolumeInfoWrap> vec_;
-    for (size_t i = 0; i < audio_properties_info_number; i++) {
-        AudioVolumeInfoWrap wrap{
-            audio_properties_infos[i].audio_properties_info.linear_volume,
-            audio_properties_infos[i].stream_index,
-        };
-        vec_.push_back(std::move(wrap));
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLocalAudioPropertiesReport,
+        vrd::RecordArray<bytertc::LocalAudioPropertiesInfo>{ audio_properties_infos, audio_properties_info_number });
+    auto count = audio_properties_info_number > 0 ? audio_properties_info_number : 0;
+    auto speakers = volumeSnapshots().make(count, [&](AudioVolumeInfoWrap* items) {
+        for (int i = 0; i < count; i++) {
+            items[i] = AudioVolumeInfoWrap();
+            items[i].volume = audio_properties_infos[i].audio_properties_info.linear_volume;
+            items[i].stream_index = audio_properties_infos[i].stream_index;
+        }
+    });
+    VolumePayload payload{ speakers.detach(), 0 };
+    if (!forward(makeEvent(vrd::RtcEventType::kLocalAudioVolume, payload))) {
+        AudioVolumeSnapshot::adopt(payload.speakers);
     }
-    ForwardEvent::PostEvent(
-        this, [=] { emit sigOnLocalAudioVolumeIndication(vec_); });
 }
 
 void RtcEngineWrap::onLeaveRoom(const bytertc::RtcRoomStats& stats) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnLeaveRoom(stats); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLeaveRoom, stats);
+    forward(makeEvent(vrd::RtcEventType::kLeaveRoom, stats));
 }
 
 void RtcEngineWrap::onUserJoined(const bytertc::UserInfo& userInfo,
                                  int elapsed) {
-    UserInfoWrap wrap;
-    wrap.uid = std::string(userInfo.uid);
-    wrap.extra_info = std::string(userInfo.extra_info);
-    ForwardEvent::PostEvent(this, [=] { emit sigOnUserJoined(wrap, elapsed); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserJoined, userInfo, elapsed);
+    UserJoinedPayload payload{ vrd::IdTable::instance().intern(userInfo.uid), elapsed };
+    auto event = makeEvent(vrd::RtcEventType::kUserJoined, payload);
+    event.blob = event_arena_.storeStrings({ userInfo.extra_info });
+    forward(std::move(event));
 }
 
 void RtcEngineWrap::onUserLeave(const char* uid,
                                 bytertc::UserOfflineReason reason) {
-    ForwardEvent::PostEvent(
-        this, [=, uid = std::string(uid)]{ emit sigOnUserLeave(uid, reason); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserLeave, uid, reason);
+    auto handle = vrd::IdTable::instance().intern(uid);
+    remote_stream_stats_.remove(handle, streamStatsSubKey(t_callback_room, false));
+    remote_stream_stats_.remove(handle, streamStatsSubKey(t_callback_room, true));
+    UserLeavePayload payload{ handle, reason };
+    forward(makeEvent(vrd::RtcEventType::kUserLeave, payload));
 }
 
 void RtcEngineWrap::onUserStartAudioCapture(const char* room_id, const char* user_id) {
-    ForwardEvent::PostEvent(this, [=, roomId = std::string(room_id), uid = std::string(user_id)]{
-        emit sigOnUserStartAudioCapture(roomId, uid);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserStartAudioCapture, room_id, user_id);
+    auto& ids = vrd::IdTable::instance();
+    UserCapturePayload payload{ ids.intern(room_id), ids.intern(user_id) };
+    forward(makeEvent(vrd::RtcEventType::kUserStartAudioCapture, payload));
 }
 
 void RtcEngineWrap::onUserStopAudioCapture(const char* room_id, const char* user_id) {
-    ForwardEvent::PostEvent(this, [=, roomId = std::string(room_id), uid = std::string(user_id)]{
-        emit sigOnUserStopAudioCapture(roomId, uid);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserStopAudioCapture, room_id, user_id);
+    auto& ids = vrd::IdTable::instance();
+    UserCapturePayload payload{ ids.intern(room_id), ids.intern(user_id) };
+    forward(makeEvent(vrd::RtcEventType::kUserStopAudioCapture, payload));
 }
 
 void RtcEngineWrap::onFirstLocalAudioFrame(bytertc::StreamIndex index) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnFirstLocalAudioFrame(index); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kFirstLocalAudioFrame, index);
+    forward(makeEvent(vrd::RtcEventType::kFirstLocalAudioFrame, index));
 }
 
 void RtcEngineWrap::onLogReport(const char* log_type, const char* log_content) {
-    ForwardEvent::PostEvent(this, [=, log_type_ = std::string(log_type),
-        log_content_ = std::string(log_content)]{
-            emit sigOnLogReport(log_type_, log_content_);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLogReport, log_type, log_content);
+    auto event = makeEvent(vrd::RtcEventType::kLogReport, 0);
+    event.blob = event_arena_.storeStrings({ log_type, log_content });
+    forward(std::move(event));
 }
 
 void RtcEngineWrap::onUserPublishStream(const char* uid, bytertc::MediaStreamType type) {
-    ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
-        emit sigOnUserPublishStream(uid, type);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserPublishStream, uid, type);
+    PublishPayload payload{ vrd::IdTable::instance().intern(uid), type };
+    forward(makeEvent(vrd::RtcEventType::kUserPublishStream, payload));
 }
 
 void RtcEngineWrap::onUserUnpublishStream(const char* uid, bytertc::MediaStreamType type,
         bytertc::StreamRemoveReason reason) {
-    ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
-        emit sigOnUserUnPublishStream(uid, type, reason);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserUnpublishStream, uid, type, reason);
+    PublishPayload payload{ vrd::IdTable::instance().intern(uid), type, reason };
+    forward(makeEvent(vrd::RtcEventType::kUserUnpublishStream, payload));
 }
 
 void RtcEngineWrap::onUserPublishScreen(const char* uid, bytertc::MediaStreamType type) {
-    ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
-        emit sigOnUserPublishScreen(uid, type);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserPublishScreen, uid, type);
+    PublishPayload payload{ vrd::IdTable::instance().intern(uid), type };
+    forward(makeEvent(vrd::RtcEventType::kUserPublishScreen, payload));
 }
 
 void RtcEngineWrap::onUserUnpublishScreen(const char* uid,
     bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason) {
-    ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
-        emit sigOnUserUnPublishScreen(uid, type, reason);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserUnpublishScreen, uid, type, reason);
+    PublishPayload payload{ vrd::IdTable::instance().intern(uid), type, reason };
+    forward(makeEvent(vrd::RtcEventType::kUserUnpublishScreen, payload));
 }
 
 void RtcEngineWrap::onStreamSubscribed(bytertc::SubscribeState state_code,
                                        const char* user_id,
                                        const bytertc::SubscribeConfig& info) {
-  ForwardEvent::PostEvent(
-      this, [=] { emit sigOnStreamSubscribed(state_code, user_id, info); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kStreamSubscribed, state_code, user_id, info);
+    SubscribedPayload payload{ state_code, vrd::IdTable::instance().intern(user_id), info };
+    forward(makeEvent(vrd::RtcEventType::kStreamSubscribed, payload));
 }
 
 void RtcEngineWrap::onStreamPublishSuccess(const char* user_id,
                                            bool is_screen) {
-    ForwardEvent::PostEvent(this, [=, uid = std::string(user_id)]{
-        emit sigOnStreamPublishSuccess(user_id, is_screen);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kStreamPublishSuccess, user_id, is_screen);
+    PublishSuccessPayload payload{ vrd::IdTable::instance().intern(user_id), is_screen };
+    forward(makeEvent(vrd::RtcEventType::kStreamPublishSuccess, payload));
 }
 
 void RtcEngineWrap::onFirstLocalVideoFrameCaptured(
     bytertc::StreamIndex index, bytertc::VideoFrameInfo info) {
-  ForwardEvent::PostEvent(
-      this, [=] { emit sigOnFirstLocalVideoFrameCaptured(index, info); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kFirstLocalVideoFrameCaptured, index, info);
+    LocalFramePayload payload{ index, info };
+    forward(makeEvent(vrd::RtcEventType::kFirstLocalVideoFrameCaptured, payload));
 }
 
 void RtcEngineWrap::onFirstRemoteVideoFrameDecoded(
     const bytertc::RemoteStreamKey key, const bytertc::VideoFrameInfo& info) {
-    RemoteStreamKeyWrap wrap;
-    wrap.room_id = std::string(key.room_id);
-    wrap.user_id = std::string(key.user_id);
-    wrap.stream_index = key.stream_index;
-    ForwardEvent::PostEvent(
-        this, [=] { emit sigOnFirstRemoteVideoFrameDecoded(wrap, info); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kFirstRemoteVideoFrameDecoded, key, info);
+    RemoteFramePayload payload;
+    payload.key.room_id = vrd::IdTable::instance().intern(key.room_id);
+    payload.key.user_id = vrd::IdTable::instance().intern(key.user_id);
+    payload.key.stream_index = key.stream_index;
+    payload.info = info;
+    forward(makeEvent(vrd::RtcEventType::kFirstRemoteVideoFrameDecoded, payload));
 }
 
 void RtcEngineWrap::onUserStartVideoCapture(const char* room_id, const char* user_id) {
-    ForwardEvent::PostEvent(this, [=, roomId = std::string(room_id), uid = std::string(user_id)]{
-        emit sigOnUserStartVideoCapture(roomId, uid);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserStartVideoCapture, room_id, user_id);
+    auto& ids = vrd::IdTable::instance();
+    UserCapturePayload payload{ ids.intern(room_id), ids.intern(user_id) };
+    forward(makeEvent(vrd::RtcEventType::kUserStartVideoCapture, payload));
 }
 
 void RtcEngineWrap::onUserStopVideoCapture(const char* room_id, const char* user_id) {
-    ForwardEvent::PostEvent(this, [=, roomId = std::string(room_id), uid = std::string(user_id)]{
-        emit sigOnUserStopVideoCapture(roomId, uid);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserStopVideoCapture, room_id, user_id);
+    auto& ids = vrd::IdTable::instance();
+    UserCapturePayload payload{ ids.intern(room_id), ids.intern(user_id) };
+    forward(makeEvent(vrd::RtcEventType::kUserStopVideoCapture, payload));
 }
 
 void RtcEngineWrap::onAudioDeviceStateChanged(const char* device_id, 
     bytertc::RTCAudioDeviceType device_type, bytertc::MediaDeviceState device_state, 
     bytertc::MediaDeviceError device_error) {
-    ForwardEvent::PostEvent(this, [=, device_id = std::string(device_id)]{
-        emit sigOnAudioDeviceStateChanged(device_id, device_type, device_state,
-                                    device_error);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kAudioDeviceStateChanged, device_id, device_type, device_state, device_error);
+    if (device_type == bytertc::kRTCAudioDeviceTypeCaptureDevice) {
+        device_registry_.invalidate(vrd::DeviceKind::kAudioInput);
+    }
+    else if (device_type == bytertc::kRTCAudioDeviceTypeRenderDevice) {
+        device_registry_.invalidate(vrd::DeviceKind::kAudioOutput);
+    }
+    AudioDevicePayload payload{ device_type, device_state, device_error };
+    auto event = makeEvent(vrd::RtcEventType::kAudioDeviceStateChanged, payload);
+    event.blob = event_arena_.storeStrings({ device_id });
+    forward(std::move(event));
 }
 
 void RtcEngineWrap::onVideoDeviceStateChanged(const char* device_id,
     bytertc::RTCVideoDeviceType device_type, bytertc::MediaDeviceState device_state,
     bytertc::MediaDeviceError device_error) {
-    ForwardEvent::PostEvent(this, [=, device_id = std::string(device_id)]{
-        emit sigOnVideoDeviceStateChanged(device_id, device_type, device_state,
-                                    device_error);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kVideoDeviceStateChanged, device_id, device_type, device_state, device_error);
+    if (device_type == bytertc::kRTCVideoDeviceTypeCaptureDevice) {
+        device_registry_.invalidate(vrd::DeviceKind::kVideoCapture);
+    }
+    VideoDevicePayload payload{ device_type, device_state, device_error };
+    auto event = makeEvent(vrd::RtcEventType::kVideoDeviceStateChanged, payload);
+    event.blob = event_arena_.storeStrings({ device_id });
+    forward(std::move(event));
 }
 
 void RtcEngineWrap::onAudioPlaybackDeviceTestVolume(int volume)
 {
-    ForwardEvent::PostEvent(
-        this, [=] { emit sigOnAudioPlaybackDeviceTestVolume(volume); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kAudioPlaybackDeviceTestVolume, volume);
+    forward(makeEvent(vrd::RtcEventType::kAudioPlaybackDeviceTestVolume, volume));
 }
 
 void RtcEngineWrap::onLocalVideoStateChanged(
     bytertc::StreamIndex index, bytertc::LocalVideoStreamState state,
     bytertc::LocalVideoStreamError error) {
-    ForwardEvent::PostEvent(
-        this, [=] { emit sigOnLocalVideoStateChanged(index, state, error); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLocalVideoStateChanged, index, state, error);
+    LocalVideoStatePayload payload{ index, state, error };
+    forward(makeEvent(vrd::RtcEventType::kLocalVideoStateChanged, payload));
 }
 
 void RtcEngineWrap::onLocalAudioStateChanged(
         bytertc::LocalAudioStreamState state,
         bytertc::LocalAudioStreamError error) {
-    ForwardEvent::PostEvent(
-        this, [=] { emit sigOnLocalAudioStateChanged(state, error); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLocalAudioStateChanged, state, error);
+    LocalAudioStatePayload payload{ state, error };
+    forward(makeEvent(vrd::RtcEventType::kLocalAudioStateChanged, payload));
 }
 
 void RtcEngineWrap::onSysStats(const bytertc::SysStats& stats) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnSysStats(stats); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kSysStats, stats);
+    forward(makeEvent(vrd::RtcEventType::kSysStats, stats));
 }
 
 void RtcEngineWrap::onNetworkTypeChanged(bytertc::NetworkType type) {
-    ForwardEvent::PostEvent(this, [=]{
-        emit sigOnNetworkTypeChanged(type);
-    });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kNetworkTypeChanged, type);
+    forward(makeEvent(vrd::RtcEventType::kNetworkTypeChanged, type));
 }
 
 void RtcEngineWrap::onLoginResult(const char* uid, int error_code, int elapsed) {
-	ForwardEvent::PostEvent(this, [=, uid = std::string(uid)]{
-	emit sigOnLoginResult(uid, error_code, elapsed);
-		});
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kLoginResult, uid, error_code, elapsed);
+    LoginPayload payload{ vrd::IdTable::instance().intern(uid), error_code, elapsed };
+    forward(makeEvent(vrd::RtcEventType::kLoginResult, payload));
 }
 
 void RtcEngineWrap::onServerParamsSetResult(int error) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnServerParamsSetResult(error); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kServerParamsSetResult, error);
+    forward(makeEvent(vrd::RtcEventType::kServerParamsSetResult, error));
 }
 
 void RtcEngineWrap::onRoomMessageReceived(const char* uid, const char* message) {
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kRoomMessageReceived, uid, message);
     emitOnRTSMessageArrived(uid, message);
 }
 
 void RtcEngineWrap::onUserMessageReceived(const char* uid, const char* message) {
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserMessageReceived, uid, message);
     emitOnRTSMessageArrived(uid, message);
 }
 
 void RtcEngineWrap::onUserMessageReceivedOutsideRoom(const char* uid, const char* message) {
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kUserMessageReceivedOutsideRoom, uid, message);
     emitOnRTSMessageArrived(uid, message);
 }
 
 void RtcEngineWrap::onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) {
-    ForwardEvent::PostEvent(this, [=] { emit sigOnServerMessageSendResult(msgid, error, msg); });
+    callback_recorder_.record(t_callback_room, vrd::RecordedCallback::kServerMessageSendResult, msgid, error, msg);
+    ServerAckPayload payload{ msgid, error };
+    auto event = makeEvent(vrd::RtcEventType::kServerMessageSendResult, payload);
+    if (msg.ACKMsg && msg.length > 0) event.blob = event_arena_.store(msg.ACKMsg, msg.length);
+    forward(std::move(event));
+}
+
+void RtcRoomEventAdapter::onRoomStateChanged(
+        const char* room_id, const char* uid, int state, const char* extra_info) {
+    CallbackRoomScope scope(room_);
+    owner_.onRoomStateChanged(room_id, uid, state, extra_info);
+}
+
+void RtcRoomEventAdapter::onRoomStats(const bytertc::RtcRoomStats& stats) {
+    CallbackRoomScope scope(room_);
+    owner_.onRoomStats(stats);
+}
+
+void RtcRoomEventAdapter::onLocalStreamStats(const bytertc::LocalStreamStats& stats) {
+    CallbackRoomScope scope(room_);
+    owner_.onLocalStreamStats(stats);
+}
+
+void RtcRoomEventAdapter::onRemoteStreamStats(const bytertc::RemoteStreamStats& stats) {
+    CallbackRoomScope scope(room_);
+    owner_.onRemoteStreamStats(stats);
+}
+
+void RtcRoomEventAdapter::onLeaveRoom(const bytertc::RtcRoomStats& stats) {
+    CallbackRoomScope scope(room_);
+    owner_.onLeaveRoom(stats);
+}
+
+void RtcRoomEventAdapter::onUserJoined(const bytertc::UserInfo& userInfo, int elapsed) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserJoined(userInfo, elapsed);
+}
+
+void RtcRoomEventAdapter::onUserLeave(const char* uid, bytertc::UserOfflineReason reason) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserLeave(uid, reason);
+}
+
+void RtcRoomEventAdapter::onUserPublishStream(const char* uid, bytertc::MediaStreamType type) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserPublishStream(uid, type);
+}
+
+void RtcRoomEventAdapter::onUserUnpublishStream(const char* uid, bytertc::MediaStreamType type,
+        bytertc::StreamRemoveReason reason) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserUnpublishStream(uid, type, reason);
+}
+
+void RtcRoomEventAdapter::onUserPublishScreen(const char* uid, bytertc::MediaStreamType type) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserPublishScreen(uid, type);
+}
+
+void RtcRoomEventAdapter::onUserUnpublishScreen(const char* uid, bytertc::MediaStreamType type,
+        bytertc::StreamRemoveReason reason) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserUnpublishScreen(uid, type, reason);
+}
+
+void RtcRoomEventAdapter::onStreamSubscribed(bytertc::SubscribeState state_code,
+        const char* user_id, const bytertc::SubscribeConfig& info) {
+    CallbackRoomScope scope(room_);
+    owner_.onStreamSubscribed(state_code, user_id, info);
+}
+
+void RtcRoomEventAdapter::onStreamPublishSuccess(const char* user_id, bool is_screen) {
+    CallbackRoomScope scope(room_);
+    owner_.onStreamPublishSuccess(user_id, is_screen);
+}
+
+void RtcRoomEventAdapter::onRoomMessageReceived(const char* uid, const char* message) {
+    CallbackRoomScope scope(room_);
+    owner_.onRoomMessageReceived(uid, message);
+}
+
+void RtcRoomEventAdapter::onUserMessageReceived(const char* uid, const char* message) {
+    CallbackRoomScope scope(room_);
+    owner_.onUserMessageReceived(uid, message);
 }
@@ -1,14 +1,28 @@
 #pragma once
 #include <QCoreApplication>
 #include <QEvent>
+#include <QImage>
 #include <QObject>
 #include <QPixmap>
+#include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "core/callback_record.h"
 #include "core/common_define.h"
+#include "core/device_registry.h"
+#include "core/event_bus.h"
+#include "core/forward_event.h"
+#include "core/id_table.h"
+#include "core/latency_histogram.h"
+#include "core/rtc_event.h"
+#include "core/snapshot.h"
+#include "core/stats_register.h"
 #include "rtc/bytertc_advance.h"
 #include "rtc/bytertc_video_frame.h"
 
@@ -17,29 +31,7 @@
 #include "bytertc_video_event_handler.h"
 #include "bytertc_room_event_handler.h"
 
-/**
-* Qt custom event class, used to forward the data of the worker thread 
-*  to the main thread for processing
-*/
-class ForwardEvent : public QEvent {
-public:
-    ForwardEvent(std::function<void(void)>&& task)
-        : QEvent(User), task_(std::move(task)) {}
-    void execTask() {
-        if (task_) task_();
-    }
-    static void PostEvent(QObject* obj, std::function<void()>&& task) {
-        ForwardEvent* event = new ForwardEvent(std::move(task));
-        QCoreApplication::postEvent(obj, event);
-    }
-    std::function<void(void)> task_;
-};
-
-enum {
-    RtcDeviceTypeVideoCapture = 0,
-    RtcDeviceTypeAudioRecord,
-    RtcDeviceTypeAudioPlayout,
-};
+class QTimer;
 
 enum UserOfflineType {
     USER_OFFLINE_NORMAL,
@@ -62,24 +54,22 @@ struct RemoteStream {
     bool is_screen;
 };
 
-struct RtcDevice {
-    std::string name;
-    std::string device_id;
-    int type;
-};
-
 struct AudioVolumeInfoWrap {
     unsigned int volume;
     bytertc::StreamIndex stream_index;
-    std::string uid;
-    std::string roomId;
+    vrd::IdHandle uid = vrd::kInvalidIdHandle;
+    vrd::IdHandle room_id = vrd::kInvalidIdHandle;
     bool operator<(const AudioVolumeInfoWrap& rhs) {
         return this->volume < rhs.volume;
     }
 };
 
+// Shared read-only list of speakers, built once per report on the SDK thread
+using AudioVolumeSnapshot = vrd::Snapshot<AudioVolumeInfoWrap>;
+
 struct RemoteStreamStatsWrap {
-    std::string uid;
+    vrd::IdHandle uid;
+    vrd::IdHandle room_id = vrd::kInvalidIdHandle;
     bytertc::RemoteAudioStats audio_stats;
     bytertc::RemoteVideoStats video_stats;
     bytertc::NetworkQuality remote_tx_quality;
@@ -87,8 +77,19 @@ struct RemoteStreamStatsWrap {
     bool is_screen;
 };
 
+struct RemoteStreamStatsRecord {
+    bytertc::RemoteAudioStats audio_stats;
+    bytertc::RemoteVideoStats video_stats;
+    bytertc::NetworkQuality remote_tx_quality;
+    bytertc::NetworkQuality remote_rx_quality;
+};
+
+// A camera and a screen stream for each of the 100 people a room holds, with room to spare for sub-rooms
+constexpr size_t kMaxRemoteStreams = 256;
+using RemoteStreamStatsTable = vrd::StatsTable<RemoteStreamStatsRecord, kMaxRemoteStreams>;
+
 struct UserInfoWrap {
-    std::string uid;
+    vrd::IdHandle uid;
     std::string extra_info;
 };
 
@@ -101,11 +102,77 @@ struct MediaStreamInfoWrap {
 };
 
 struct RemoteStreamKeyWrap {
-    std::string room_id;
-    std::string user_id;
+    vrd::IdHandle room_id;
+    vrd::IdHandle user_id;
     bytertc::StreamIndex stream_index;
 };
 
+class RtcEngineWrap;
+
+/**
+* Room-scoped signals of one room, only that room's events are emitted here
+*/
+class RtcRoomChannel : public QObject {
+    Q_OBJECT
+
+public:
+    RtcRoomChannel(vrd::IdHandle room, QObject* parent = nullptr)
+        : QObject(parent), room_(room) {}
+    vrd::IdHandle room() const { return room_; }
+
+signals:
+    void sigOnRoomStateChanged(std::string room_id, std::string uid, int state, std::string extra_info);
+    void sigOnRoomStats(const bytertc::RtcRoomStats& stats);
+    void sigOnLeaveRoom(const bytertc::RtcRoomStats& stats);
+    void sigOnUserJoined(UserInfoWrap user_info, int elapsed);
+    void sigOnUserLeave(vrd::IdHandle uid, bytertc::UserOfflineReason reason);
+    void sigOnUserPublishStream(vrd::IdHandle uid, bytertc::MediaStreamType type);
+    void sigOnUserUnPublishStream(vrd::IdHandle uid,
+        bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason);
+    void sigOnUserPublishScreen(vrd::IdHandle uid, bytertc::MediaStreamType type);
+    void sigOnUserUnPublishScreen(vrd::IdHandle uid,
+        bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason);
+    void sigOnStreamSubscribed(bytertc::SubscribeState state_code,
+        vrd::IdHandle user_id, bytertc::SubscribeConfig info);
+    void sigOnStreamPublishSuccess(vrd::IdHandle user_id, bool is_screen);
+    void sigOnMessageReceived(std::string uid, std::string message);
+
+private:
+    vrd::IdHandle room_;
+};
+
+/**
+* Per-room SDK event handler, hands every callback to RtcEngineWrap tagged with the room it came from
+*/
+class RtcRoomEventAdapter : public bytertc::IRTCRoomEventHandler {
+public:
+    RtcRoomEventAdapter(RtcEngineWrap& owner, vrd::IdHandle room) : owner_(owner), room_(room) {}
+
+    void onRoomStateChanged(
+        const char* room_id, const char* uid, int state, const char* extra_info) override;
+    void onRoomStats(const bytertc::RtcRoomStats& stats) override;
+    void onLocalStreamStats(const bytertc::LocalStreamStats& stats) override;
+    void onRemoteStreamStats(const bytertc::RemoteStreamStats& stats) override;
+    void onLeaveRoom(const bytertc::RtcRoomStats& stats) override;
+    void onUserJoined(const bytertc::UserInfo& userInfo, int elapsed) override;
+    void onUserLeave(const char* uid, bytertc::UserOfflineReason reason) override;
+    void onUserPublishStream(const char* uid, bytertc::MediaStreamType type) override;
+    void onUserUnpublishStream(const char* uid, bytertc::MediaStreamType type,
+        bytertc::StreamRemoveReason reason) override;
+    void onUserPublishScreen(const char* uid, bytertc::MediaStreamType type) override;
+    void onUserUnpublishScreen(const char* uid, bytertc::MediaStreamType type,
+        bytertc::StreamRemoveReason reason) override;
+    void onStreamSubscribed(bytertc::SubscribeState state_code, const char* user_id,
+        const bytertc::SubscribeConfig& info) override;
+    void onStreamPublishSuccess(const char* user_id, bool is_screen) override;
+    void onRoomMessageReceived(const char* uid, const char* message) override;
+    void onUserMessageReceived(const char* uid, const char* message) override;
+
+private:
+    RtcEngineWrap& owner_;
+    const vrd::IdHandle room_;
+};
+
  /**
   * ByteRTC interface wrapper and callback receiving class, applicable to all scenarios
   * Note that for the specific meaning of related interfaces and callbacks, please refer to the definition of RTC native interface directly
@@ -132,11 +199,19 @@ public:
 	int initDevices();
 	void resetDevices();
 
+	// Creates the room and its event adapter, returns the existing room if it was already created
 	std::shared_ptr<bytertc::IRTCRoom> createRtcRoom(const std::string& room_id);
 	int destoryRtcRoom(const std::string& room_id);
+	// Handle of the room passed to joinRoom, kInvalidIdHandle before the first join
+	vrd::IdHandle mainRoom() const;
+	// Room-scoped signals of a created room, nullptr if the room does not exist.
+	// The channel is deleted together with the room
+	RtcRoomChannel* roomChannel(vrd::IdHandle room) const;
+	// ManualSubscribeMode keeps audio auto-subscribed and leaves remote video to subscribeVideoStream
 	int joinRoom(const std::string& token, const std::string& room_id,
 		const bytertc::UserInfo& userInfo,
-		bytertc::RoomProfileType profileType);
+		bytertc::RoomProfileType profileType,
+		SubscribeMode subscribeMode = AutoSubscribeMode);
 
 	int setUserRole(bytertc::UserRoleType role);
 	int setRemoteVideoCanvas(const std::string& user_id,
@@ -160,16 +235,23 @@ public:
 
     int subscribeVideoStream(const std::string& uid,
         const bytertc::SubscribeConfig& config);
-    int unSubscribeVideoStream(const std::string& uid, bool is_screen);
+    int unSubscribeVideoStream(const std::string& uid, bool is_screen,
+        bytertc::MediaStreamType type = bytertc::MediaStreamType::kMediaStreamTypeBoth);
 
     int enableSimulcastMode(bool enabled);
 	int setVideoProfiles(const bytertc::VideoEncoderConfig& config);
+	// Simulcast ladder, best layer first, needs enableSimulcastMode(true) before the room is joined
+	int setVideoProfiles(const std::vector<bytertc::VideoEncoderConfig>& layers);
     int setAudioProfiles(bytertc::AudioProfileType type);
 	int setScreenProfiles(const bytertc::ScreenVideoEncoderConfig& config);
 
 	int getShareList(std::vector<SnapshotAttr>& list);
 	QPixmap getThumbnail(SnapshotAttr::SnapshotType type, void* source_id,
 		int max_width, int max_height);
+	// Any thread, QPixmap can only be made on the UI thread. The SDK capture runs one at a time,
+	// only the conversion of the captured frame runs in parallel
+	QImage getThumbnailImage(SnapshotAttr::SnapshotType type, void* source_id,
+		int max_width, int max_height);
 
     int getAudioInputDevices(std::vector<RtcDevice>&);
     int setAudioInputDevice(int index);
@@ -187,6 +269,7 @@ public:
     int getCurrentVideoCaptureDeviceIndex();
 
     void followSystemCaptureDevice(bool enabled);
+    vrd::DeviceRegistry::Stats deviceRegistryStats() const;
 
     int enableEffectBeauty(bool enabled);
     int setBeautyIntensity(bytertc::EffectBeautyMode beauty_mode, float intensity);
@@ -205,47 +288,80 @@ public:
     std::unique_ptr<bytertc::IRTCVideo, std::function<void(bytertc::IRTCVideo*)>>&
         getRtcEngine();
 
+    // Queue depth, drop and shed counters of the SDK-to-UI callback bus
+    vrd::EventBusBase::Stats eventBusStats() const;
+    // Telemetry events of one type shed or coalesced away before reaching the UI
+    uint64_t eventShedCount(vrd::RtcEventType type) const;
+    // Blob usage of in-flight callback events, heap_fallbacks should stay flat in steady state
+    vrd::BlobArena::Stats eventArenaStats() const;
+    // Time from entering an SDK callback to its signal firing on the UI thread
+    vrd::LatencyHistogram::Summary eventLatency(vrd::RtcEventType type) const;
+    void resetEventLatency();
+    // Writes the latency summary of every event type seen so far to the log
+    void dumpEventLatency() const;
+
+    // Appends every SDK callback with its arguments to a binary file until stopped
+    bool startCallbackRecording(const std::string& path);
+    void stopCallbackRecording();
+    // Feeds a recording back through the SDK callbacks on the calling thread, run it on a
+    // worker thread to reproduce SDK threading. Not meant to be mixed with a live engine.
+    // Room callbacks go to the handlers of the rooms open when it starts, keep them open until it returns
+    vrd::CallbackPlayer::Result replayCallbackRecording(const std::string& path,
+        vrd::CallbackPlayer::Pace pace);
+
+    // Stream stats are not forwarded per report, the SDK thread overwrites the latest value
+    // and the UI pulls whatever changed at its own refresh rate
+    // Only reports of the given room are passed to fn, kInvalidIdHandle selects the main room
+    size_t collectRemoteStreamStats(RemoteStreamStatsTable::Cursor& cursor,
+        const std::function<void(const RemoteStreamStatsWrap&)>& fn,
+        vrd::IdHandle room = vrd::kInvalidIdHandle) const;
+    bool latestLocalStreamStats(bool is_screen, bytertc::LocalStreamStats& stats,
+        uint64_t* version = nullptr) const;
+
 protected:
     void customEvent(QEvent* e) override;
-    std::shared_ptr<bytertc::IRTCRoom> getRtcRoom(const std::string& room_id);
+    bool forward(vrd::RtcEvent&& event);
+    void dispatch(vrd::RtcEvent& event);
+    void discard(vrd::RtcEvent& event);
+    bool eraseRoom(vrd::IdHandle room);
+    // Lookups never create a room, rooms only come from createRtcRoom
+    std::shared_ptr<bytertc::IRTCRoom> getRtcRoom(vrd::IdHandle room) const;
+    std::shared_ptr<bytertc::IRTCRoom> getRtcRoom(const std::string& room_id) const;
 
 signals:
     void sigOnRoomStateChanged(std::string room_id, std::string uid, int state, std::string extra_info);
-    void sigOnRoomStats(bytertc::RtcRoomStats stats);
-    void sigOnLocalStreamStats(bytertc::LocalStreamStats stats);
-    void sigOnRemoteStreamStats(RemoteStreamStatsWrap stats);
+    void sigOnRoomStats(const bytertc::RtcRoomStats& stats);
     void sigOnWarning(int warn);
     void sigOnError(int err);
-    void sigOnRemoteAudioVolumeIndication(std::vector<AudioVolumeInfoWrap> speakers,
-        int totalVolume);
-    void sigOnLocalAudioVolumeIndication(std::vector<AudioVolumeInfoWrap> speakers);
-    void sigOnLeaveRoom(bytertc::RtcRoomStats stats);
+    void sigOnRemoteAudioVolumeIndication(AudioVolumeSnapshot speakers, int totalVolume);
+    void sigOnLocalAudioVolumeIndication(AudioVolumeSnapshot speakers);
+    void sigOnLeaveRoom(const bytertc::RtcRoomStats& stats);
     void sigOnUserJoined(UserInfoWrap user_info,int elapsed);
-    void sigOnUserLeave(std::string uid, bytertc::UserOfflineReason reason);
-    void sigOnUserStartAudioCapture(std::string roomId, std::string uid);
-    void sigOnUserStopAudioCapture(std::string roomId, std::string uid);
+    void sigOnUserLeave(vrd::IdHandle uid, bytertc::UserOfflineReason reason);
+    void sigOnUserStartAudioCapture(vrd::IdHandle room_id, vrd::IdHandle uid);
+    void sigOnUserStopAudioCapture(vrd::IdHandle room_id, vrd::IdHandle uid);
     
 
     void sigOnFirstLocalAudioFrame(bytertc::StreamIndex index);
     void sigOnLogReport(std::string log_type, std::string log_content);
 
-    void sigOnUserPublishStream(const std::string& uid, bytertc::MediaStreamType type);
-    void sigOnUserUnPublishStream(const std::string& uid, 
+    void sigOnUserPublishStream(vrd::IdHandle uid, bytertc::MediaStreamType type);
+    void sigOnUserUnPublishStream(vrd::IdHandle uid, 
         bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason);
-    void sigOnUserPublishScreen(std::string uid, bytertc::MediaStreamType type);
-    void sigOnUserUnPublishScreen(std::string uid,
+    void sigOnUserPublishScreen(vrd::IdHandle uid, bytertc::MediaStreamType type);
+    void sigOnUserUnPublishScreen(vrd::IdHandle uid,
         bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason);
     void sigOnStreamSubscribed(bytertc::SubscribeState state_code,
-                                std::string user_id,
+                                vrd::IdHandle user_id,
                                 bytertc::SubscribeConfig info);
-    void sigOnStreamPublishSuccess(std::string user_id, bool is_screen);
+    void sigOnStreamPublishSuccess(vrd::IdHandle user_id, bool is_screen);
     void sigOnFirstLocalVideoFrameCaptured(bytertc::StreamIndex index,
                                             bytertc::VideoFrameInfo info);
     void sigOnFirstRemoteVideoFrameDecoded(RemoteStreamKeyWrap key,
                                             bytertc::VideoFrameInfo info);
 
-    void sigOnUserStartVideoCapture(const std::string& roomId, const std::string& userId);
-    void sigOnUserStopVideoCapture(const std::string& roomId, const std::string& userId);
+    void sigOnUserStartVideoCapture(vrd::IdHandle room_id, vrd::IdHandle user_id);
+    void sigOnUserStopVideoCapture(vrd::IdHandle room_id, vrd::IdHandle user_id);
     void sigOnAudioDeviceStateChanged(
         const std::string& device_id, bytertc::RTCAudioDeviceType device_type, 
         bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError device_error);
@@ -260,8 +376,10 @@ signals:
                                     bytertc::LocalAudioStreamError error);
 
     void sigOnAudioPlaybackDeviceTestVolume(int volume);
+    // A device list was re-enumerated after a device change and differs from the previous one
+    void sigOnDeviceListChanged(vrd::DeviceKind kind);
 
-    void sigOnSysStats(bytertc::SysStats stats);
+    void sigOnSysStats(const bytertc::SysStats& stats);
     void sigOnNetworkTypeChanged(bytertc::NetworkType type);
 
     //RTS
@@ -331,10 +449,20 @@ public:
     void onServerMessageSendResult(int64_t msgid, int error, const bytertc::ServerACKMsg& msg) override;
 
 protected:
+    struct RoomEntry {
+        // Declared before room so the room is destroyed, and stops calling back, first
+        std::unique_ptr<RtcRoomEventAdapter> adapter;
+        std::shared_ptr<bytertc::IRTCRoom> room;
+        RtcRoomChannel* channel = nullptr;
+    };
+
     std::string room_id_ = "";
+    // Read on SDK threads to tell main room callbacks from sub-room ones
+    std::atomic<vrd::IdHandle> main_room_{ vrd::kInvalidIdHandle };
     std::unique_ptr<bytertc::IRTCVideo,
         std::function<void(bytertc::IRTCVideo*)>> video_engine_;
-    std::unordered_map<std::string, std::shared_ptr<bytertc::IRTCRoom>> rooms_;
+    // UI thread only
+    std::unordered_map<vrd::IdHandle, RoomEntry> rooms_;
 
     std::unique_ptr<bytertc::IVideoDeviceManager,
         std::function<void(bytertc::IVideoDeviceManager*)>>
@@ -342,10 +470,16 @@ protected:
     std::unique_ptr<bytertc::IAudioDeviceManager,
         std::function<void(bytertc::IAudioDeviceManager*)>>
         audio_device_manager_;
-    std::vector<RtcDevice> audio_input_devices_;
-    int current_audio_input_idx_ = -1;
-    std::vector<RtcDevice> audio_output_devices_;
-    int current_audio_output_idx_ = -1;
-    std::vector<RtcDevice> camera_devices_;
-    int current_camera_idx_ = -1;
+    vrd::DeviceRegistry device_registry_;
+    // IRTCVideo::getThumbnail is not documented as thread-safe, pool threads take turns calling it
+    std::mutex thumbnail_mutex_;
+    vrd::CallbackRecorder callback_recorder_;
+    vrd::BlobArena event_arena_;
+    vrd::PriorityEventBus<vrd::RtcEvent> event_bus_;
+    std::array<std::atomic<uint64_t>, vrd::kRtcEventTypeCount> event_shed_{};
+    std::array<vrd::LatencyHistogram, vrd::kRtcEventTypeCount> event_latency_;
+    static constexpr int kLatencyDumpInterval = 60 * 1000;
+    QTimer* latency_dump_timer_ = nullptr;
+    RemoteStreamStatsTable remote_stream_stats_;
+    vrd::LatestValue<bytertc::LocalStreamStats> local_stream_stats_[2];
 };
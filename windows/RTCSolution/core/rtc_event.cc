@@ -0,0 +1,155 @@
+#include "rtc_event.h"
+
+namespace vrd {
+
+const char* rtcEventTypeName(RtcEventType type) {
+    static const char* const kNames[kRtcEventTypeCount] = {
+        "None",
+        "RoomStateChanged",
+        "RoomStats",
+        "Warning",
+        "Error",
+        "RemoteAudioVolume",
+        "LocalAudioVolume",
+        "LeaveRoom",
+        "UserJoined",
+        "UserLeave",
+        "UserStartAudioCapture",
+        "UserStopAudioCapture",
+        "FirstLocalAudioFrame",
+        "LogReport",
+        "UserPublishStream",
+        "UserUnpublishStream",
+        "UserPublishScreen",
+        "UserUnpublishScreen",
+        "StreamSubscribed",
+        "StreamPublishSuccess",
+        "FirstLocalVideoFrameCaptured",
+        "FirstRemoteVideoFrameDecoded",
+        "UserStartVideoCapture",
+        "UserStopVideoCapture",
+        "AudioDeviceStateChanged",
+        "VideoDeviceStateChanged",
+        "AudioPlaybackDeviceTestVolume",
+        "LocalVideoStateChanged",
+        "LocalAudioStateChanged",
+        "SysStats",
+        "NetworkTypeChanged",
+        "LoginResult",
+        "ServerParamsSetResult",
+        "MessageReceived",
+        "ServerMessageSendResult",
+    };
+    auto idx = static_cast<size_t>(type);
+    return idx < kRtcEventTypeCount ? kNames[idx] : "Unknown";
+}
+
+bool isRtcTelemetryEvent(RtcEventType type) {
+    switch (type) {
+    case RtcEventType::kRoomStats:
+    case RtcEventType::kRemoteAudioVolume:
+    case RtcEventType::kLocalAudioVolume:
+    case RtcEventType::kLogReport:
+    case RtcEventType::kAudioPlaybackDeviceTestVolume:
+    case RtcEventType::kSysStats:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int rtcEventCoalesceKey(const RtcEvent& event) {
+    // Every log line is distinct, the other reports are replaced wholesale by the next one.
+    // Room-scoped reports only replace reports of the same room, they are rare enough to keep them all
+    if (event.type == RtcEventType::kLogReport || event.room != 0
+        || !isRtcTelemetryEvent(event.type)) {
+        return -1;
+    }
+    return static_cast<int>(event.type);
+}
+
+BlobArena::BlobArena(size_t block_count, size_t block_size)
+    : block_count_(block_count),
+      block_size_(block_size),
+      storage_(new char[block_count * block_size]),
+      free_blocks_(block_count) {}
+
+BlobArena::~BlobArena() = default;
+
+BlobRef BlobArena::store(const void* data, size_t size) {
+    BlobRef ref;
+    auto dst = allocate(size, ref);
+    if (dst && size) memcpy(dst, data, size);
+    return ref;
+}
+
+BlobRef BlobArena::storeStrings(std::initializer_list<const char*> strs) {
+    size_t size = 0;
+    for (auto str : strs) {
+        size += (str ? strlen(str) : 0) + 1;
+    }
+    BlobRef ref;
+    auto dst = allocate(size, ref);
+    for (auto str : strs) {
+        auto len = str ? strlen(str) : 0;
+        if (len) memcpy(dst, str, len);
+        dst[len] = '\0';
+        dst += len + 1;
+    }
+    return ref;
+}
+
+const char* BlobArena::data(const BlobRef& ref) const {
+    if (ref.heap) return ref.heap;
+    if (ref.block == BlobRef::kNoBlock) return nullptr;
+    return storage_.get() + ref.block * block_size_;
+}
+
+const char* BlobArena::string(const BlobRef& ref, size_t index) const {
+    auto str = data(ref);
+    if (!str) return "";
+    auto end = str + ref.size;
+    for (; index > 0 && str < end; index--) {
+        str += strlen(str) + 1;
+    }
+    return str < end ? str : "";
+}
+
+void BlobArena::release(BlobRef& ref) {
+    if (ref.heap) {
+        delete[] ref.heap;
+    }
+    else if (ref.block != BlobRef::kNoBlock) {
+        free_blocks_.push(ref.block);
+        in_use_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    ref = BlobRef();
+}
+
+BlobArena::Stats BlobArena::stats() const {
+    Stats s;
+    s.block_count = block_count_;
+    s.block_size = block_size_;
+    s.in_use = in_use_.load(std::memory_order_relaxed);
+    s.heap_fallbacks = heap_fallbacks_.load(std::memory_order_relaxed);
+    return s;
+}
+
+char* BlobArena::allocate(size_t size, BlobRef& ref) {
+    ref = BlobRef();
+    if (size == 0) return nullptr;
+    ref.size = static_cast<uint32_t>(size);
+    if (size <= block_size_) {
+        auto block = free_blocks_.pop();
+        if (block != IndexFreeList::kEmpty) {
+            in_use_.fetch_add(1, std::memory_order_relaxed);
+            ref.block = block;
+            return storage_.get() + block * block_size_;
+        }
+    }
+    heap_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    ref.heap = new char[size];
+    return ref.heap;
+}
+
+}  // namespace vrd
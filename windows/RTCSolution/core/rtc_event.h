@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+
+#include "core/index_free_list.h"
+
+namespace vrd {
+
+enum class RtcEventType : uint16_t {
+    kNone = 0,
+    kRoomStateChanged,
+    kRoomStats,
+    kWarning,
+    kError,
+    kRemoteAudioVolume,
+    kLocalAudioVolume,
+    kLeaveRoom,
+    kUserJoined,
+    kUserLeave,
+    kUserStartAudioCapture,
+    kUserStopAudioCapture,
+    kFirstLocalAudioFrame,
+    kLogReport,
+    kUserPublishStream,
+    kUserUnpublishStream,
+    kUserPublishScreen,
+    kUserUnpublishScreen,
+    kStreamSubscribed,
+    kStreamPublishSuccess,
+    kFirstLocalVideoFrameCaptured,
+    kFirstRemoteVideoFrameDecoded,
+    kUserStartVideoCapture,
+    kUserStopVideoCapture,
+    kAudioDeviceStateChanged,
+    kVideoDeviceStateChanged,
+    kAudioPlaybackDeviceTestVolume,
+    kLocalVideoStateChanged,
+    kLocalAudioStateChanged,
+    kSysStats,
+    kNetworkTypeChanged,
+    kLoginResult,
+    kServerParamsSetResult,
+    kMessageReceived,
+    kServerMessageSendResult,
+    kCount,
+};
+
+static constexpr size_t kRtcEventTypeCount = static_cast<size_t>(RtcEventType::kCount);
+
+const char* rtcEventTypeName(RtcEventType type);
+
+// High-rate periodic reports, forwarded on the low-priority lane and shed under backpressure
+bool isRtcTelemetryEvent(RtcEventType type);
+
+// Variable-length bytes attached to an event, owned by the BlobArena that created it
+struct BlobRef {
+    static constexpr uint32_t kNoBlock = 0xffffffffu;
+
+    uint32_t block = kNoBlock;
+    uint32_t size = 0;
+    // Set instead of block when the payload did not fit the arena
+    char* heap = nullptr;
+};
+
+/**
+* Fixed pool of equally sized blocks recycled through a lock-free free list
+* Holds the strings and arrays of in-flight events so that forwarding a callback does not touch the heap,
+* payloads larger than a block or arriving while every block is in flight fall back to the heap and are counted
+*/
+class BlobArena {
+public:
+    struct Stats {
+        size_t block_count = 0;
+        size_t block_size = 0;
+        size_t in_use = 0;
+        uint64_t heap_fallbacks = 0;
+    };
+
+    explicit BlobArena(size_t block_count = 1024, size_t block_size = 2048);
+    BlobArena(const BlobArena&) = delete;
+    BlobArena& operator=(const BlobArena&) = delete;
+    ~BlobArena();
+
+    // Any thread, returns writable storage for size bytes described by ref
+    char* allocate(size_t size, BlobRef& ref);
+    // Any thread
+    BlobRef store(const void* data, size_t size);
+    // Any thread, packs NUL-terminated strings back to back, a null string is stored empty
+    BlobRef storeStrings(std::initializer_list<const char*> strs);
+    const char* data(const BlobRef& ref) const;
+    // index-th string of a blob written by storeStrings
+    const char* string(const BlobRef& ref, size_t index) const;
+    // Any thread, resets ref
+    void release(BlobRef& ref);
+    Stats stats() const;
+
+private:
+    const size_t block_count_;
+    const size_t block_size_;
+    std::unique_ptr<char[]> storage_;
+    IndexFreeList free_blocks_;
+    std::atomic<size_t> in_use_{ 0 };
+    std::atomic<uint64_t> heap_fallbacks_{ 0 };
+};
+
+/**
+* Tagged SDK callback record
+* The fixed payload holds a trivially copyable struct chosen by type, strings and arrays go to a blob
+*/
+struct RtcEvent {
+    static constexpr size_t kPayloadSize = 256;
+
+    RtcEventType type = RtcEventType::kNone;
+    // Steady clock time at which the SDK callback was entered
+    uint64_t timestamp_ns = 0;
+    // Interned id of the room whose event handler received the callback, 0 for engine-wide callbacks
+    uint32_t room = 0;
+    BlobRef blob;
+    alignas(8) unsigned char payload[kPayloadSize];
+
+    template <typename P>
+    void setPayload(const P& value) {
+        static_assert(std::is_trivially_copyable<P>::value, "event payload must be trivially copyable");
+        static_assert(sizeof(P) <= kPayloadSize, "event payload does not fit RtcEvent");
+        memcpy(payload, &value, sizeof(P));
+    }
+
+    template <typename P>
+    P payloadAs() const {
+        static_assert(std::is_trivially_copyable<P>::value, "event payload must be trivially copyable");
+        static_assert(sizeof(P) <= kPayloadSize, "event payload does not fit RtcEvent");
+        P value;
+        memcpy(&value, payload, sizeof(P));
+        return value;
+    }
+};
+
+// Telemetry events with the same key carry the same state and only the newest one needs dispatching,
+// returns -1 for events that must all be delivered
+int rtcEventCoalesceKey(const RtcEvent& event);
+
+}  // namespace vrd
@@ -1,4 +1,5 @@
 ﻿#include "session_base.h"
+#include "session_message.h"
 #include "feature/data_mgr.h"
 #include "application.h"
 #include "util_error.h"
@@ -14,9 +15,6 @@
 #include <QJsonDocument>
 
 namespace vrd {
-static const QString MESSAGE_TYPE_RETURN = "return";
-static const QString MESSAGE_TYPE_INFORM = "inform";
-
 void SessionBase::registerThis() {
 	VRD_FUNC_RIGESTER_COMPONET(vrd::SessionBase, SessionBase);
 }
@@ -164,20 +162,17 @@ void SessionBase::_emitMessage(CSTRING_REF_PARAM name, const QJsonObject& conten
 		content["login_token"] = QString::fromStdString(token_);
 	}
 	
-	QJsonObject message;
-	auto res_info = vrd::DataMgr::instance().rts_info();
-	message["app_id"] =  QString::fromStdString(res_info.app_id);
-	message["room_id"] = QString::fromStdString(room_id_);
-	message["user_id"] = QString::fromStdString(user_id_);
-	message["event_name"] = QString::fromStdString(name);
-	QJsonDocument contentDoc(content);
-	message["content"] = QString(contentDoc.toJson(QJsonDocument::Indented));;
-	auto requestId = QString::fromStdString(util::newUuid());
-	message["request_id"] = requestId;
-	message["device_id"] =  QString::fromStdString(util::machineUuid());
+	session_message::Request request;
+	request.app_id = vrd::DataMgr::instance().rts_info().app_id;
+	request.room_id = room_id_;
+	request.user_id = user_id_;
+	request.event_name = name;
+	request.request_id = QString::fromStdString(util::newUuid());
+	request.device_id = util::machineUuid();
+	auto message = session_message::buildRequest(request, content);
+	auto requestId = request.request_id;
 	qDebug()<< "sendServerMessage eventName:" << name.c_str() << "message: "<< message;
-	auto messageStr = QString(QJsonDocument(message).toJson());
-	auto messageStdString = std::string(messageStr.toUtf8());
+	auto messageStdString = session_message::encode(message);
 	if (const auto& engine = RtcEngineWrap::instance().getRtcEngine())
 	{
 		auto msgId = engine->sendServerMessage(messageStdString.c_str());
@@ -203,12 +198,11 @@ void SessionBase::onServerMessageSendResult(int64_t msgid, int error, const byte
 * Received RTS business request callback message or notification message, and parsed
 */
 void SessionBase::onMessageReceived(const std::string& uid, const std::string& message) {
-	auto messageByteArray = QByteArray(message.data(), static_cast<int>(message.size()));
-	auto messageJsonObj = QJsonDocument::fromJson(messageByteArray).object();
+	auto incoming = session_message::parse(message);
+	const auto& messageJsonObj = incoming.message;
 	qDebug()<<"SessionBase::onMessageReceived: "<< messageJsonObj;
-	auto messageType = messageJsonObj["message_type"].toString();
-	if(messageType == vrd::MESSAGE_TYPE_RETURN) {
-		auto requestId = messageJsonObj["request_id"].toString();
+	if (incoming.type == session_message::Incoming::kReturn) {
+		const auto& requestId = incoming.request_id;
 		if (!requestId.isEmpty()) {
 			if (callback_with_requsetId_.count(requestId) == 0) {
 				qWarning()<<"cannot find the callback with requestId: "<< requestId;
@@ -242,17 +236,16 @@ void SessionBase::onMessageReceived(const std::string& uid, const std::string& m
 			callback_with_requsetId_.erase(requestId);
 		}
 	}
-	else if(messageType == vrd::MESSAGE_TYPE_INFORM) {
-		auto eventName = messageJsonObj["event"].toString();
-		if(!eventName.isEmpty()) {
-			auto eventNameStr = std::string(eventName.toUtf8());
+	else if (incoming.type == session_message::Incoming::kInform) {
+		const auto& eventNameStr = incoming.event_name;
+		if(!eventNameStr.empty()) {
 			if (event_listeners_.count(eventNameStr) == 0)
 			{
-				qWarning()<<"cannot find the event listener with event name: "<< eventName;
+				qWarning()<<"cannot find the event listener with event name: "<< eventNameStr.c_str();
 				return;
 			}
 			auto eventListener = event_listeners_[eventNameStr];
-			auto dataJsonObj = messageJsonObj["data"].toObject();
+			const auto& dataJsonObj = incoming.data;
 			_emitCallback([this, eventListener, dataJsonObj]() {
 				if (eventListener) {
 					eventListener(dataJsonObj);
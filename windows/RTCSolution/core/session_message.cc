@@ -0,0 +1,49 @@
+#include "session_message.h"
+
+#include <QByteArray>
+#include <QJsonDocument>
+
+namespace vrd {
+namespace session_message {
+
+static const QString MESSAGE_TYPE_RETURN = "return";
+static const QString MESSAGE_TYPE_INFORM = "inform";
+
+QJsonObject buildRequest(const Request& request, const QJsonObject& content) {
+    QJsonObject message;
+    message["app_id"] = QString::fromStdString(request.app_id);
+    message["room_id"] = QString::fromStdString(request.room_id);
+    message["user_id"] = QString::fromStdString(request.user_id);
+    message["event_name"] = QString::fromStdString(request.event_name);
+    QJsonDocument contentDoc(content);
+    message["content"] = QString(contentDoc.toJson(QJsonDocument::Indented));
+    message["request_id"] = request.request_id;
+    message["device_id"] = QString::fromStdString(request.device_id);
+    return message;
+}
+
+std::string encode(const QJsonObject& message) {
+    // toJson() is already UTF-8, no round trip through QString
+    auto bytes = QJsonDocument(message).toJson();
+    return std::string(bytes.constData(), static_cast<size_t>(bytes.size()));
+}
+
+Incoming parse(const std::string& text) {
+    Incoming incoming;
+    auto bytes = QByteArray::fromRawData(text.data(), static_cast<int>(text.size()));
+    incoming.message = QJsonDocument::fromJson(bytes).object();
+    auto messageType = incoming.message.value("message_type").toString();
+    if (messageType == MESSAGE_TYPE_RETURN) {
+        incoming.type = Incoming::kReturn;
+        incoming.request_id = incoming.message.value("request_id").toString();
+    }
+    else if (messageType == MESSAGE_TYPE_INFORM) {
+        incoming.type = Incoming::kInform;
+        incoming.event_name = std::string(incoming.message.value("event").toString().toUtf8());
+        incoming.data = incoming.message.value("data").toObject();
+    }
+    return incoming;
+}
+
+}  // namespace session_message
+}  // namespace vrd
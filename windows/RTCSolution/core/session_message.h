@@ -0,0 +1,46 @@
+#pragma once
+#include <QJsonObject>
+#include <QString>
+#include <string>
+
+namespace vrd {
+
+/**
+* Wire format of the RTS business messages, kept free of engine and session state so it can be benchmarked
+*/
+namespace session_message {
+
+struct Request {
+    std::string app_id;
+    std::string room_id;
+    std::string user_id;
+    std::string event_name;
+    QString request_id;
+    std::string device_id;
+};
+
+// The message object that is logged and kept until the send result arrives
+QJsonObject buildRequest(const Request& request, const QJsonObject& content);
+// UTF-8 text handed to sendServerMessage
+std::string encode(const QJsonObject& message);
+
+struct Incoming {
+    enum Type {
+        kUnknown,
+        // Answer to a request, request_id is set
+        kReturn,
+        // Server notification, event_name is set and data holds its payload
+        kInform,
+    };
+
+    Type type = kUnknown;
+    QJsonObject message;
+    QString request_id;
+    std::string event_name;
+    QJsonObject data;
+};
+
+Incoming parse(const std::string& text);
+
+}  // namespace session_message
+}  // namespace vrd
@@ -0,0 +1,117 @@
+#include "simulcast_layers.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace vrd {
+
+namespace {
+
+std::vector<PublishTier>& tiers() {
+    static std::vector<PublishTier> tiers = {
+        { 2, { { 1280, 720, 15, 1200 }, { 640, 360, 15, 500 }, { 320, 180, 15, 150 } } },
+        { 4, { { 960, 540, 15, 800 }, { 640, 360, 15, 500 }, { 320, 180, 15, 150 } } },
+        { INT_MAX, { { 640, 360, 15, 500 }, { 480, 270, 15, 300 }, { 320, 180, 15, 150 } } },
+    };
+    return tiers;
+}
+
+// Percentages, a layer serves tiles up to 125% of its height and is only left for a smaller one below 125/120 of it
+const int kMaxUpscale = 125;
+const int kDownMargin = 120;
+
+bool fits(int required, const SimulcastLayer& layer, int margin) {
+    return required * margin <= layer.height * kMaxUpscale;
+}
+
+// What every layer taller than the camera is published as, layers are best first
+SimulcastLayer capLayer(const std::vector<SimulcastLayer>& layers, int max_height) {
+    auto same = std::find_if(layers.begin(), layers.end(),
+        [max_height](const SimulcastLayer& layer) { return layer.height == max_height; });
+    if (same != layers.end()) return *same;
+    auto layer = layers.front();
+    for (const auto& taller : layers) {
+        if (taller.height > max_height) layer = taller;
+    }
+    // The closest taller layer scaled down, bitrate in proportion to the pixels
+    SimulcastLayer capped = layer;
+    capped.height = max_height;
+    capped.width = layer.width * max_height / layer.height;
+    capped.max_kbps = static_cast<int>(static_cast<int64_t>(layer.max_kbps) * max_height * max_height /
+        (static_cast<int64_t>(layer.height) * layer.height));
+    capped.max_kbps = std::max(capped.max_kbps, 1);
+    return capped;
+}
+
+}  // namespace
+
+int SimulcastLayers::requiredHeight(int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    return std::max(height, width * 9 / 16);
+}
+
+int SimulcastLayers::select(int participants, int width, int height, int current) {
+    const auto& layers = tierLayers(participants);
+    const int lowest = layerCount(participants) - 1;
+    if (lowest <= 0) return 0;
+    int required = requiredHeight(width, height);
+    int target = lowest;
+    while (target > 0 && !fits(required, layers[target], 100)) {
+        target--;
+    }
+    if (current < 0 || current > lowest || target <= current) {
+        return target;
+    }
+    // Shrinking, step down only as far as the margin allows
+    for (int index = target; index > current; index--) {
+        if (fits(required, layers[index], kDownMargin)) return index;
+    }
+    return current;
+}
+
+void SimulcastLayers::setPublishTiers(std::vector<PublishTier> publish_tiers) {
+    if (publish_tiers.empty()) return;
+    tiers() = std::move(publish_tiers);
+}
+
+const std::vector<PublishTier>& SimulcastLayers::publishTiers() {
+    return tiers();
+}
+
+size_t SimulcastLayers::publishTier(int participants) {
+    const auto& all = tiers();
+    for (size_t index = 0; index + 1 < all.size(); index++) {
+        if (participants <= all[index].max_participants) return index;
+    }
+    return all.size() - 1;
+}
+
+const std::vector<SimulcastLayer>& SimulcastLayers::tierLayers(int participants) {
+    return tiers()[publishTier(participants)].layers;
+}
+
+int SimulcastLayers::layerCount(int participants) {
+    // publishLadder keeps every layer of the tier
+    return static_cast<int>(tierLayers(participants).size());
+}
+
+std::vector<SimulcastLayer> SimulcastLayers::publishLadder(int participants, int max_height) {
+    const auto& layers = tierLayers(participants);
+    std::vector<SimulcastLayer> ladder;
+    if (layers.empty()) return ladder;
+    const auto capped = max_height > 0 ? capLayer(layers, max_height) : SimulcastLayer();
+    // Subscribers pick video_index out of the tier, so a capped layer repeats a smaller picture rather than
+    // leaving the ladder short and shifting every index after it
+    for (const auto& layer : layers) {
+        if (max_height <= 0 || layer.height <= max_height) {
+            ladder.push_back(layer);
+        }
+        else {
+            ladder.push_back(capped);
+        }
+    }
+    return ladder;
+}
+
+}  // namespace vrd
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace vrd {
+
+// One encoded resolution of a simulcast camera stream
+struct SimulcastLayer {
+    int width;
+    int height;
+    int fps;
+    int max_kbps;
+};
+
+// The ladder published while the room has at most max_participants people, best layer first
+struct PublishTier {
+    int max_participants;
+    std::vector<SimulcastLayer> layers;
+};
+
+/**
+* The simulcast ladder the camera is published with and the subscriber-side choice of layer
+* Layer 0 is the best one, as SubscribeVideoConfig::video_index counts. Both sides read the same tier table and
+* every publisher sends layerCount() layers for the current room size, a camera below a layer repeats a smaller
+* picture there, so the subscriber indexes the ladder the publisher sends. A tile is given the
+* smallest layer it does not have to upscale by more than a quarter; it moves up as soon as it grows past that,
+* but only moves down once it is a further fifth smaller, so a tile resized around a boundary does not flap.
+* The publisher lowers its top layer as the room grows since tiles shrink with it, see publishLadder()
+*/
+class SimulcastLayers {
+public:
+    // Source height a tile of width x height physical pixels needs, the view crops a 16:9 source to fill it
+    static int requiredHeight(int width, int height);
+    // Layer of the ladder a room of participants people publishes, current is the layer subscribed so far,
+    // -1 when nothing is subscribed yet. Always below layerCount(participants)
+    static int select(int participants, int width, int height, int current = -1);
+
+    // Sorted by max_participants, the last tier also covers larger rooms. UI thread only
+    static void setPublishTiers(std::vector<PublishTier> tiers);
+    static const std::vector<PublishTier>& publishTiers();
+    // Index of the tier a room of participants people publishes with
+    static size_t publishTier(int participants);
+    // Layers of that tier before any camera cap, best first
+    static const std::vector<SimulcastLayer>& tierLayers(int participants);
+    // Length of the ladder every publisher sends in a room of participants people
+    static int layerCount(int participants);
+    // Layers of that tier capped at max_height, always as many as the tier has so subscribers can index it.
+    // A taller layer becomes the tier's layer of exactly that height if it has one, else it is scaled down to it.
+    // max_height <= 0 keeps the tier
+    static std::vector<SimulcastLayer> publishLadder(int participants, int max_height);
+};
+
+}  // namespace vrd
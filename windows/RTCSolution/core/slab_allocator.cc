@@ -0,0 +1,440 @@
+#include "slab_allocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace vrd {
+
+namespace {
+
+// 16, 32 ... 128, then four classes per power of two up to 64 MB
+constexpr int kLinearClasses = 8;
+constexpr int kLinearStep = 16;
+constexpr int kFirstShift = 7;
+constexpr int kLastShift = 25;
+constexpr int kClassCount = kLinearClasses + (kLastShift - kFirstShift + 1) * 4;
+constexpr int kOversized = kClassCount;
+
+// Classes up to this size are carved out of slabs, larger ones are allocated one block at a time
+constexpr size_t kMaxSlabBlock = 4096;
+constexpr size_t kSlabBytes = 64 * 1024;
+// A thread keeps about this many bytes of free blocks per class, and never fewer than two blocks
+constexpr size_t kCacheBytes = 1024 * 1024;
+constexpr uint32_t kMinCachedBlocks = 2;
+
+constexpr uint16_t kStateLive = 0xa11c;
+constexpr uint16_t kStateFree = 0xf4ee;
+
+int floorLog2(size_t value) {
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#elif defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse(&index, static_cast<unsigned long>(value));
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+#endif
+}
+
+int classIndex(size_t size) {
+    if (size <= kLinearClasses * kLinearStep) {
+        return size == 0 ? 0 : static_cast<int>((size - 1) / kLinearStep);
+    }
+    size_t s = size - 1;
+    int shift = floorLog2(s);
+    if (shift > kLastShift) return kOversized;
+    return kLinearClasses + (shift - kFirstShift) * 4 + static_cast<int>((s >> (shift - 2)) & 3);
+}
+
+size_t classSize(int index) {
+    if (index < kLinearClasses) return static_cast<size_t>(index + 1) * kLinearStep;
+    int k = index - kLinearClasses;
+    return static_cast<size_t>(5 + k % 4) << (kFirstShift + k / 4 - 2);
+}
+
+uint32_t cacheLimit(int index) {
+    return std::max<uint32_t>(kMinCachedBlocks, static_cast<uint32_t>(kCacheBytes / classSize(index)));
+}
+
+// Precedes every block, the block itself starts kHeaderSize bytes later so it keeps 16-byte alignment
+struct BlockHeader {
+    // Cache that handed the block out
+    void* owner;
+    uint32_t size_class;
+    uint16_t state;
+    // Set by allocate(), cleared by trim(), a free block that is still clear on the next trim() is given back
+    uint16_t touched;
+};
+
+constexpr size_t kHeaderSize = 16;
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "block header must keep blocks 16-byte aligned");
+
+inline void* userOf(BlockHeader* header) {
+    return reinterpret_cast<uint8_t*>(header) + kHeaderSize;
+}
+
+inline BlockHeader* headerOf(void* block) {
+    return reinterpret_cast<BlockHeader*>(static_cast<uint8_t*>(block) - kHeaderSize);
+}
+
+// Free blocks are chained through their first bytes
+inline BlockHeader*& nextOf(BlockHeader* header) {
+    return *reinterpret_cast<BlockHeader**>(userOf(header));
+}
+
+struct FreeList {
+    BlockHeader* head = nullptr;
+    uint32_t count = 0;
+
+    void push(BlockHeader* header) {
+        nextOf(header) = head;
+        head = header;
+        count++;
+    }
+
+    BlockHeader* pop() {
+        auto header = head;
+        head = nextOf(header);
+        count--;
+        return header;
+    }
+};
+
+struct ClassCounters {
+    std::atomic<size_t> in_use{ 0 };
+    std::atomic<size_t> high_water{ 0 };
+    std::atomic<size_t> reserved{ 0 };
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> remote_frees{ 0 };
+    // Keeps the counters of neighbouring classes off the same cache line
+    char padding[24];
+
+    void onAllocate() {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        size_t now = in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+        size_t high = high_water.load(std::memory_order_relaxed);
+        while (now > high && !high_water.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+std::atomic<uint64_t> g_next_allocator_id{ 1 };
+
+}  // namespace
+
+struct SlabAllocator::Cache {
+    explicit Cache(Shared* owner) : shared(owner) {}
+
+    Shared* const shared;
+    FreeList bins[kClassCount];
+    // Blocks freed by other threads, pushed lock-free and taken all at once by the owning thread
+    std::atomic<BlockHeader*> remote{ nullptr };
+
+    void pushRemote(BlockHeader* header) {
+        auto head = remote.load(std::memory_order_relaxed);
+        do {
+            nextOf(header) = head;
+        } while (!remote.compare_exchange_weak(head, header, std::memory_order_release,
+            std::memory_order_relaxed));
+    }
+
+    // Owning thread, or any thread under Shared::mutex once the cache is orphaned
+    void drainRemote() {
+        auto header = remote.exchange(nullptr, std::memory_order_acquire);
+        while (header) {
+            auto next = nextOf(header);
+            bins[header->size_class].push(header);
+            header = next;
+        }
+    }
+};
+
+struct SlabAllocator::Shared {
+    std::mutex mutex;
+    std::vector<Cache*> caches;
+    // Caches of exited threads, handed to the next thread that needs one
+    std::vector<Cache*> orphans;
+    FreeList depot[kClassCount];
+    std::vector<void*> slabs;
+    // Blocks that were allocated on their own, large classes and oversized requests
+    std::unordered_set<BlockHeader*> blocks;
+    ClassCounters counters[kClassCount + 1];
+
+    ~Shared() {
+        for (auto cache : caches) {
+            delete cache;
+        }
+        for (auto slab : slabs) {
+            ::operator delete(slab);
+        }
+        for (auto header : blocks) {
+            ::operator delete(header);
+        }
+    }
+
+    Cache* acquireCache() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!orphans.empty()) {
+            auto cache = orphans.back();
+            orphans.pop_back();
+            return cache;
+        }
+        auto cache = new Cache(this);
+        caches.push_back(cache);
+        return cache;
+    }
+
+    // Called when the thread owning cache exits
+    void orphanCache(Cache* cache) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache->drainRemote();
+        for (int i = 0; i < kClassCount; i++) {
+            moveToDepot(cache->bins[i], i, cache->bins[i].count);
+        }
+        orphans.push_back(cache);
+    }
+
+    // Under mutex
+    void moveToDepot(FreeList& bin, int index, uint32_t count) {
+        while (count-- > 0 && bin.head) {
+            depot[index].push(bin.pop());
+        }
+    }
+
+    void refill(Cache* cache, int index) {
+        auto& bin = cache->bins[index];
+        size_t size = classSize(index);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint32_t batch = std::max<uint32_t>(1, cacheLimit(index) / 2);
+            while (batch-- > 0 && depot[index].head) {
+                bin.push(depot[index].pop());
+            }
+            if (bin.head) return;
+        }
+
+        if (size <= kMaxSlabBlock) {
+            size_t stride = kHeaderSize + size;
+            size_t count = kSlabBytes / stride;
+            auto slab = static_cast<uint8_t*>(::operator new(kSlabBytes));
+            for (size_t i = count; i-- > 0;) {
+                auto header = reinterpret_cast<BlockHeader*>(slab + i * stride);
+                header->size_class = index;
+                header->state = kStateFree;
+                header->touched = 0;
+                bin.push(header);
+            }
+            counters[index].reserved.fetch_add(count, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(mutex);
+            slabs.push_back(slab);
+        }
+        else {
+            auto header = newBlock(index, size);
+            header->state = kStateFree;
+            bin.push(header);
+        }
+    }
+
+    BlockHeader* newBlock(int index, size_t size) {
+        auto header = static_cast<BlockHeader*>(::operator new(kHeaderSize + size));
+        header->size_class = index;
+        header->touched = 0;
+        counters[index].reserved.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex);
+        blocks.insert(header);
+        return header;
+    }
+
+    void deleteBlock(BlockHeader* header) {
+        counters[header->size_class].reserved.fetch_sub(1, std::memory_order_relaxed);
+        blocks.erase(header);
+        ::operator delete(header);
+    }
+};
+
+// Per-thread list of the caches this thread owns, one per allocator it used
+struct SlabAllocator::ThreadCaches {
+    struct Slot {
+        uint64_t allocator_id;
+        std::weak_ptr<Shared> shared;
+        Cache* cache;
+    };
+
+    // Most threads only ever use one allocator, so the last lookup is remembered
+    static thread_local uint64_t last_id;
+    static thread_local Cache* last_cache;
+
+    std::vector<Slot> slots;
+
+    ~ThreadCaches() {
+        last_id = 0;
+        for (auto& slot : slots) {
+            if (auto shared = slot.shared.lock()) {
+                shared->orphanCache(slot.cache);
+            }
+        }
+    }
+};
+
+thread_local uint64_t SlabAllocator::ThreadCaches::last_id = 0;
+thread_local SlabAllocator::Cache* SlabAllocator::ThreadCaches::last_cache = nullptr;
+
+SlabAllocator::SlabAllocator(bool zero_fill)
+    : id_(g_next_allocator_id.fetch_add(1)), zero_fill_(zero_fill), shared_(std::make_shared<Shared>()) {}
+
+SlabAllocator::~SlabAllocator() = default;
+
+SlabAllocator::Cache* SlabAllocator::localCache() {
+    auto& last_id = ThreadCaches::last_id;
+    auto& last_cache = ThreadCaches::last_cache;
+    if (last_id == id_) return last_cache;
+
+    thread_local ThreadCaches owned;
+    for (auto& slot : owned.slots) {
+        if (slot.allocator_id == id_) {
+            last_id = id_;
+            last_cache = slot.cache;
+            return last_cache;
+        }
+    }
+    owned.slots.erase(std::remove_if(owned.slots.begin(), owned.slots.end(),
+        [](const ThreadCaches::Slot& slot) { return slot.shared.expired(); }), owned.slots.end());
+    auto cache = shared_->acquireCache();
+    owned.slots.push_back(ThreadCaches::Slot{ id_, shared_, cache });
+    last_id = id_;
+    last_cache = cache;
+    return cache;
+}
+
+void* SlabAllocator::allocate(size_t size) {
+    return allocate(size, zero_fill_);
+}
+
+void* SlabAllocator::allocate(size_t size, bool zero_fill) {
+    auto cache = localCache();
+    int index = classIndex(size);
+    BlockHeader* header = nullptr;
+    if (index == kOversized) {
+        header = shared_->newBlock(kOversized, size);
+    }
+    else {
+        auto& bin = cache->bins[index];
+        if (!bin.head) {
+            cache->drainRemote();
+            if (!bin.head) shared_->refill(cache, index);
+        }
+        header = bin.pop();
+    }
+    header->owner = cache;
+    header->state = kStateLive;
+    header->touched = 1;
+    shared_->counters[index].onAllocate();
+
+    auto block = userOf(header);
+    if (zero_fill) memset(block, 0, size);
+    return block;
+}
+
+bool SlabAllocator::release(void* block) {
+    if (!block) return false;
+    auto header = headerOf(block);
+    auto owner = static_cast<Cache*>(header->owner);
+    if (header->state != kStateLive || !owner || owner->shared != shared_.get()) return false;
+    header->state = kStateFree;
+
+    int index = static_cast<int>(header->size_class);
+    auto& counters = shared_->counters[index];
+    counters.in_use.fetch_sub(1, std::memory_order_relaxed);
+    if (index == kOversized) {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        shared_->deleteBlock(header);
+        return true;
+    }
+
+    auto cache = localCache();
+    if (owner != cache) {
+        counters.remote_frees.fetch_add(1, std::memory_order_relaxed);
+        owner->pushRemote(header);
+        return true;
+    }
+    auto& bin = cache->bins[index];
+    bin.push(header);
+    uint32_t limit = cacheLimit(index);
+    if (bin.count > limit) {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        shared_->moveToDepot(bin, index, bin.count - limit / 2);
+    }
+    return true;
+}
+
+void SlabAllocator::trim() {
+    auto cache = localCache();
+    cache->drainRemote();
+    std::lock_guard<std::mutex> lock(shared_->mutex);
+    int first_large = classIndex(kMaxSlabBlock) + 1;
+    // Idle large blocks of this thread and of exited threads are candidates too
+    for (int i = first_large; i < kClassCount; i++) {
+        shared_->moveToDepot(cache->bins[i], i, cache->bins[i].count);
+    }
+    for (auto orphan : shared_->orphans) {
+        orphan->drainRemote();
+        for (int i = first_large; i < kClassCount; i++) {
+            shared_->moveToDepot(orphan->bins[i], i, orphan->bins[i].count);
+        }
+    }
+
+    for (int i = first_large; i < kClassCount; i++) {
+        FreeList kept;
+        auto& depot = shared_->depot[i];
+        while (depot.head) {
+            auto header = depot.pop();
+            if (header->touched) {
+                header->touched = 0;
+                kept.push(header);
+            }
+            else {
+                shared_->deleteBlock(header);
+            }
+        }
+        depot = kept;
+    }
+}
+
+SlabAllocator::Stats SlabAllocator::stats() const {
+    auto fill = [](const ClassCounters& counters, size_t block_size) {
+        ClassStats s;
+        s.block_size = block_size;
+        s.in_use = counters.in_use.load(std::memory_order_relaxed);
+        s.high_water = counters.high_water.load(std::memory_order_relaxed);
+        s.reserved = counters.reserved.load(std::memory_order_relaxed);
+        s.allocations = counters.allocations.load(std::memory_order_relaxed);
+        s.remote_frees = counters.remote_frees.load(std::memory_order_relaxed);
+        return s;
+    };
+
+    Stats stats;
+    for (int i = 0; i < kClassCount; i++) {
+        const auto& counters = shared_->counters[i];
+        if (counters.allocations.load(std::memory_order_relaxed) == 0) continue;
+        stats.classes.push_back(fill(counters, classSize(i)));
+    }
+    stats.oversized = fill(shared_->counters[kOversized], 0);
+    return stats;
+}
+
+size_t SlabAllocator::blockSize(size_t size) {
+    int index = classIndex(size);
+    return index == kOversized ? 0 : classSize(index);
+}
+
+}  // namespace vrd
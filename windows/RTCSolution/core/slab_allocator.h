@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace vrd {
+
+/**
+* Size-class allocator for buffers that are allocated and freed at a high rate, e.g. frame buffers
+* Requests are rounded up to one of four classes per power of two, so at most a quarter of a block is wasted.
+* Every thread allocates from its own cache without locking, a block freed on another thread is pushed
+* back to the cache that handed it out through a lock-free stack. Small classes are carved out of 64 KB slabs,
+* large ones are allocated one by one and given back to the system by trim()
+*/
+class SlabAllocator {
+public:
+    struct ClassStats {
+        // 0 for the entry that counts requests larger than the biggest class
+        size_t block_size = 0;
+        // Blocks handed out and not freed yet
+        size_t in_use = 0;
+        // Most blocks in use at the same time
+        size_t high_water = 0;
+        // Blocks owned by the allocator, in use or cached
+        size_t reserved = 0;
+        uint64_t allocations = 0;
+        // Frees that happened on a thread other than the allocating one
+        uint64_t remote_frees = 0;
+    };
+
+    struct Stats {
+        // Only the classes that were ever used, smallest first
+        std::vector<ClassStats> classes;
+        ClassStats oversized;
+    };
+
+    // zero_fill clears the requested bytes of every block allocate() returns
+    explicit SlabAllocator(bool zero_fill = false);
+    // Frees every block, including the ones still in use
+    ~SlabAllocator();
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    // Any thread, blocks are 16-byte aligned
+    void* allocate(size_t size);
+    void* allocate(size_t size, bool zero_fill);
+    // Any thread, false for nullptr, a block of another allocator or a block that is already free
+    bool release(void* block);
+    // Frees the cached large blocks nobody allocated since the previous trim()
+    void trim();
+    Stats stats() const;
+
+    // Block size a request of size bytes is rounded up to, 0 when it is larger than every class
+    static size_t blockSize(size_t size);
+
+private:
+    struct Shared;
+    struct Cache;
+    struct ThreadCaches;
+
+    Cache* localCache();
+
+    const uint64_t id_;
+    const bool zero_fill_;
+    std::shared_ptr<Shared> shared_;
+};
+
+}  // namespace vrd
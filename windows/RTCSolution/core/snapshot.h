@@ -0,0 +1,170 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "core/index_free_list.h"
+
+namespace vrd {
+
+template <typename T>
+class SnapshotPool;
+
+/**
+* Reference-counted handle to an immutable array published by a SnapshotPool
+* Copying a handle only bumps the count, the items are written once when the snapshot is made
+*/
+template <typename T>
+class Snapshot {
+public:
+    Snapshot() = default;
+    Snapshot(const Snapshot& other) : block_(other.block_) { retain(); }
+    Snapshot(Snapshot&& other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    Snapshot& operator=(Snapshot other) noexcept {
+        std::swap(block_, other.block_);
+        return *this;
+    }
+    ~Snapshot() { reset(); }
+
+    void reset();
+
+    const T* begin() const { return block_ ? block_->items : nullptr; }
+    const T* end() const { return block_ ? block_->items + block_->size : nullptr; }
+    size_t size() const { return block_ ? block_->size : 0; }
+    bool empty() const { return size() == 0; }
+    const T& operator[](size_t i) const { return block_->items[i]; }
+
+    // Hands the reference to a raw pointer so it can travel in a POD event payload,
+    // adopt() takes it back, every detached pointer must be adopted exactly once
+    void* detach() {
+        auto raw = block_;
+        block_ = nullptr;
+        return raw;
+    }
+    static Snapshot adopt(void* raw) {
+        return Snapshot(static_cast<Block*>(raw));
+    }
+
+private:
+    friend class SnapshotPool<T>;
+
+    struct Block {
+        std::atomic<int> refs{ 0 };
+        // Null for blocks that did not fit the pool and live on the heap
+        SnapshotPool<T>* pool = nullptr;
+        uint32_t index = 0;
+        size_t size = 0;
+        T* items = nullptr;
+    };
+
+    explicit Snapshot(Block* block) : block_(block) {}
+
+    void retain() {
+        if (block_) block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Block* block_ = nullptr;
+};
+
+/**
+* Fixed set of recycled arrays handed out as immutable snapshots
+* Making a snapshot on a callback thread does not allocate unless it is larger than the pool capacity
+* or every array is still referenced, both cases fall back to the heap and are counted
+*/
+template <typename T>
+class SnapshotPool {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "SnapshotPool requires a trivially copyable type");
+
+public:
+    struct Stats {
+        size_t block_count = 0;
+        size_t capacity = 0;
+        size_t in_use = 0;
+        uint64_t heap_fallbacks = 0;
+    };
+
+    SnapshotPool(size_t block_count, size_t capacity)
+        : block_count_(block_count),
+          capacity_(capacity),
+          storage_(new T[block_count * capacity]),
+          blocks_(new Block[block_count]),
+          free_blocks_(block_count) {
+        for (size_t i = 0; i < block_count; i++) {
+            blocks_[i].pool = this;
+            blocks_[i].index = static_cast<uint32_t>(i);
+            blocks_[i].items = storage_.get() + i * capacity;
+        }
+    }
+
+    SnapshotPool(const SnapshotPool&) = delete;
+    SnapshotPool& operator=(const SnapshotPool&) = delete;
+
+    // Any thread, fill(T* items) writes count items before the snapshot is shared
+    template <typename F>
+    Snapshot<T> make(size_t count, F&& fill) {
+        Block* block = nullptr;
+        if (count <= capacity_) {
+            auto index = free_blocks_.pop();
+            if (index != IndexFreeList::kEmpty) {
+                block = &blocks_[index];
+                in_use_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (!block) {
+            heap_fallbacks_.fetch_add(1, std::memory_order_relaxed);
+            block = new Block;
+            block->items = new T[count ? count : 1];
+        }
+        block->size = count;
+        if (count) fill(block->items);
+        block->refs.store(1, std::memory_order_release);
+        return Snapshot<T>(block);
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.block_count = block_count_;
+        s.capacity = capacity_;
+        s.in_use = in_use_.load(std::memory_order_relaxed);
+        s.heap_fallbacks = heap_fallbacks_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    friend class Snapshot<T>;
+    using Block = typename Snapshot<T>::Block;
+
+    void recycle(Block* block) {
+        in_use_.fetch_sub(1, std::memory_order_relaxed);
+        free_blocks_.push(block->index);
+    }
+
+    const size_t block_count_;
+    const size_t capacity_;
+    std::unique_ptr<T[]> storage_;
+    std::unique_ptr<Block[]> blocks_;
+    IndexFreeList free_blocks_;
+    std::atomic<size_t> in_use_{ 0 };
+    std::atomic<uint64_t> heap_fallbacks_{ 0 };
+};
+
+template <typename T>
+void Snapshot<T>::reset() {
+    if (!block_) return;
+    if (block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        if (block_->pool) {
+            block_->pool->recycle(block_);
+        }
+        else {
+            delete[] block_->items;
+            delete block_;
+        }
+    }
+    block_ = nullptr;
+}
+
+}  // namespace vrd
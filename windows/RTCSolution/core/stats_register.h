@@ -0,0 +1,173 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace vrd {
+
+/**
+* Double-buffered latest-value register
+* One writer fills the back buffer and publishes it, readers copy the front buffer without locking.
+* A newer value simply replaces an unread one, nothing is ever queued
+*/
+template <typename T>
+class LatestValue {
+    static_assert(std::is_trivially_copyable<T>::value,
+        "LatestValue requires a trivially copyable type");
+
+public:
+    // Single writer at a time
+    void store(const T& value) {
+        auto seq = seq_.load(std::memory_order_relaxed);
+        auto published = seq >> 1;
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffers_[(published + 1) & 1] = value;
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    // Returns false if nothing was published yet, version is the number of stores seen
+    bool load(T& value, uint64_t* version = nullptr) const {
+        for (;;) {
+            auto seq = seq_.load(std::memory_order_acquire);
+            auto published = seq >> 1;
+            if (published == 0) {
+                return false;
+            }
+            value = buffers_[published & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The buffer just read is only rewritten once the writer starts on published + 2
+            if (seq_.load(std::memory_order_relaxed) <= (published << 1) + 2) {
+                if (version) *version = published;
+                return true;
+            }
+        }
+    }
+
+    uint64_t version() const {
+        return seq_.load(std::memory_order_acquire) >> 1;
+    }
+
+private:
+    T buffers_[2] = {};
+    std::atomic<uint64_t> seq_{ 0 };
+};
+
+/**
+* Fixed-size table of latest-value registers keyed by stream, the key is an interned id handle
+* N bounds the streams tracked at once, size it for the largest room the scene supports
+* The SDK thread overwrites a stream's entry in place on every report,
+* the UI thread pulls the entries that changed since its last pass at its own refresh rate
+*/
+template <typename T, size_t N = 64>
+class StatsTable {
+public:
+    struct Entry {
+        uint32_t key;
+        int sub_key;
+        T value;
+    };
+
+    // Per-reader record of the last version consumed from each slot
+    struct Cursor {
+        std::array<uint64_t, N> seen{};
+    };
+
+    // Writer thread, returns false when the table is full and the report is dropped
+    bool update(uint32_t key, int sub_key, const T& value) {
+        int idx = find(key, sub_key);
+        if (idx < 0) {
+            idx = claim(key, sub_key);
+            if (idx < 0) {
+                overflow_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        Entry entry;
+        entry.key = key;
+        entry.sub_key = sub_key;
+        entry.value = value;
+        slots_[idx].entry.store(entry);
+        return true;
+    }
+
+    void remove(uint32_t key, int sub_key) {
+        int idx = find(key, sub_key);
+        if (idx >= 0) {
+            slots_[idx].state.store(kFree, std::memory_order_release);
+        }
+    }
+
+    void clear() {
+        for (auto& slot : slots_) {
+            slot.state.store(kFree, std::memory_order_release);
+        }
+    }
+
+    // Reader thread, calls fn(const Entry&) once for every entry updated since the cursor's last pass
+    template <typename F>
+    size_t collect(Cursor& cursor, F&& fn) const {
+        size_t count = 0;
+        Entry entry;
+        for (size_t i = 0; i < N; i++) {
+            const auto& slot = slots_[i];
+            if (slot.state.load(std::memory_order_acquire) != kUsed) continue;
+            uint64_t version = 0;
+            if (slot.entry.version() == cursor.seen[i] || !slot.entry.load(entry, &version)) {
+                continue;
+            }
+            cursor.seen[i] = version;
+            fn(static_cast<const Entry&>(entry));
+            ++count;
+        }
+        return count;
+    }
+
+    // Reports dropped because every slot was taken
+    uint64_t overflowCount() const {
+        return overflow_.load(std::memory_order_relaxed);
+    }
+
+private:
+    enum : int { kFree = 0, kClaiming = 1, kUsed = 2 };
+
+    struct Slot {
+        std::atomic<int> state{ kFree };
+        uint32_t owner_key = 0;
+        int owner_sub_key = 0;
+        LatestValue<Entry> entry;
+    };
+
+    int find(uint32_t key, int sub_key) const {
+        for (size_t i = 0; i < N; i++) {
+            const auto& slot = slots_[i];
+            if (slot.state.load(std::memory_order_acquire) == kUsed
+                && slot.owner_key == key
+                && slot.owner_sub_key == sub_key) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    int claim(uint32_t key, int sub_key) {
+        for (size_t i = 0; i < N; i++) {
+            auto& slot = slots_[i];
+            int expected = kFree;
+            if (slot.state.compare_exchange_strong(expected, kClaiming, std::memory_order_acquire)) {
+                slot.owner_key = key;
+                slot.owner_sub_key = sub_key;
+                slot.state.store(kUsed, std::memory_order_release);
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    std::array<Slot, N> slots_;
+    std::atomic<uint64_t> overflow_{ 0 };
+};
+
+}  // namespace vrd
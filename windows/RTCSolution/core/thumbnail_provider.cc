@@ -0,0 +1,143 @@
+#include "thumbnail_provider.h"
+
+#include <QRunnable>
+#include <QThread>
+#include <algorithm>
+#include <functional>
+
+#include "core/forward_event.h"
+#include "core/rtc_engine_wrap.h"
+
+namespace vrd {
+
+size_t ThumbnailCache::KeyHash::operator()(const Key& key) const {
+    return std::hash<void*>()(key.source_id) * 31 + std::hash<std::string>()(key.title);
+}
+
+ThumbnailCache::ThumbnailCache(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+bool ThumbnailCache::find(void* source_id, const std::string& title, Clock::duration max_age,
+        Lookup& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(Key{ source_id, title });
+    if (it == index_.end()) return false;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    out.image = it->second->image;
+    out.stale = Clock::now() - it->second->captured > max_age;
+    return true;
+}
+
+void ThumbnailCache::put(void* source_id, const std::string& title, QImage image) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Key key{ source_id, title };
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->image = std::move(image);
+        it->second->captured = Clock::now();
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    entries_.push_front(Entry{ key, std::move(image), Clock::now() });
+    index_.emplace(std::move(key), entries_.begin());
+    if (entries_.size() > capacity_) {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+}
+
+void ThumbnailCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    entries_.clear();
+}
+
+size_t ThumbnailCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+class ThumbnailProvider::CaptureTask : public QRunnable {
+public:
+    CaptureTask(uint64_t request, int index, SnapshotAttr source, int max_width, int max_height)
+        : request_(request), index_(index), source_(std::move(source)),
+          max_width_(max_width), max_height_(max_height) {}
+
+    void run() override {
+        ThumbnailProvider::instance().capture(request_, index_, source_, max_width_, max_height_);
+    }
+
+private:
+    uint64_t request_;
+    int index_;
+    SnapshotAttr source_;
+    int max_width_;
+    int max_height_;
+};
+
+constexpr int ThumbnailProvider::kRefreshAgeMs;
+constexpr int ThumbnailProvider::kMaxCaptureThreads;
+
+ThumbnailProvider& ThumbnailProvider::instance() {
+    static ThumbnailProvider provider;
+    return provider;
+}
+
+ThumbnailProvider::ThumbnailProvider() {
+    pool_.setMaxThreadCount(std::max(1, std::min(QThread::idealThreadCount(), kMaxCaptureThreads)));
+}
+
+ThumbnailProvider::~ThumbnailProvider() {
+    active_request_ = 0;
+    pool_.clear();
+    pool_.waitForDone();
+}
+
+uint64_t ThumbnailProvider::request(const std::vector<SnapshotAttr>& sources, int max_width,
+        int max_height, std::vector<QImage>& cached) {
+    // Only one picker is open at a time, queued captures of an older request are dropped
+    pool_.clear();
+    uint64_t request = ++next_request_;
+    active_request_ = request;
+
+    cached.assign(sources.size(), QImage());
+    for (size_t i = 0; i < sources.size(); i++) {
+        const auto& source = sources[i];
+        ThumbnailCache::Lookup hit;
+        if (cache_.find(source.source_id, source.name,
+                std::chrono::milliseconds(kRefreshAgeMs), hit)) {
+            cached[i] = hit.image;
+            if (!hit.stale) continue;
+        }
+        pool_.start(new CaptureTask(request, static_cast<int>(i), source, max_width, max_height));
+    }
+    return request;
+}
+
+void ThumbnailProvider::cancel(uint64_t request) {
+    uint64_t expected = request;
+    if (active_request_.compare_exchange_strong(expected, 0)) {
+        pool_.clear();
+    }
+}
+
+void ThumbnailProvider::capture(uint64_t request, int index, const SnapshotAttr& source,
+        int max_width, int max_height) {
+    if (active_request_.load() != request) return;
+    auto image = RtcEngineWrap::instance().getThumbnailImage(source.type, source.source_id,
+        max_width, max_height);
+    if (image.isNull()) return;
+    cache_.put(source.source_id, source.name, image);
+    ForwardEvent::PostEvent(this, [this, request, index, image] {
+        if (active_request_.load() != request) return;
+        emit sigThumbnailReady(request, index, image);
+    });
+}
+
+void ThumbnailProvider::customEvent(QEvent* e) {
+    if (e->type() == QEvent::User) {
+        auto user_event = static_cast<ForwardEvent*>(e);
+        user_event->execTask();
+    }
+}
+
+}  // namespace vrd
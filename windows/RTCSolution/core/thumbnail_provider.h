@@ -0,0 +1,108 @@
+#pragma once
+#include <QImage>
+#include <QObject>
+#include <QThreadPool>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/common_define.h"
+
+namespace vrd {
+
+/**
+* Bounded LRU of share source thumbnails keyed by source id and window title
+* A window that changed its title is a different entry, so a stale picture is never shown under a new name
+*/
+class ThumbnailCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Lookup {
+        QImage image;
+        // True when the entry is older than the refresh age and should be captured again
+        bool stale = true;
+    };
+
+    explicit ThumbnailCache(size_t capacity = 96);
+
+    // Any thread, an entry that is found becomes the most recently used
+    bool find(void* source_id, const std::string& title, Clock::duration max_age, Lookup& out);
+    // Any thread
+    void put(void* source_id, const std::string& title, QImage image);
+    void clear();
+    size_t size() const;
+
+private:
+    struct Key {
+        void* source_id;
+        std::string title;
+        bool operator==(const Key& rhs) const {
+            return source_id == rhs.source_id && title == rhs.title;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Entry {
+        Key key;
+        QImage image;
+        Clock::time_point captured;
+    };
+
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    // Most recently used first
+    std::list<Entry> entries_;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+};
+
+/**
+* Captures share picker thumbnails on a small thread pool
+* request() hands back whatever is cached right away and schedules captures for the missing and stale
+* sources, each finished capture is delivered on the UI thread through sigThumbnailReady
+*/
+class ThumbnailProvider : public QObject {
+    Q_OBJECT
+
+public:
+    static ThumbnailProvider& instance();
+
+    // UI thread, cached[i] is the cached image of sources[i] or a null image, returns the request id
+    uint64_t request(const std::vector<SnapshotAttr>& sources, int max_width, int max_height,
+        std::vector<QImage>& cached);
+    // UI thread, captures of the request that have not started yet are skipped
+    void cancel(uint64_t request);
+
+signals:
+    // index is the position of the source in the request
+    void sigThumbnailReady(uint64_t request, int index, QImage image);
+
+protected:
+    // Runs the ForwardEvent tasks the capture threads post back to the UI thread
+    void customEvent(QEvent* e) override;
+
+private:
+    ThumbnailProvider();
+    ~ThumbnailProvider();
+
+    class CaptureTask;
+    // Worker thread
+    void capture(uint64_t request, int index, const SnapshotAttr& source, int max_width, int max_height);
+
+    // Pictures older than this are shown, then replaced by a fresh capture
+    static constexpr int kRefreshAgeMs = 5000;
+    static constexpr int kMaxCaptureThreads = 4;
+
+    ThumbnailCache cache_;
+    QThreadPool pool_;
+    std::atomic<uint64_t> active_request_{ 0 };
+    uint64_t next_request_ = 0;
+};
+
+}  // namespace vrd
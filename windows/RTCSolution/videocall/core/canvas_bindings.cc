@@ -0,0 +1,134 @@
+#include "canvas_bindings.h"
+
+#include <unordered_set>
+
+namespace videocall {
+
+CanvasBindings& CanvasBindings::instance() {
+    static CanvasBindings bindings;
+    return bindings;
+}
+
+void CanvasBindings::bind(const StreamKey& key, void* view) {
+    if (!view) {
+        unbind(key);
+        return;
+    }
+    const auto id = hash(key);
+    auto iter = bindings_.find(id);
+    if (iter != bindings_.end() && iter->second.view == view) {
+        unchanged_++;
+        return;
+    }
+    auto owner = owners_.find(view);
+    if (owner != owners_.end() && owner->second != id) {
+        const auto previous = bindings_[owner->second].key;
+        unbind(previous);
+    }
+    if (!send(key, view)) return;
+    Binding binding;
+    binding.key = key;
+    binding.view = view;
+    record(id, binding);
+}
+
+void CanvasBindings::unbind(const StreamKey& key) {
+    const auto id = hash(key);
+    if (!bindings_.count(id)) return;
+    // The binding goes even if the call fails, there is no engine left to render into the window
+    send(key, nullptr);
+    drop(id);
+}
+
+void CanvasBindings::assignCameras(const std::vector<Binding>& bindings) {
+    std::unordered_set<uint64_t> wanted;
+    for (const auto& binding : bindings) {
+        wanted.insert(hash(binding.key));
+    }
+    std::vector<StreamKey> stale;
+    for (const auto& entry : bindings_) {
+        if (!entry.second.key.screen && !wanted.count(entry.first)) stale.push_back(entry.second.key);
+    }
+    // Freed windows first, so a stream moving into one never shares it with a dropped stream
+    for (const auto& key : stale) {
+        unbind(key);
+    }
+
+    // A moved stream takes its new window directly, a stream still shown there moves away later in the pass
+    for (const auto& binding : bindings) {
+        const auto id = hash(binding.key);
+        auto iter = bindings_.find(id);
+        if (iter != bindings_.end() && iter->second.view == binding.view) {
+            unchanged_++;
+            continue;
+        }
+        if (!binding.view) {
+            unbind(binding.key);
+            continue;
+        }
+        if (send(binding.key, binding.view)) record(id, binding);
+    }
+}
+
+void* CanvasBindings::view(const StreamKey& key) const {
+    auto iter = bindings_.find(hash(key));
+    return iter == bindings_.end() ? nullptr : iter->second.view;
+}
+
+void CanvasBindings::reset() {
+    bindings_.clear();
+    owners_.clear();
+}
+
+CanvasBindings::Stats CanvasBindings::stats() const {
+    Stats s;
+    s.bound = bindings_.size();
+    s.binds = binds_;
+    s.unbinds = unbinds_;
+    s.unchanged = unchanged_;
+    s.moves = moves_;
+    return s;
+}
+
+void CanvasBindings::setRequestSink(RequestSink sink) {
+    sink_ = std::move(sink);
+}
+
+uint64_t CanvasBindings::hash(const StreamKey& key) {
+    const uint64_t uid = key.local ? 0 : key.uid;
+    return uid << 2 | static_cast<uint64_t>(key.local) << 1 | static_cast<uint64_t>(key.screen);
+}
+
+bool CanvasBindings::send(const StreamKey& key, void* view) {
+    if (view) {
+        binds_++;
+    }
+    else {
+        unbinds_++;
+    }
+    Request request;
+    request.key = key;
+    request.view = view;
+    return sink_ && sink_(request) == 0;
+}
+
+void CanvasBindings::record(uint64_t id, const Binding& binding) {
+    auto iter = bindings_.find(id);
+    if (iter != bindings_.end()) {
+        auto owner = owners_.find(iter->second.view);
+        if (owner != owners_.end() && owner->second == id) owners_.erase(owner);
+        moves_++;
+    }
+    bindings_[id] = binding;
+    owners_[binding.view] = id;
+}
+
+void CanvasBindings::drop(uint64_t id) {
+    auto iter = bindings_.find(id);
+    if (iter == bindings_.end()) return;
+    auto owner = owners_.find(iter->second.view);
+    if (owner != owners_.end() && owner->second == id) owners_.erase(owner);
+    bindings_.erase(iter);
+}
+
+}  // namespace videocall
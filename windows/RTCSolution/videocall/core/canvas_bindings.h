@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "core/id_table.h"
+
+namespace videocall {
+
+/**
+* Which window every video stream renders into, the SDK canvas calls go through this table
+* A call is only made when a stream gets a different window or loses it, so refreshing the grid with an
+* unchanged layout costs nothing. Camera bindings are replaced as a whole, a reordered grid rebinds each
+* moved stream once and never passes through an unbound state. UI thread only
+*/
+class CanvasBindings {
+public:
+    struct StreamKey {
+        vrd::IdHandle uid = vrd::kInvalidIdHandle;
+        // The local camera is bound through the local canvas whatever its uid
+        bool local = false;
+        bool screen = false;
+    };
+
+    struct Binding {
+        StreamKey key;
+        void* view = nullptr;
+    };
+
+    struct Stats {
+        size_t bound = 0;
+        uint64_t binds = 0;
+        uint64_t unbinds = 0;
+        // Bindings that were asked for again and needed no call
+        uint64_t unchanged = 0;
+        // Binds that took a stream from one window straight to another, e.g. two tiles swapping users
+        uint64_t moves = 0;
+    };
+
+    // One SDK canvas call, a null view unbinds
+    struct Request {
+        StreamKey key;
+        void* view = nullptr;
+    };
+    // Returns the SDK result, 0 on success
+    using RequestSink = std::function<int(const Request&)>;
+
+    static CanvasBindings& instance();
+
+    // Renders the stream into view, whatever rendered there before is unbound
+    void bind(const StreamKey& key, void* view);
+    void unbind(const StreamKey& key);
+    // Replaces every camera binding, cameras that are not listed are unbound, screen shares are left alone
+    void assignCameras(const std::vector<Binding>& bindings);
+    // nullptr when the stream is not bound
+    void* view(const StreamKey& key) const;
+    // Forgets every binding without calling the SDK, the engine drops remote canvases with the room
+    void reset();
+    Stats stats() const;
+
+    // Receiver of the canvas calls, VideoCallRtcEngineWrap::init connects it to the engine and a check can
+    // record them instead. Binds fail while there is none
+    void setRequestSink(RequestSink sink);
+
+private:
+    CanvasBindings() = default;
+
+    static uint64_t hash(const StreamKey& key);
+    // One SDK canvas call, a null view unbinds. Records the binding only when the SDK accepted it,
+    // a failed bind is retried on the next pass
+    bool send(const StreamKey& key, void* view);
+    void record(uint64_t id, const Binding& binding);
+    void drop(uint64_t id);
+
+    std::unordered_map<uint64_t, Binding> bindings_;
+    // Stream bound to every window, a window never shows two streams
+    std::unordered_map<void*, uint64_t> owners_;
+    RequestSink sink_;
+    uint64_t binds_ = 0;
+    uint64_t unbinds_ = 0;
+    uint64_t unchanged_ = 0;
+    uint64_t moves_ = 0;
+};
+
+}  // namespace videocall
@@ -10,6 +10,7 @@ void DataMgr::init() {
     instance().mute_video_ = false;
     instance().mute_audio_ = false;
     instance().share_quality_index_ = 0;
+    instance().high_light_ = vrd::kInvalidIdHandle;
 }
 
 }  // namespace videocall
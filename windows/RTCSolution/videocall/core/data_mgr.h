@@ -1,10 +1,11 @@
 #pragma once
 #include <algorithm>
 #include <functional>
-#include <mutex>
+#include <memory>
 
 #include "core/rtc_engine_wrap.h"
 #include "videocall_model.h"
+#include "participant_store.h"
 
 namespace videocall {
 #define PROPRETY(CLASS, MEMBER, UPPER_MEMBER)                        \
@@ -17,6 +18,26 @@ public:                                                              \
   void set##UPPER_MEMBER(const CLASS& MEMBER) { MEMBER##_ = MEMBER; } \
   void set##UPPER_MEMBER(CLASS&& MEMBER) { MEMBER##_ = std::move(MEMBER); }
 
+// Published as a whole: a read shares the current immutable snapshot in O(1) and keeps it alive, a write
+// builds the next value and swaps it in atomically, so no reader on any thread sees a half-written one.
+// update##UPPER_MEMBER copies, edits and publishes, writes come from the UI thread only
+#define SNAPSHOT_PROPRETY(CLASS, MEMBER, UPPER_MEMBER)                                          \
+private:                                                                                        \
+    std::shared_ptr<const CLASS> MEMBER##_ = std::make_shared<CLASS>();                         \
+                                                                                                \
+public:                                                                                         \
+  std::shared_ptr<const CLASS> MEMBER() const { return std::atomic_load(&MEMBER##_); }          \
+  void set##UPPER_MEMBER(CLASS MEMBER) {                                                        \
+    std::shared_ptr<const CLASS> next = std::make_shared<CLASS>(std::move(MEMBER));             \
+    std::atomic_store(&MEMBER##_, std::move(next));                                             \
+  }                                                                                             \
+  template <typename Fn>                                                                        \
+  void update##UPPER_MEMBER(Fn&& fn) {                                                          \
+    auto next = std::make_shared<CLASS>(*MEMBER());                                             \
+    fn(*next);                                                                                  \
+    std::atomic_store(&MEMBER##_, std::shared_ptr<const CLASS>(std::move(next)));               \
+  }
+
  /**
   * The data definition class required by the scene, used for data synchronization between different classes
   */
@@ -25,35 +46,39 @@ public:
     static DataMgr& instance();
     static void init();
 
-    PROPRETY(StreamInfo, local_stream_info, LocalStreamInfo)
-    PROPRETY(std::vector<StreamInfo>, remote_stream_infos, RemoteStreamInfos)
-    PROPRETY(VideoCallSettingModel, setting, Setting)
+    SNAPSHOT_PROPRETY(StreamInfo, local_stream_info, LocalStreamInfo)
+    SNAPSHOT_PROPRETY(VideoCallSettingModel, setting, Setting)
     PROPRETY(std::string, user_name, UserName)
     PROPRETY(bool, mute_audio, MuteAudio)
     PROPRETY(bool, mute_video, MuteVideo)
     PROPRETY(int, share_quality_index, ShareQualityIndex)
     PROPRETY(bool, share_screen, ShareScreen) //only for local share state
 
-    PROPRETY(std::string, high_light, HighLight)
-    PROPRETY(std::vector<AudioVolumeInfoWrap>, remote_volumes, RemoteVolumes)
-    PROPRETY(std::vector<AudioVolumeInfoWrap>, local_volumes, LocalVolumes)
+    PROPRETY(vrd::IdHandle, high_light, HighLight)
+    PROPRETY(AudioVolumeSnapshot, remote_volumes, RemoteVolumes)
+    PROPRETY(AudioVolumeSnapshot, local_volumes, LocalVolumes)
 
     PROPRETY(std::string, app_id, AppID)
     PROPRETY(std::string, user_id, UserID)
+    PROPRETY(vrd::IdHandle, user_handle, UserHandle)
     PROPRETY(std::string, room_id, RoomID)
 
-    PROPRETY(VideoCallRoom, room, Room)
-    PROPRETY(std::vector<User>, users, Users)
+    SNAPSHOT_PROPRETY(VideoCallRoom, room, Room)
     PROPRETY(std::string, token, Token)
 
+    // Users in the room including the local one, with the receive stats of the remote streams
+    ParticipantStore& participants() { return participants_; }
+    const ParticipantStore& participants() const { return participants_; }
+
 protected:
     DataMgr() = default;
     ~DataMgr() = default;
 
-public:
-    mutable std::mutex _mutex;
+private:
+    ParticipantStore participants_;
 };
 
 #undef PROPRETY
+#undef SNAPSHOT_PROPRETY
 
 }  // namespace videocall
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "participant_store.h"
+
+namespace videocall {
+
+constexpr uint32_t ParticipantStore::kNone;
+
+Participant& ParticipantStore::add(const User& user) {
+    auto iter = index_.find(user.user_handle);
+    if (iter != index_.end()) return slots_[iter->second].participant;
+
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        slots_[slot] = Slot();
+    }
+    else {
+        slot = static_cast<uint32_t>(slots_.size());
+        slots_.emplace_back();
+    }
+    auto& entry = slots_[slot];
+    entry.participant.user = user;
+    entry.participant.stats.user_id = user.user_id;
+    entry.participant.stats.user_handle = user.user_handle;
+    entry.participant.stats.user_name = user.user_name;
+    entry.prev = tail_;
+    if (tail_ != kNone) {
+        slots_[tail_].next = slot;
+    }
+    else {
+        head_ = slot;
+    }
+    tail_ = slot;
+
+    index_.emplace(user.user_handle, slot);
+    order_dirty_ = true;
+    record(user.user_handle, kJoined);
+    return entry.participant;
+}
+
+bool ParticipantStore::remove(vrd::IdHandle uid) {
+    auto iter = index_.find(uid);
+    if (iter == index_.end()) return false;
+    const auto slot = iter->second;
+    auto& entry = slots_[slot];
+    if (entry.prev != kNone) {
+        slots_[entry.prev].next = entry.next;
+    }
+    else {
+        head_ = entry.next;
+    }
+    if (entry.next != kNone) {
+        slots_[entry.next].prev = entry.prev;
+    }
+    else {
+        tail_ = entry.prev;
+    }
+    // Drops the strings now, the slot itself waits for the next join
+    entry = Slot();
+    free_slots_.push_back(slot);
+    index_.erase(iter);
+    order_dirty_ = true;
+    record(uid, kLeft);
+    return true;
+}
+
+void ParticipantStore::clear() {
+    slots_.clear();
+    free_slots_.clear();
+    index_.clear();
+    head_ = kNone;
+    tail_ = kNone;
+    order_.clear();
+    order_dirty_ = false;
+    pending_.clear();
+    changes_.clear();
+}
+
+const Participant* ParticipantStore::find(vrd::IdHandle uid) const {
+    auto iter = index_.find(uid);
+    return iter == index_.end() ? nullptr : &slots_[iter->second].participant;
+}
+
+const Participant& ParticipantStore::at(size_t index) const {
+    flatten();
+    return slots_[order_[index]].participant;
+}
+
+std::vector<ParticipantStore::ChangeEntry> ParticipantStore::takeChanges() {
+    pending_.clear();
+    std::vector<ChangeEntry> changes;
+    changes.swap(changes_);
+    return changes;
+}
+
+void ParticipantStore::record(vrd::IdHandle uid, uint32_t changes) {
+    if (!changes) return;
+    auto iter = pending_.find(uid);
+    if (iter != pending_.end()) {
+        changes_[iter->second].changes |= changes;
+        return;
+    }
+    pending_.emplace(uid, changes_.size());
+    ChangeEntry entry;
+    entry.uid = uid;
+    entry.changes = changes;
+    changes_.push_back(entry);
+}
+
+void ParticipantStore::flatten() const {
+    if (!order_dirty_) return;
+    order_.clear();
+    for (auto slot = head_; slot != kNone; slot = slots_[slot].next) {
+        order_.push_back(slot);
+    }
+    order_dirty_ = false;
+}
+
+}  // namespace videocall
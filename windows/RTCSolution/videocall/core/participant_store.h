@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "core/id_table.h"
+#include "videocall_model.h"
+
+namespace videocall {
+
+// Everything the scene knows about one person in the room
+struct Participant {
+    User user;
+    // Receive stats of the remote stream, the local user's send stats are DataMgr::local_stream_info
+    StreamInfo stats{};
+};
+
+/**
+* Participants of the room keyed by user handle, in join order
+* Lookup, update and removal are O(1), the join order is a list threaded through the slots and indexed access
+* flattens it once per join or leave. Every change is also recorded in a feed the UI drains to learn which
+* participants changed since it last looked. UI thread only
+*/
+class ParticipantStore {
+public:
+    enum Change : uint32_t {
+        kJoined = 1 << 0,
+        kLeft = 1 << 1,
+        // User fields such as mic, camera or share state
+        kUpdated = 1 << 2,
+        kStats = 1 << 3,
+    };
+
+    // Changes of one participant since the last drain, find() tells its current state
+    struct ChangeEntry {
+        vrd::IdHandle uid = vrd::kInvalidIdHandle;
+        uint32_t changes = 0;
+    };
+
+    // Appends the user to the join order, a user already present keeps its place and data
+    Participant& add(const User& user);
+    bool remove(vrd::IdHandle uid);
+    // Without a change feed entry, the next room starts from an empty feed
+    void clear();
+
+    size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+    const Participant* find(vrd::IdHandle uid) const;
+    // index-th participant in join order
+    const Participant& at(size_t index) const;
+
+    // Runs fn on the participant and records changes in the feed, 0 updates silently, e.g. speaker volumes.
+    // Returns false if uid is not in the room
+    template <typename Fn>
+    bool update(vrd::IdHandle uid, uint32_t changes, Fn&& fn) {
+        auto iter = index_.find(uid);
+        if (iter == index_.end()) return false;
+        fn(slots_[iter->second].participant);
+        record(uid, changes);
+        return true;
+    }
+
+    // Visits the participants in join order
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (auto slot = head_; slot != kNone; slot = slots_[slot].next) {
+            fn(slots_[slot].participant);
+        }
+    }
+
+    // Changes recorded since the last call, in the order participants first changed
+    std::vector<ChangeEntry> takeChanges();
+
+private:
+    static constexpr uint32_t kNone = 0xffffffffu;
+
+    struct Slot {
+        Participant participant;
+        uint32_t prev = kNone;
+        uint32_t next = kNone;
+    };
+
+    void record(vrd::IdHandle uid, uint32_t changes);
+    void flatten() const;
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_map<vrd::IdHandle, uint32_t> index_;
+    uint32_t head_ = kNone;
+    uint32_t tail_ = kNone;
+    // Slots in join order, rebuilt on the first indexed access after a join or leave
+    mutable std::vector<uint32_t> order_;
+    mutable bool order_dirty_ = false;
+    // Position of every pending participant in changes_
+    std::unordered_map<vrd::IdHandle, size_t> pending_;
+    std::vector<ChangeEntry> changes_;
+};
+
+}  // namespace videocall
@@ -0,0 +1,75 @@
+#include "publish_policy.h"
+
+#include <algorithm>
+
+#include "core/rtc_engine_wrap.h"
+
+namespace videocall {
+
+namespace {
+
+bool sameLadder(const std::vector<vrd::SimulcastLayer>& a, const std::vector<vrd::SimulcastLayer>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+        [](const vrd::SimulcastLayer& x, const vrd::SimulcastLayer& y) {
+            return x.width == y.width && x.height == y.height && x.fps == y.fps && x.max_kbps == y.max_kbps;
+        });
+}
+
+}  // namespace
+
+PublishPolicy& PublishPolicy::instance() {
+    static PublishPolicy policy;
+    return policy;
+}
+
+void PublishPolicy::setCameraProfile(const VideoConfiger& camera) {
+    camera_ = camera;
+    // A new setting is always pushed, the engine may have been reset since the last one
+    applied_.clear();
+    apply();
+}
+
+void PublishPolicy::setParticipantCount(int count) {
+    count = std::max(1, count);
+    if (count == participants_) return;
+    participants_ = count;
+    apply();
+}
+
+std::vector<vrd::SimulcastLayer> PublishPolicy::ladder() const {
+    auto layers = vrd::SimulcastLayers::publishLadder(participants_, camera_.resolution.height);
+    for (auto& layer : layers) {
+        if (camera_.fps > 0) layer.fps = camera_.fps;
+        if (camera_.kbps > 0) layer.max_kbps = std::min(layer.max_kbps, camera_.kbps);
+    }
+    return layers;
+}
+
+PublishPolicy::Stats PublishPolicy::stats() const {
+    Stats s;
+    s.participants = participants_;
+    s.tier = vrd::SimulcastLayers::publishTier(participants_);
+    s.top_height = applied_.empty() ? 0 : applied_.front().height;
+    s.reconfigurations = reconfigurations_;
+    return s;
+}
+
+void PublishPolicy::apply() {
+    auto layers = ladder();
+    if (sameLadder(layers, applied_)) return;
+
+    std::vector<bytertc::VideoEncoderConfig> configs;
+    for (const auto& layer : layers) {
+        bytertc::VideoEncoderConfig config;
+        config.width = layer.width;
+        config.height = layer.height;
+        config.frame_rate = layer.fps;
+        config.max_bitrate = layer.max_kbps;
+        configs.push_back(config);
+    }
+    if (RtcEngineWrap::instance().setVideoProfiles(configs) != 0) return;
+    applied_ = std::move(layers);
+    reconfigurations_++;
+}
+
+}  // namespace videocall
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "core/simulcast_layers.h"
+#include "videocall/core/videocall_model.h"
+
+namespace videocall {
+
+/**
+* Decides the simulcast ladder the local camera is encoded with
+* The camera setting is the ceiling, the room size picks the tier from vrd::SimulcastLayers, so a large call
+* stops encoding and sending a 720p layer nobody has a tile big enough for. The encoder is only reconfigured
+* when the resulting ladder changes. UI thread only
+*/
+class PublishPolicy {
+public:
+    struct Stats {
+        int participants = 0;
+        size_t tier = 0;
+        // Height of the best layer currently published, 0 before the first apply
+        int top_height = 0;
+        uint64_t reconfigurations = 0;
+    };
+
+    static PublishPolicy& instance();
+
+    // Resolution, frame rate and bitrate the user picked, kbps <= 0 keeps the tier's bitrates
+    void setCameraProfile(const VideoConfiger& camera);
+    // Everyone in the room including the local user
+    void setParticipantCount(int count);
+
+    std::vector<vrd::SimulcastLayer> ladder() const;
+    Stats stats() const;
+
+private:
+    PublishPolicy() = default;
+
+    void apply();
+
+    VideoConfiger camera_{ { 1280, 720 }, 15, -1 };
+    int participants_ = 1;
+    std::vector<vrd::SimulcastLayer> applied_;
+    uint64_t reconfigurations_ = 0;
+};
+
+}  // namespace videocall
@@ -0,0 +1,156 @@
+#include "subscription_manager.h"
+
+#include <algorithm>
+
+#include "core/simulcast_layers.h"
+
+namespace videocall {
+
+SubscriptionManager& SubscriptionManager::instance() {
+    static SubscriptionManager manager;
+    return manager;
+}
+
+void SubscriptionManager::reset(vrd::IdHandle local_user) {
+    local_user_ = local_user;
+    speaker_ = vrd::kInvalidIdHandle;
+    participants_ = 1;
+    published_.clear();
+    visible_.clear();
+    subscribed_.clear();
+}
+
+void SubscriptionManager::onVideoPublished(vrd::IdHandle uid, bool published) {
+    if (uid == local_user_) return;
+    if (published) {
+        published_.insert(uid);
+        if (wanted(uid) && !subscribed_.count(uid)) subscribe(uid, wantedLayer(uid, -1));
+    }
+    else {
+        // The SDK drops the subscription together with the stream
+        published_.erase(uid);
+        subscribed_.erase(uid);
+    }
+}
+
+void SubscriptionManager::onScreenPublished(vrd::IdHandle uid, bool published) {
+    if (uid == local_user_ || !published) return;
+    Request request;
+    request.uid = uid;
+    request.subscribe = true;
+    request.is_screen = true;
+    send(request);
+    subscribe_calls_++;
+}
+
+void SubscriptionManager::onUserLeft(vrd::IdHandle uid) {
+    published_.erase(uid);
+    visible_.erase(uid);
+    subscribed_.erase(uid);
+    if (speaker_ == uid) speaker_ = vrd::kInvalidIdHandle;
+}
+
+void SubscriptionManager::setParticipantCount(int count) {
+    count = std::max(1, count);
+    if (count == participants_) return;
+    const bool retier = vrd::SimulcastLayers::publishTier(count) != vrd::SimulcastLayers::publishTier(participants_);
+    participants_ = count;
+    // Indices name other resolutions in another tier, every subscribed camera is picked again
+    if (retier) reconcile(true);
+}
+
+void SubscriptionManager::setVisibleTiles(const std::vector<VisibleTile>& tiles) {
+    visible_.clear();
+    for (const auto& tile : tiles) {
+        visible_[tile.uid] = tile;
+    }
+    reconcile();
+}
+
+void SubscriptionManager::setActiveSpeaker(vrd::IdHandle uid) {
+    if (uid == vrd::kInvalidIdHandle || uid == local_user_ || uid == speaker_) return;
+    speaker_ = uid;
+    reconcile();
+}
+
+bool SubscriptionManager::isVideoSubscribed(vrd::IdHandle uid) const {
+    return subscribed_.count(uid) != 0;
+}
+
+int SubscriptionManager::videoLayer(vrd::IdHandle uid) const {
+    auto iter = subscribed_.find(uid);
+    return iter == subscribed_.end() ? -1 : iter->second;
+}
+
+SubscriptionManager::Stats SubscriptionManager::stats() const {
+    Stats s;
+    s.subscribed = subscribed_.size();
+    s.published = published_.size();
+    s.subscribe_calls = subscribe_calls_;
+    s.unsubscribe_calls = unsubscribe_calls_;
+    s.layer_switches = layer_switches_;
+    return s;
+}
+
+void SubscriptionManager::setRequestSink(RequestSink sink) {
+    sink_ = std::move(sink);
+}
+
+bool SubscriptionManager::wanted(vrd::IdHandle uid) const {
+    return uid == speaker_ || visible_.count(uid) != 0;
+}
+
+int SubscriptionManager::wantedLayer(vrd::IdHandle uid, int current) const {
+    auto iter = visible_.find(uid);
+    if (iter == visible_.end()) {
+        return std::max(0, vrd::SimulcastLayers::layerCount(participants_) - 1);
+    }
+    return vrd::SimulcastLayers::select(participants_, iter->second.width, iter->second.height, current);
+}
+
+void SubscriptionManager::reconcile(bool reselect) {
+    std::vector<vrd::IdHandle> stale;
+    for (const auto& entry : subscribed_) {
+        if (!wanted(entry.first)) stale.push_back(entry.first);
+    }
+    for (auto uid : stale) {
+        unsubscribe(uid);
+    }
+    for (auto uid : published_) {
+        if (!wanted(uid)) continue;
+        int current = videoLayer(uid);
+        int layer = wantedLayer(uid, reselect ? -1 : current);
+        if (layer != current) subscribe(uid, layer);
+    }
+}
+
+void SubscriptionManager::subscribe(vrd::IdHandle uid, int layer) {
+    Request request;
+    request.uid = uid;
+    request.subscribe = true;
+    request.layer = layer;
+    subscribe_calls_++;
+    if (send(request) != 0) return;
+    auto iter = subscribed_.find(uid);
+    if (iter != subscribed_.end()) {
+        iter->second = layer;
+        layer_switches_++;
+    }
+    else {
+        subscribed_.emplace(uid, layer);
+    }
+}
+
+void SubscriptionManager::unsubscribe(vrd::IdHandle uid) {
+    Request request;
+    request.uid = uid;
+    send(request);
+    subscribed_.erase(uid);
+    unsubscribe_calls_++;
+}
+
+int SubscriptionManager::send(const Request& request) {
+    return sink_ ? sink_(request) : -1;
+}
+
+}  // namespace videocall
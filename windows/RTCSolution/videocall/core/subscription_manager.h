@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/id_table.h"
+
+namespace videocall {
+
+/**
+* Decides which remote cameras are downloaded, the room is joined in manual subscribe mode for video
+* Audio stays auto-subscribed for everyone. Video is subscribed for the users whose tiles are on screen plus
+* the active speaker, who is kept until someone else speaks so pauses between sentences do not resubscribe.
+* Screen shares are always subscribed since the focus view shows them. Every camera gets the simulcast layer
+* vrd::SimulcastLayers picks for its tile out of the ladder publishers send at the current room size, an active
+* speaker without a tile gets the smallest one. UI thread only
+*/
+class SubscriptionManager {
+public:
+    struct Stats {
+        size_t subscribed = 0;
+        size_t published = 0;
+        uint64_t subscribe_calls = 0;
+        uint64_t unsubscribe_calls = 0;
+        // Subscribe calls that only moved an already subscribed stream to another layer
+        uint64_t layer_switches = 0;
+    };
+
+    // Size of an on-screen tile in physical pixels
+    struct VisibleTile {
+        vrd::IdHandle uid = vrd::kInvalidIdHandle;
+        int width = 0;
+        int height = 0;
+    };
+
+    // One SDK call, layer is -1 for unsubscribe and for screen shares
+    struct Request {
+        vrd::IdHandle uid = vrd::kInvalidIdHandle;
+        bool subscribe = false;
+        bool is_screen = false;
+        int layer = -1;
+    };
+    // Returns the SDK result, 0 on success
+    using RequestSink = std::function<int(const Request&)>;
+
+    static SubscriptionManager& instance();
+
+    // Forgets every stream, called when the room is joined or left
+    void reset(vrd::IdHandle local_user);
+
+    void onVideoPublished(vrd::IdHandle uid, bool published);
+    void onScreenPublished(vrd::IdHandle uid, bool published);
+    void onUserLeft(vrd::IdHandle uid);
+    // Everyone in the room including the local user, picks the publish tier layers are counted in
+    void setParticipantCount(int count);
+
+    // Tiles currently on screen, the local user is ignored
+    void setVisibleTiles(const std::vector<VisibleTile>& tiles);
+    // kInvalidIdHandle keeps the previous speaker
+    void setActiveSpeaker(vrd::IdHandle uid);
+
+    bool isVideoSubscribed(vrd::IdHandle uid) const;
+    // -1 when the camera is not subscribed
+    int videoLayer(vrd::IdHandle uid) const;
+    Stats stats() const;
+
+    // Receiver of the subscribe calls, VideoCallRtcEngineWrap::init connects it to RtcEngineWrap and a check
+    // can record them instead. Calls fail while there is none
+    void setRequestSink(RequestSink sink);
+
+private:
+    SubscriptionManager() = default;
+
+    bool wanted(vrd::IdHandle uid) const;
+    int wantedLayer(vrd::IdHandle uid, int current) const;
+    // reselect picks every layer afresh instead of from the one subscribed
+    void reconcile(bool reselect = false);
+    void subscribe(vrd::IdHandle uid, int layer);
+    void unsubscribe(vrd::IdHandle uid);
+    int send(const Request& request);
+
+    vrd::IdHandle local_user_ = vrd::kInvalidIdHandle;
+    vrd::IdHandle speaker_ = vrd::kInvalidIdHandle;
+    int participants_ = 1;
+    // Remote users with a published camera stream
+    std::unordered_set<vrd::IdHandle> published_;
+    std::unordered_map<vrd::IdHandle, VisibleTile> visible_;
+    // Subscribed camera streams and their layer
+    std::unordered_map<vrd::IdHandle, int> subscribed_;
+    RequestSink sink_;
+    uint64_t subscribe_calls_ = 0;
+    uint64_t unsubscribe_calls_ = 0;
+    uint64_t layer_switches_ = 0;
+};
+
+}  // namespace videocall
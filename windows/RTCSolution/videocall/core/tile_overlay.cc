@@ -0,0 +1,297 @@
+#include "tile_overlay.h"
+
+#include <QFontMetrics>
+#include <QIcon>
+#include <QPainter>
+#include <QResizeEvent>
+#include <algorithm>
+
+namespace videocall {
+
+namespace {
+
+const int kBorder = 2;
+const int kChipHeight = 32;
+const int kChipPadding = 8;
+const int kIconSize = 16;
+// Avatars are only evicted in bulk, a room has a bounded set of initials and sizes
+const size_t kMaxPixmaps = 512;
+
+enum PixmapKind : uint64_t {
+    kMicOn = 1,
+    kMicOff = 2,
+    kShare = 3,
+    kAvatar = 4,
+};
+
+uint64_t pixmapKey(uint64_t kind, qreal dpr, int diameter = 0, ushort letter = 0) {
+    return kind << 56 | static_cast<uint64_t>(qRound(dpr * 100) & 0xffff) << 40 |
+        static_cast<uint64_t>(diameter & 0xffff) << 16 | letter;
+}
+
+const QColor& backgroundColor() {
+    static const QColor color(0x27, 0x2E, 0x3B);
+    return color;
+}
+
+}  // namespace
+
+TileOverlayCache& TileOverlayCache::instance() {
+    static TileOverlayCache cache;
+    return cache;
+}
+
+TileOverlayCache::TileOverlayCache() : name_font_("Microsoft YaHei") {
+    name_font_.setPixelSize(12);
+}
+
+const QPixmap& TileOverlayCache::micIcon(bool on, qreal dpr) {
+    return on ? icon(pixmapKey(kMicOn, dpr), ":img/videocall_mic_on", dpr)
+              : icon(pixmapKey(kMicOff, dpr), ":img/videocall_mic_off", dpr);
+}
+
+const QPixmap& TileOverlayCache::shareIcon(qreal dpr) {
+    return icon(pixmapKey(kShare, dpr), ":img/videocall_share_checked", dpr);
+}
+
+const QPixmap& TileOverlayCache::avatar(const QString& name, int diameter, qreal dpr) {
+    const QString letter = name.left(1).toUpper();
+    const uint64_t key = pixmapKey(kAvatar, dpr, diameter, letter.isEmpty() ? 0 : letter.at(0).unicode());
+    auto it = pixmaps_.find(key);
+    if (it != pixmaps_.end()) {
+        stats_.hits++;
+        return it->second;
+    }
+    if (pixmaps_.size() >= kMaxPixmaps) pixmaps_.clear();
+
+    QPixmap pixmap(QSize(diameter, diameter) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0x4E, 0x59, 0x69));
+    painter.drawEllipse(QRectF(0, 0, diameter, diameter));
+    QFont font("Inter");
+    font.setWeight(QFont::Medium);
+    font.setPixelSize(diameter * 2 / 5);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    painter.drawText(QRect(0, 0, diameter, diameter), Qt::AlignCenter, letter);
+    painter.end();
+
+    stats_.rasterized++;
+    return pixmaps_[key] = pixmap;
+}
+
+TileOverlayCache::Stats TileOverlayCache::stats() const {
+    auto stats = stats_;
+    stats.entries = pixmaps_.size();
+    return stats;
+}
+
+const QPixmap& TileOverlayCache::icon(uint64_t key, const char* path, qreal dpr) {
+    auto it = pixmaps_.find(key);
+    if (it != pixmaps_.end()) {
+        stats_.hits++;
+        return it->second;
+    }
+    if (pixmaps_.size() >= kMaxPixmaps) pixmaps_.clear();
+
+    QPixmap pixmap(QSize(kIconSize, kIconSize) * dpr);
+    pixmap.setDevicePixelRatio(dpr);
+    pixmap.fill(Qt::transparent);
+    QPainter painter(&pixmap);
+    QIcon(path).paint(&painter, QRect(0, 0, kIconSize, kIconSize));
+    painter.end();
+
+    stats_.rasterized++;
+    return pixmaps_[key] = pixmap;
+}
+
+// Draws the chip over the video canvas, with the same routine the surface uses
+class TileSurface::InfoChip : public QWidget {
+public:
+    InfoChip(const TileOverlayState* state, QWidget* parent) : QWidget(parent), state_(state) {
+        setAttribute(Qt::WA_TransparentForMouseEvents);
+    }
+
+protected:
+    void paintEvent(QPaintEvent*) override {
+        QPainter painter(this);
+        TileSurface::paintChip(painter, rect(), *state_);
+    }
+
+private:
+    const TileOverlayState* state_;
+};
+
+TileSurface::TileSurface(QWidget* parent) : QWidget(parent) {
+    // Every pixel is painted, Qt does not need to erase first
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    video_ = new QWidget(this);
+    QPalette palette = video_->palette();
+    palette.setColor(QPalette::Window, backgroundColor());
+    video_->setPalette(palette);
+    video_->setAutoFillBackground(true);
+
+    // Created after the canvas so it stacks above it
+    chip_ = new InfoChip(&state_, this);
+    chip_->hide();
+}
+
+void TileSurface::setUserName(const QString& name) {
+    if (state_.name == name) return;
+    state_.name = name;
+    // The avatar letter follows the name
+    if (videoShown()) {
+        updateChip();
+    } else {
+        update();
+    }
+}
+
+void TileSurface::setMic(bool on) {
+    if (state_.mic_known && state_.mic_on == on) return;
+    state_.mic_known = true;
+    state_.mic_on = on;
+    updateChip();
+}
+
+void TileSurface::setShare(bool enabled) {
+    if (state_.share == enabled) return;
+    state_.share = enabled;
+    updateChip();
+}
+
+void TileSurface::setHighLight(bool enabled) {
+    if (state_.highlight == enabled) return;
+    state_.highlight = enabled;
+    // Only the border around the canvas changes
+    update(QRegion(rect()) - QRegion(rect().adjusted(kBorder, kBorder, -kBorder, -kBorder)));
+}
+
+void TileSurface::setHasVideo(bool has_video) {
+    if (state_.has_video == has_video) return;
+    state_.has_video = has_video;
+    video_->setVisible(videoShown());
+    updateChip();
+    update();
+}
+
+void TileSurface::setVideoHidden(bool hidden) {
+    if (video_hidden_ == hidden) return;
+    video_hidden_ = hidden;
+    video_->setVisible(videoShown());
+    updateChip();
+    update();
+}
+
+int TileSurface::avatarDiameter(const QSize& tile) {
+    if (tile.width() > 600 && tile.height() > 600) {
+        return 160;
+    }
+    if (tile.width() > 350 && tile.height() > 200) {
+        return 80;
+    }
+    return 40;
+}
+
+QSize TileSurface::chipSize(const TileOverlayState& state, int max_width) {
+    int width = 0;
+    int items = 0;
+    if (state.mic_known) {
+        width += kIconSize;
+        items++;
+    }
+    if (state.share) {
+        width += kIconSize;
+        items++;
+    }
+    if (!state.name.isEmpty()) {
+        width += QFontMetrics(TileOverlayCache::instance().nameFont()).horizontalAdvance(state.name);
+        items++;
+    }
+    if (items == 0) return QSize();
+    width += kChipPadding * (items + 1);
+    return QSize(std::min(width, std::max(0, max_width)), kChipHeight);
+}
+
+void TileSurface::paintChip(QPainter& painter, const QRect& rect, const TileOverlayState& state) {
+    auto& cache = TileOverlayCache::instance();
+    const qreal dpr = painter.device()->devicePixelRatioF();
+    const int icon_top = rect.top() + (rect.height() - kIconSize) / 2;
+    int x = rect.left() + kChipPadding;
+    if (state.mic_known) {
+        painter.drawPixmap(x, icon_top, cache.micIcon(state.mic_on, dpr));
+        x += kIconSize + kChipPadding;
+    }
+    if (state.share) {
+        painter.drawPixmap(x, icon_top, cache.shareIcon(dpr));
+        x += kIconSize + kChipPadding;
+    }
+    const int text_width = rect.right() + 1 - kChipPadding - x;
+    if (!state.name.isEmpty() && text_width > 0) {
+        QFontMetrics metrics(cache.nameFont());
+        painter.setFont(cache.nameFont());
+        painter.setPen(Qt::white);
+        painter.drawText(QRect(x, rect.top(), text_width, rect.height()), Qt::AlignLeft | Qt::AlignVCenter,
+            metrics.elidedText(state.name, Qt::ElideRight, text_width));
+    }
+}
+
+void TileSurface::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.fillRect(rect(), backgroundColor());
+    if (!videoShown()) {
+        const int diameter = avatarDiameter(size());
+        painter.drawPixmap((width() - diameter) / 2, (height() - diameter) / 2,
+            TileOverlayCache::instance().avatar(state_.name, diameter, devicePixelRatioF()));
+        const QSize chip = chipSize(state_, width() - 2 * kBorder);
+        if (!chip.isEmpty()) {
+            paintChip(painter, QRect(QPoint(kBorder, height() - chip.height() - kBorder), chip), state_);
+        }
+    }
+    if (state_.highlight) {
+        const QColor color(0x23, 0xC3, 0x43);
+        painter.fillRect(0, 0, width(), kBorder, color);
+        painter.fillRect(0, height() - kBorder, width(), kBorder, color);
+        painter.fillRect(0, 0, kBorder, height(), color);
+        painter.fillRect(width() - kBorder, 0, kBorder, height(), color);
+    }
+}
+
+void TileSurface::resizeEvent(QResizeEvent* e) {
+    QWidget::resizeEvent(e);
+    video_->setGeometry(kBorder, kBorder, width() - 2 * kBorder, height() - 2 * kBorder);
+    updateChip();
+}
+
+bool TileSurface::videoShown() const {
+    return state_.has_video && !video_hidden_;
+}
+
+void TileSurface::updateChip() {
+    if (!videoShown()) {
+        chip_->hide();
+        // The surface draws the chip itself, only its band changes
+        update(0, height() - kChipHeight - kBorder, width(), kChipHeight + kBorder);
+        return;
+    }
+    const QSize size = chipSize(state_, width() - 2 * kBorder);
+    if (size.isEmpty()) {
+        chip_->hide();
+        return;
+    }
+    // Moving a native window is not free, the chip only follows real size changes
+    const QRect geometry(QPoint(kBorder, height() - size.height() - kBorder), size);
+    if (chip_->geometry() != geometry) {
+        chip_->setGeometry(geometry);
+    }
+    chip_->show();
+    chip_->update();
+}
+
+}  // namespace videocall
@@ -0,0 +1,95 @@
+#pragma once
+#include <QFont>
+#include <QPixmap>
+#include <QString>
+#include <QWidget>
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace videocall {
+
+// What the overlay of a tile shows, setters only change this and schedule a repaint
+struct TileOverlayState {
+    QString name;
+    // The mic icon stays hidden until the first state arrives
+    bool mic_known = false;
+    bool mic_on = false;
+    bool share = false;
+    bool highlight = false;
+    bool has_video = true;
+};
+
+/**
+* Pre-rasterized overlay pixmaps shared by every tile
+* Icons are rendered once per device pixel ratio and avatars once per letter and diameter, so a repaint
+* only blits, no stylesheet is parsed and no svg is rendered after the first tile
+*/
+class TileOverlayCache {
+public:
+    struct Stats {
+        uint64_t rasterized = 0;
+        uint64_t hits = 0;
+        size_t entries = 0;
+    };
+
+    static TileOverlayCache& instance();
+
+    const QPixmap& micIcon(bool on, qreal dpr);
+    const QPixmap& shareIcon(qreal dpr);
+    // Circle with the upper-cased initial of the name
+    const QPixmap& avatar(const QString& name, int diameter, qreal dpr);
+
+    const QFont& nameFont() const { return name_font_; }
+    Stats stats() const;
+
+private:
+    TileOverlayCache();
+    const QPixmap& icon(uint64_t key, const char* path, qreal dpr);
+
+    QFont name_font_;
+    std::unordered_map<uint64_t, QPixmap> pixmaps_;
+    Stats stats_;
+};
+
+/**
+* Paints a whole tile: background, initial-letter avatar, highlight border and the info chip
+* The video canvas is a native child inset by the border, while it is shown the chip is drawn by a small
+* child raised above it, the surface itself can not draw over a native window
+*/
+class TileSurface : public QWidget {
+public:
+    explicit TileSurface(QWidget* parent = nullptr);
+
+    void setUserName(const QString& name);
+    void setMic(bool on);
+    void setShare(bool enabled);
+    void setHighLight(bool enabled);
+    void setHasVideo(bool has_video);
+    // hideVideo also hides the chip drawn over the video
+    void setVideoHidden(bool hidden);
+    QWidget* video() const { return video_; }
+
+    // Logo diameter for a tile of the given size
+    static int avatarDiameter(const QSize& tile);
+    // Mic, share and name in a row, 32 pixels high, empty when there is nothing to show
+    static QSize chipSize(const TileOverlayState& state, int max_width);
+    static void paintChip(QPainter& painter, const QRect& rect, const TileOverlayState& state);
+
+protected:
+    void paintEvent(QPaintEvent* e) override;
+    void resizeEvent(QResizeEvent* e) override;
+
+private:
+    class InfoChip;
+
+    bool videoShown() const;
+    void updateChip();
+
+    TileOverlayState state_;
+    bool video_hidden_ = false;
+    QWidget* video_;
+    InfoChip* chip_;
+};
+
+}  // namespace videocall
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "core/id_table.h"
+
+namespace videocall {
+
+/**
+* What a pooled video tile shows. VideoCallManager keeps the last applied state of every tile and
+* only pushes the fields that differ, so a volume report that moves the highlight touches two tiles
+*/
+struct TileState {
+    enum Field : uint32_t {
+        kCanvas = 1 << 0,
+        kName = 1 << 1,
+        kMic = 1 << 2,
+        kShare = 1 << 3,
+        kVideo = 1 << 4,
+        kHighlight = 1 << 5,
+    };
+    static constexpr int kFieldCount = 6;
+
+    vrd::IdHandle uid = vrd::kInvalidIdHandle;
+    bool local = false;
+    std::string name;
+    bool mic = false;
+    bool share = false;
+    bool has_video = false;
+    bool highlight = false;
+
+    // Fields of next that differ from this state, a new user dirties everything
+    uint32_t diff(const TileState& next) const {
+        if (uid != next.uid || local != next.local) {
+            return kCanvas | kName | kMic | kShare | kVideo | kHighlight;
+        }
+        uint32_t dirty = 0;
+        if (name != next.name) dirty |= kName;
+        if (mic != next.mic) dirty |= kMic;
+        if (share != next.share) dirty |= kShare;
+        if (has_video != next.has_video) dirty |= kVideo;
+        if (highlight != next.highlight) dirty |= kHighlight;
+        return dirty;
+    }
+};
+
+// Widget mutations done by the tile updates, one per field pushed to a tile
+struct TileUpdateStats {
+    uint64_t updates = 0;
+    uint64_t mutations = 0;
+    // Mutations of the most recent update
+    uint64_t last_mutations = 0;
+    // Indexed by the bit position of TileState::Field
+    uint64_t fields[TileState::kFieldCount] = {};
+};
+
+}  // namespace videocall
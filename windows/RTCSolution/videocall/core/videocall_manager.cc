@@ -15,7 +15,10 @@
 #include "core/util_tip.h"
 #include "videocall/core/videocall_session.h"
 #include "videocall/core/videocall_notify.h"
+#include "videocall/core/canvas_bindings.h"
 #include "videocall/core/data_mgr.h"
+#include "videocall/core/publish_policy.h"
+#include "videocall/core/subscription_manager.h"
 #include "videocall/feature/share_button_bar.h"
 #include "videocall/feature/videocall_share_widget.h"
 #include "videocall/feature/videocall_quit_dlg.h"
@@ -41,15 +44,9 @@ void VideoCallManager::init() {
 
     QObject::connect(&VideoCallRtcEngineWrap::instance(),
                     &VideoCallRtcEngineWrap::sigUpdateAudio, []() {
-                        auto& users = videocall::DataMgr::instance().ref_users();
-                        auto iter = std::find_if(users.begin(), users.end(),
-                            [](const User& user) {
-                                return user.user_id ==
-                                    videocall::DataMgr::instance().user_id();
-                            });
-                        if (iter != users.end()) {
-                            iter->is_mic_on = !videocall::DataMgr::instance().mute_audio();
-                        }
+                        auto& data = videocall::DataMgr::instance();
+                        data.participants().update(data.user_handle(), ParticipantStore::kUpdated,
+                            [&data](Participant& self) { self.user.is_mic_on = !data.mute_audio(); });
 
                         instance().main_page_->setMicState(
                             !videocall::DataMgr::instance().mute_audio());
@@ -65,15 +62,9 @@ void VideoCallManager::init() {
 
     QObject::connect(&VideoCallRtcEngineWrap::instance(),
                     &VideoCallRtcEngineWrap::sigUpdateVideo, []() {
-                        auto& users = videocall::DataMgr::instance().ref_users();
-                        auto iter = std::find_if(users.begin(), users.end(),
-                            [](const User& user) {
-                                return user.user_id ==
-                                    videocall::DataMgr::instance().user_id();
-                            });
-                        if (iter != users.end()) {
-                            iter->is_camera_on = !videocall::DataMgr::instance().mute_video();
-                        }
+                        auto& data = videocall::DataMgr::instance();
+                        data.participants().update(data.user_handle(), ParticipantStore::kUpdated,
+                            [&data](Participant& self) { self.user.is_camera_on = !data.mute_video(); });
 
                         instance().main_page_->setCameraState(
                             !videocall::DataMgr::instance().mute_video());
@@ -90,36 +81,26 @@ void VideoCallManager::init() {
     QObject::connect(
         &VideoCallRtcEngineWrap::instance(),
         &VideoCallRtcEngineWrap::sigOnAudioVolumeUpdate, [=]() {
-            auto remote_speackers = videocall::DataMgr::instance().remote_volumes();
-            auto local_speackers = videocall::DataMgr::instance().local_volumes();
-            auto total_speakers = remote_speackers;
-            for (auto& speaker : local_speackers) {
-                if (speaker.stream_index == bytertc::kStreamIndexMain) {
-                    speaker.uid = videocall::DataMgr::instance().user_id();
-                    speaker.roomId = videocall::DataMgr::instance().room_id();
-                    total_speakers.push_back(speaker);
-                }
-            }
-            std::sort(total_speakers.begin(), total_speakers.end(),
-                [](const AudioVolumeInfoWrap& l, const AudioVolumeInfoWrap& r) {
-                    return l.volume > r.volume;
+            // Read the shared snapshots in place, only the loudest speaker is needed
+            const auto& remote_speakers = videocall::DataMgr::instance().ref_remote_volumes();
+            const auto& local_speakers = videocall::DataMgr::instance().ref_local_volumes();
+            // Volumes change with every report, they are stored without a change feed entry
+            auto& participants = videocall::DataMgr::instance().participants();
+            SpeakerVolumes volumes([&participants](vrd::IdHandle uid, unsigned int volume) {
+                participants.update(uid, 0, [volume](Participant& participant) {
+                    participant.user.audio_volume = volume;
                 });
-            auto users = videocall::DataMgr::instance().ref_users();
-            for (auto& speacker : total_speakers) {
-                auto iter = std::find_if(users.begin(), users.end(),
-                    [speacker](const User& user) {
-                        return user.user_id == speacker.uid;
-                    });
-                if (iter != users.end()) {
-                    iter->audio_volume = speacker.volume;
-                }
-            }
-            if (total_speakers.size() > 0 && total_speakers[0].volume > 5) {
-                DataMgr::instance().setHighLight(total_speakers[0].uid);
+            });
+            for (const auto& speaker : remote_speakers) {
+                volumes.apply(speaker.uid, speaker.volume);
             }
-            else {
-                DataMgr::instance().setHighLight("");
+            for (const auto& speaker : local_speakers) {
+                if (speaker.stream_index == bytertc::kStreamIndexMain) {
+                    volumes.apply(videocall::DataMgr::instance().user_handle(), speaker.volume);
+                }
             }
+            DataMgr::instance().setHighLight(volumes.highlight());
+            SubscriptionManager::instance().setActiveSpeaker(volumes.highlight());
 
             ForwardEvent::PostEvent(&VideoCallManager::instance(), [] {
                 updateData();
@@ -129,7 +110,7 @@ void VideoCallManager::init() {
 	QObject::connect(&VideoCallRtcEngineWrap::instance(),
 		&VideoCallRtcEngineWrap::sigOnRoomStateChanged,
         [=](std::string room_id, std::string uid, int state, std::string extra_info) {
-			if (room_id == videocall::DataMgr::instance().room().room_id
+			if (room_id == videocall::DataMgr::instance().room()->room_id
 				&& uid == videocall::DataMgr::instance().user_id()) {
 				auto infoArray = QByteArray(extra_info.data(), static_cast<int>(extra_info.size()));
 				auto infoJsonObj = QJsonDocument::fromJson(infoArray).object();
@@ -146,40 +127,47 @@ void VideoCallManager::init() {
 
     QObject::connect(&VideoCallRtcEngineWrap::instance(),
         &VideoCallRtcEngineWrap::sigOnShareScreenStatusChanged,
-        [=](std::string uid, bool isSharing) {
-            if (uid == videocall::DataMgr::instance().user_id()) return;
-            auto& users = videocall::DataMgr::instance().ref_users();
-            for (size_t i = 0; i < users.size(); i++) {
-                if (users[i].user_id == uid) {
-                    VideoCallManager::instance().main_page_->changeViewMode(
-                        isSharing ? VideoCallMainPage::kFocusPage : VideoCallMainPage::kNormalPage);
-                    users[i].is_sharing = isSharing;
-                    auto r = videocall::DataMgr::instance().room();
-                    r.screen_shared_uid = isSharing ? uid : "";
-                    videocall::DataMgr::instance().setRoom(std::move(r));
-                    VideoCallManager::setRemoteScreenVideoWidget(users[i]);
-                    break;
-                }
+        [=](vrd::IdHandle uid, bool isSharing) {
+            if (uid == videocall::DataMgr::instance().user_handle()) return;
+            auto& participants = videocall::DataMgr::instance().participants();
+            if (!participants.update(uid, ParticipantStore::kUpdated,
+                [isSharing](Participant& participant) { participant.user.is_sharing = isSharing; })) {
+                return;
             }
+            const auto user = participants.find(uid)->user;
+            VideoCallManager::instance().main_page_->changeViewMode(
+                isSharing ? VideoCallMainPage::kFocusPage : VideoCallMainPage::kNormalPage);
+            videocall::DataMgr::instance().updateRoom([&](VideoCallRoom& room) {
+                room.screen_shared_uid = isSharing ? user.user_id : "";
+            });
+            VideoCallManager::setRemoteScreenVideoWidget(user);
         });
 
     instance().main_page_ = std::unique_ptr<VideoCallMainPage>(new VideoCallMainPage);
     QObject::connect(instance().main_page_.get(), &VideoCallMainPage::sigClose, [=] {
         VideoCallNotify::instance().offAll();
-        if (videocall::DataMgr::instance().room().screen_shared_uid ==
+        if (instance().stats_dump_timer_) {
+            instance().stats_dump_timer_->stop();
+            dumpStats();
+        }
+        if (videocall::DataMgr::instance().room()->screen_shared_uid ==
             videocall::DataMgr::instance().user_id()) {
             videocall::DataMgr::instance().setShareScreen(false);
             instance().share_button_bar_->hide();
             VideoCallRtcEngineWrap::instance().stopScreenAudioCapture();
             VideoCallRtcEngineWrap::instance().stopScreenCapture();
         }
-        videocall::DataMgr::instance().ref_room().screen_shared_uid = "";
+        videocall::DataMgr::instance().updateRoom([](VideoCallRoom& room) { room.screen_shared_uid.clear(); });
         for (auto video : instance().getVideoList()) {
             video->setParent(nullptr);
         }
+        instance().tiles_.assign(instance().tiles_.size(), TileState());
+        CanvasBindings::instance().reset();
+        instance().bound_first_ = 0;
+        instance().bound_count_ = 0;
         instance().getScreenVideo()->setParent(nullptr);
 
-        videocall::DataMgr::instance().setUsers(std::vector<User>());
+        videocall::DataMgr::instance().participants().clear();
         VideoCallRtcEngineWrap::instance().logout();
         showLogin();
     });
@@ -199,10 +187,6 @@ void VideoCallManager::init() {
         },Qt::QueuedConnection);
 
 	instance().screen_widget_ = std::make_shared<VideoCallVideoWidget>();
-	instance().videos_.resize(kMaxShowWidgetNum);
-	for (int i = 0; i < kMaxShowWidgetNum; i++) {
-		instance().videos_[i] = std::make_shared<VideoCallVideoWidget>();
-	}
 
     QObject::connect(instance().main_page_.get(),
         &VideoCallMainPage::sigShareButtonClicked, 
@@ -213,7 +197,8 @@ void VideoCallManager::init() {
 
     QObject::connect(instance().main_page_.get(),
         &VideoCallMainPage::sigCameraEnabled,
-        [=](bool is_enabled) { getCurrentVideo()->setHasVideo(is_enabled); });
+        // The local user may be on another page or scrolled out, refreshing only touches the bound tiles
+        [=](bool) { refreshVideos(); });
 
     QObject::connect(instance().main_page_.get(),
 		&VideoCallMainPage::sigVideoCallSetting,
@@ -255,10 +240,13 @@ void VideoCallManager::showSetting(QWidget* parent) {
     dlg->initView();
     if (dlg->exec() == QDialog::Accepted) {
         auto setting = videocall::DataMgr::instance().setting();
-        VideoCallRtcEngineWrap::setVideoProfiles(setting.camera);
-        VideoCallRtcEngineWrap::setAudioProfiles(setting.audio_quality);
-        VideoCallRtcEngineWrap::setLocalMirrorMode(setting.enable_camera_mirror ? 
+        VideoCallRtcEngineWrap::setVideoProfiles(setting->camera);
+        VideoCallRtcEngineWrap::setAudioProfiles(setting->audio_quality);
+        VideoCallRtcEngineWrap::setLocalMirrorMode(setting->enable_camera_mirror ? 
             bytertc::MirrorType::kMirrorTypeRenderAndEncoder : bytertc::MirrorType::kMirrorTypeNone);
+        if (instance().main_page_) {
+            instance().main_page_->setGridColumns(setting->grid_columns);
+        }
     }
 }
 
@@ -319,44 +307,21 @@ int VideoCallManager::showCallExpDlg(QWidget* parent) {
     return quit_dlg->exec();
 }
 
-void VideoCallManager::setLocalVideoWidget(const User& user, int idx) {
-    VideoCallRtcEngineWrap::setupLocalView(
-        videocall::VideoCallManager::getVideoList()[idx]->getWinID(),
-        bytertc::RenderMode::kRenderModeHidden, "local");
-
-    auto isLocalCameraOn = !videocall::DataMgr::instance().mute_video();
-    videocall::VideoCallManager::getVideoList()[idx]->setUserName(QObject::tr("xxx(me)").arg(QString::fromStdString(user.user_name)));
-    videocall::VideoCallManager::getVideoList()[idx]->setHighLight(videocall::DataMgr::instance().high_light() == user.user_id);
-    videocall::VideoCallManager::getVideoList()[idx]->setShare(videocall::DataMgr::instance().share_screen());
-    videocall::VideoCallManager::getVideoList()[idx]->setMic(!videocall::DataMgr::instance().mute_audio());
-    videocall::VideoCallManager::getVideoList()[idx]->setHasVideo(isLocalCameraOn);
-    videocall::VideoCallManager::getVideoList()[idx]->setUserLogoSize();
-}
-
-void VideoCallManager::setRemoteVideoWidget(const User& user, int idx) {
-    VideoCallRtcEngineWrap::setupRemoteView(
-        videocall::VideoCallManager::getVideoList()[idx]->getWinID(),
-        bytertc::RenderMode::kRenderModeHidden, user.user_id);
-    videocall::VideoCallManager::getVideoList()[idx]->setUserName(
-        user.user_name.c_str());
-    videocall::VideoCallManager::getVideoList()[idx]->setShare(user.is_sharing);
-    videocall::VideoCallManager::getVideoList()[idx]->setMic(user.is_mic_on);
-    videocall::VideoCallManager::getVideoList()[idx]->setHasVideo(user.is_camera_on);
-    videocall::VideoCallManager::getVideoList()[idx]->setUserLogoSize();
-    videocall::VideoCallManager::getVideoList()[idx]->setHighLight(videocall::DataMgr::instance().high_light() == user.user_id);
-}
-
 void VideoCallManager::setRemoteScreenVideoWidget(const User& user) {
     auto& ins = instance();
     auto video = getScreenVideo();
-    SubscribeConfig config;
-    config.is_screen = true;
-    config.sub_video = true;
-    VideoCallRtcEngineWrap::setRemoteScreenView(user.user_id, video->getWinID());
+    CanvasBindings::StreamKey key;
+    key.uid = user.user_handle;
+    key.screen = true;
+    if (user.is_sharing) {
+        CanvasBindings::instance().bind(key, video->getWinID());
+    }
+    else {
+        CanvasBindings::instance().unbind(key);
+    }
     video->setUserName(QObject::tr("xxx's_screen_sharing").arg(QString::fromStdString(user.user_name)));
     video->setShare(user.is_sharing);
     video->setHasVideo(user.is_sharing);
-    video->setUserLogoSize();
     if (user.is_sharing) {
         video->setVideoUpdateEnabled(false);
     }
@@ -368,6 +333,13 @@ void VideoCallManager::setRemoteScreenVideoWidget(const User& user) {
 void VideoCallManager::initRoom() {
     videoCallNotify();
     instance().main_page_->init();
+    // The views start empty, the first pass lays out everyone
+    instance().relayout_pending_ = true;
+    if (!instance().stats_dump_timer_) {
+        instance().stats_dump_timer_ = new QTimer(&instance());
+        QObject::connect(instance().stats_dump_timer_, &QTimer::timeout, &instance(), &VideoCallManager::dumpStats);
+    }
+    instance().stats_dump_timer_->start(kStatsDumpInterval);
     showRoom();
     updateData();
 }
@@ -380,18 +352,16 @@ void VideoCallManager::showRoom() {
         !videocall::DataMgr::instance().mute_audio());
     instance().current_widget_ = instance().main_page_.get();
     
-    auto cur_share_uid = videocall::DataMgr::instance().room().screen_shared_uid;
+    auto cur_share_uid = videocall::DataMgr::instance().room()->screen_shared_uid;
     if (!cur_share_uid.empty() 
         && cur_share_uid != videocall::DataMgr::instance().user_id()) {
-        auto users = videocall::DataMgr::instance().users();
-        auto iter = std::find_if(users.begin(), users.end(), [](const User& user) {
-            return user.user_id ==
-                videocall::DataMgr::instance().room().screen_shared_uid;
-            });
-        if (iter != users.end()) {
-            setRemoteScreenVideoWidget(*iter);
+        auto sharer = videocall::DataMgr::instance().participants().find(
+            vrd::IdTable::instance().find(cur_share_uid));
+        if (sharer) {
+            setRemoteScreenVideoWidget(sharer->user);
         }
     }
+    updateSubscriptions();
 }
 
 QWidget* VideoCallManager::currentWidget() { 
@@ -400,19 +370,127 @@ QWidget* VideoCallManager::currentWidget() {
 
 void VideoCallManager::hideRoom() { 
     instance().main_page_->hide();
+    updateSubscriptions();
 }
 
 std::vector<std::shared_ptr<VideoCallVideoWidget>> VideoCallManager::getVideoList() {
     return instance().videos_;
 }
 
+void VideoCallManager::bindVideos(int first, int count) {
+    auto& ins = instance();
+    const auto& participants = DataMgr::instance().participants();
+    first = std::max(0, std::min(first, static_cast<int>(participants.size())));
+    count = std::max(0, std::min(count, static_cast<int>(participants.size()) - first));
+    while (ins.videos_.size() < static_cast<size_t>(count)) {
+        ins.videos_.push_back(std::make_shared<VideoCallVideoWidget>());
+        ins.tiles_.emplace_back();
+    }
+
+    // The binding table only calls the SDK for users that changed tile, a reordered page swaps canvases
+    // directly and users that left the page lose theirs
+    std::vector<CanvasBindings::Binding> bindings;
+    for (int slot = 0; slot < count; slot++) {
+        const auto& user = participants.at(first + slot).user;
+        CanvasBindings::Binding binding;
+        binding.key.uid = user.user_handle;
+        binding.key.local = user.user_handle == DataMgr::instance().user_handle();
+        binding.view = ins.videos_[slot]->getWinID();
+        bindings.push_back(binding);
+    }
+    CanvasBindings::instance().assignCameras(bindings);
+    for (size_t slot = count; slot < ins.tiles_.size(); slot++) {
+        ins.tiles_[slot] = TileState();
+    }
+
+    int mutations = 0;
+    for (int slot = 0; slot < count; slot++) {
+        mutations += applyTile(slot, wantedTile(participants.at(first + slot).user));
+    }
+    ins.tile_stats_.updates++;
+    ins.tile_stats_.mutations += mutations;
+    ins.tile_stats_.last_mutations = mutations;
+    ins.bound_first_ = first;
+    ins.bound_count_ = count;
+}
+
+void VideoCallManager::refreshVideos() {
+    bindVideos(instance().bound_first_, instance().bound_count_);
+}
+
+TileUpdateStats VideoCallManager::tileStats() {
+    return instance().tile_stats_;
+}
+
+void VideoCallManager::dumpStats() {
+    auto tiles = tileStats();
+    qInfo("video tiles: updates=%llu mutations=%llu last=%llu canvas=%llu name=%llu mic=%llu share=%llu "
+        "video=%llu highlight=%llu",
+        static_cast<unsigned long long>(tiles.updates), static_cast<unsigned long long>(tiles.mutations),
+        static_cast<unsigned long long>(tiles.last_mutations), static_cast<unsigned long long>(tiles.fields[0]),
+        static_cast<unsigned long long>(tiles.fields[1]), static_cast<unsigned long long>(tiles.fields[2]),
+        static_cast<unsigned long long>(tiles.fields[3]), static_cast<unsigned long long>(tiles.fields[4]),
+        static_cast<unsigned long long>(tiles.fields[5]));
+    auto subscriptions = SubscriptionManager::instance().stats();
+    qInfo("video subscriptions: subscribed=%zu published=%zu subscribe_calls=%llu unsubscribe_calls=%llu "
+        "layer_switches=%llu",
+        subscriptions.subscribed, subscriptions.published,
+        static_cast<unsigned long long>(subscriptions.subscribe_calls),
+        static_cast<unsigned long long>(subscriptions.unsubscribe_calls),
+        static_cast<unsigned long long>(subscriptions.layer_switches));
+    auto canvases = CanvasBindings::instance().stats();
+    qInfo("video canvases: bound=%zu binds=%llu unbinds=%llu unchanged=%llu moves=%llu", canvases.bound,
+        static_cast<unsigned long long>(canvases.binds), static_cast<unsigned long long>(canvases.unbinds),
+        static_cast<unsigned long long>(canvases.unchanged), static_cast<unsigned long long>(canvases.moves));
+}
+
+TileState VideoCallManager::wantedTile(const User& user) {
+    const auto& data = DataMgr::instance();
+    TileState tile;
+    tile.uid = user.user_handle;
+    tile.local = user.user_handle == data.user_handle();
+    tile.name = user.user_name;
+    tile.mic = tile.local ? !data.mute_audio() : user.is_mic_on;
+    tile.share = tile.local ? data.share_screen() : user.is_sharing;
+    tile.has_video = tile.local ? !data.mute_video() : user.is_camera_on;
+    tile.highlight = data.high_light() == user.user_handle;
+    return tile;
+}
+
+int VideoCallManager::applyTile(size_t slot, const TileState& next) {
+    auto& ins = instance();
+    auto& shown = ins.tiles_[slot];
+    auto dirty = shown.diff(next);
+    if (!dirty) return 0;
+
+    // kCanvas only marks the new user, bindVideos has already bound the canvas
+    auto video = ins.videos_[slot];
+    if (dirty & TileState::kName) {
+        video->setUserName(next.local ? QObject::tr("xxx(me)").arg(QString::fromStdString(next.name))
+            : QString::fromStdString(next.name));
+    }
+    if (dirty & TileState::kMic) video->setMic(next.mic);
+    if (dirty & TileState::kShare) video->setShare(next.share);
+    if (dirty & TileState::kVideo) video->setHasVideo(next.has_video);
+    if (dirty & TileState::kHighlight) video->setHighLight(next.highlight);
+    shown = next;
+
+    int mutations = 0;
+    for (int field = 0; field < TileState::kFieldCount; field++) {
+        if (dirty & (1u << field)) {
+            ins.tile_stats_.fields[field]++;
+            mutations++;
+        }
+    }
+    return mutations;
+}
+
 std::shared_ptr<VideoCallVideoWidget> VideoCallManager::getCurrentVideo() {
-    int i = 0;
-    for (auto& user : videocall::DataMgr::instance().users()) {
-        if (user.user_id == videocall::DataMgr::instance().user_id()) {
-            return instance().videos_[i];
+    auto& ins = instance();
+    for (size_t slot = 0; slot < ins.tiles_.size(); slot++) {
+        if (ins.tiles_[slot].local) {
+            return ins.videos_[slot];
         }
-        i++;
     }
     return std::shared_ptr<VideoCallVideoWidget>();
 }
@@ -426,8 +504,48 @@ void VideoCallManager::updateData() {
         return;
     }
     instance().updating = true;
-    instance().main_page_->updateVideoWidget();
+    // Only joins and leaves change the layout, other changes just refresh the bound tiles
+    auto& participants = DataMgr::instance().participants();
+    bool relayout = instance().relayout_pending_;
+    instance().relayout_pending_ = false;
+    for (const auto& change : participants.takeChanges()) {
+        if (change.changes & (ParticipantStore::kJoined | ParticipantStore::kLeft)) relayout = true;
+    }
+    if (relayout) {
+        PublishPolicy::instance().setParticipantCount(static_cast<int>(participants.size()));
+        SubscriptionManager::instance().setParticipantCount(static_cast<int>(participants.size()));
+        instance().main_page_->updateVideoWidget();
+    }
+    else {
+        refreshVideos();
+    }
     instance().updating = false;
+    updateSubscriptions();
+}
+
+void VideoCallManager::updateSubscriptions() {
+    if (instance().subscription_update_pending_) {
+        return;
+    }
+    instance().subscription_update_pending_ = true;
+    // Layouts only settle after the current event, so visibility is read on the next turn
+    QTimer::singleShot(0, &instance(), [] {
+        auto& ins = instance();
+        ins.subscription_update_pending_ = false;
+        std::vector<SubscriptionManager::VisibleTile> visible;
+        for (size_t i = 0; i < ins.videos_.size(); i++) {
+            auto& video = ins.videos_[i];
+            if (ins.tiles_[i].uid == vrd::kInvalidIdHandle) continue;
+            if (video->isVisible() && !video->visibleRegion().isEmpty()) {
+                SubscriptionManager::VisibleTile tile;
+                tile.uid = ins.tiles_[i].uid;
+                tile.width = qRound(video->width() * video->devicePixelRatioF());
+                tile.height = qRound(video->height() * video->devicePixelRatioF());
+                visible.push_back(tile);
+            }
+        }
+        SubscriptionManager::instance().setVisibleTiles(visible);
+    });
 }
 
 void VideoCallManager::videoCallNotify() {
@@ -439,7 +557,7 @@ void VideoCallManager::videoCallNotify() {
 
 void VideoCallManager::stopScreen() {
     videocall::DataMgr::instance().setShareScreen(false);
-    videocall::DataMgr::instance().ref_room().screen_shared_uid = "";
+    videocall::DataMgr::instance().updateRoom([](VideoCallRoom& room) { room.screen_shared_uid.clear(); });
     showRoom();
     instance().share_button_bar_->hide();
     vrd::VideoCallSession::instance().stopScreenShare([](int code) {
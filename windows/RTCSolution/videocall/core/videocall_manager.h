@@ -8,6 +8,7 @@
 #include <memory>
 #include "videocall/core/videocall_rtc_wrap.h"
 #include "videocall/core/videocall_model.h"
+#include "videocall/core/tile_view_model.h"
 #include "videocall/core/videocall_video_widget.h"
 
 class VideoCallLoginWidget;
@@ -16,9 +17,9 @@ class VideoCallMainPage;
 class VideoCallSetting;
 class ShareButtonBar;
 class VideoCallData;
+class QTimer;
 
 namespace videocall {
-    static constexpr int kMaxShowWidgetNum = 12;
 
 /**
 * Scene page management class
@@ -43,18 +44,30 @@ public:
     static void showShareControlBar();
 
     static int showCallExpDlg(QWidget* parent = nullptr);
-    static void setLocalVideoWidget(const videocall::User& user, int idx);
-    static void setRemoteVideoWidget(const videocall::User& user, int idx);
     static void setRemoteScreenVideoWidget(const videocall::User& user);
 
     static void initRoom();
     static void showRoom();
     static QWidget* currentWidget();
     static void hideRoom();
+    // Pooled tiles, only the first bound ones show a user
     static std::vector<std::shared_ptr<VideoCallVideoWidget>> getVideoList();
+    // Shows users [first, first + count) on the first count pooled tiles, more tiles are created on demand.
+    // Tiles that change user drop the old user's canvas, so the SDK only renders into bound tiles
+    static void bindVideos(int first, int count);
+    // Binds the current range again after the user list or a user's state changed
+    static void refreshVideos();
+    static TileUpdateStats tileStats();
+    // Writes the tile, subscription and canvas binding counters to the log, every minute while in a room and once
+    // on leaving
+    static void dumpStats();
+    // Tile of the local user, empty when the local user is not on the current page
     static std::shared_ptr<VideoCallVideoWidget> getCurrentVideo();
     static std::shared_ptr<VideoCallVideoWidget> getScreenVideo();
+    // Drains the participant change feed, joins and leaves relayout the grid, anything else rebinds the tiles
     static void updateData();
+    // Hands the on-screen tiles and their sizes to the SubscriptionManager, coalesced to one pass per event loop turn
+    static void updateSubscriptions();
     static void videoCallNotify();
     static void stopScreen();
 
@@ -65,16 +78,30 @@ signals:
     void sigReturnMainPage();
 
 private:
+    static TileState wantedTile(const User& user);
+    // Pushes the fields of next that differ from what the tile shows, returns the number of widget mutations
+    static int applyTile(size_t slot, const TileState& next);
+
     std::unique_ptr<VideoCallLoginWidget> login_widget_;
     std::unique_ptr<VideoCallSetting> setting_page_;
     std::unique_ptr<VideoCallShareWidget> share_widget_;
     std::unique_ptr<ShareButtonBar> share_button_bar_;
     std::unique_ptr<VideoCallMainPage> main_page_;
+    static constexpr int kStatsDumpInterval = 60 * 1000;
+    QTimer* stats_dump_timer_ = nullptr;
     std::vector<std::shared_ptr<VideoCallVideoWidget>> videos_;
+    // Last state applied to each pooled tile, uid is kInvalidIdHandle when the tile is unused
+    std::vector<TileState> tiles_;
+    TileUpdateStats tile_stats_;
+    int bound_first_ = 0;
+    int bound_count_ = 0;
     std::shared_ptr<VideoCallVideoWidget> screen_widget_;
     QPointer<VideoCallData> data_page_;
     QWidget* current_widget_ = nullptr;
     bool updating = false;
+    bool subscription_update_pending_ = false;
+    // Set when the views were reset and need a layout pass whatever the participant changes say
+    bool relayout_pending_ = true;
 };
 
 }  // namespace videocall
@@ -1,8 +1,11 @@
 #pragma once
+#include <functional>
 #include <unordered_map>
 #include <vector>
 #include <string>
 
+#include "core/id_table.h"
+
 namespace videocall {
     struct VideoResolution {
         int width = 640;
@@ -25,10 +28,14 @@ namespace videocall {
         VideoConfiger camera{ {1280, 720}, 15, 500 };
         AudioQuality audio_quality{ kAudioQualityStandard };
         bool enable_camera_mirror = true;
+        // Page size of the gallery once the room has more than 4 people, 2 to 4 columns and rows
+        int grid_columns = 3;
     };
 
     struct User {
         std::string user_id;
+        // Interned user_id, compare this instead of the string
+        vrd::IdHandle user_handle{ vrd::kInvalidIdHandle };
         std::string user_name;
         // UTC/GMT join call time
         int64_t created_at{ 0 };
@@ -38,6 +45,38 @@ namespace videocall {
         int audio_volume{ 0 };
     };
 
+    /**
+     * Folds one volume report into the user list and picks the speaker to highlight
+     * Feed every speaker of the report to apply(), then read highlight()
+     */
+    class SpeakerVolumes {
+    public:
+        // Reports at or below this level are background noise and never highlighted
+        static constexpr unsigned int kHighlightThreshold = 5;
+
+        // Stores the reported volume on the user
+        using VolumeSink = std::function<void(vrd::IdHandle uid, unsigned int volume)>;
+
+        explicit SpeakerVolumes(VolumeSink sink) : sink_(std::move(sink)) {}
+
+        void apply(vrd::IdHandle uid, unsigned int volume) {
+            sink_(uid, volume);
+            if (loudest_ == vrd::kInvalidIdHandle || volume > loudest_volume_) {
+                loudest_ = uid;
+                loudest_volume_ = volume;
+            }
+        }
+
+        vrd::IdHandle highlight() const {
+            return loudest_volume_ > kHighlightThreshold ? loudest_ : vrd::kInvalidIdHandle;
+        }
+
+    private:
+        VolumeSink sink_;
+        vrd::IdHandle loudest_{ vrd::kInvalidIdHandle };
+        unsigned int loudest_volume_{ 0 };
+    };
+
     struct VideoCallRoom {
       std::string room_id;
       std::string screen_shared_uid;
@@ -47,6 +86,8 @@ namespace videocall {
 
     struct StreamInfo {
         std::string user_id;
+        // Interned user_id, compare this instead of the string
+        vrd::IdHandle user_handle{ vrd::kInvalidIdHandle };
         std::string user_name;
         // Resolution width value
         int width;
@@ -3,10 +3,14 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QTimer>
 #include <algorithm>
 
 #include "core/util_tip.h"
+#include "videocall/core/canvas_bindings.h"
 #include "videocall/core/data_mgr.h"
+#include "videocall/core/publish_policy.h"
+#include "videocall/core/subscription_manager.h"
 #include "videocall/core/videocall_manager.h"
 
 /**
@@ -34,32 +38,40 @@ int VideoCallRtcEngineWrap::init() {
         &instance(), &VideoCallRtcEngineWrap::onUserLeaveVideoCall);
 
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnUserStartVideoCapture,
-        &instance(), [=](const std::string& roomId, const std::string& userId) {
-            emit instance().onUserCameraStatusChange(userId, true);
+        &instance(), [=](vrd::IdHandle room_id, vrd::IdHandle user_id) {
+            emit instance().onUserCameraStatusChange(user_id, true);
         });
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnUserStopVideoCapture,
-        &instance(), [=](const std::string& roomId, const std::string& userId) {
-            emit instance().onUserCameraStatusChange(userId, false);
+        &instance(), [=](vrd::IdHandle room_id, vrd::IdHandle user_id) {
+            emit instance().onUserCameraStatusChange(user_id, false);
         });
 
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnUserPublishStream,
-        &instance(), [](const std::string& user_id, bytertc::MediaStreamType type) {
+        &instance(), [](vrd::IdHandle user_id, bytertc::MediaStreamType type) {
             if (type & bytertc::kMediaStreamTypeAudio) {
                 instance().onUserMicStatusChange(user_id, true);
             }
+            if (type & bytertc::kMediaStreamTypeVideo) {
+                videocall::SubscriptionManager::instance().onVideoPublished(user_id, true);
+            }
         });
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnUserUnPublishStream,
-        &instance(), [](const std::string& uid, bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason) {
+        &instance(), [](vrd::IdHandle uid, bytertc::MediaStreamType type, bytertc::StreamRemoveReason reason) {
             if (type & bytertc::MediaStreamType::kMediaStreamTypeAudio) {
                 instance().onUserMicStatusChange(uid, false);
             }
+            if (type & bytertc::MediaStreamType::kMediaStreamTypeVideo) {
+                videocall::SubscriptionManager::instance().onVideoPublished(uid, false);
+            }
         });
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnUserPublishScreen,
-		&instance(), [=](std::string uid, bytertc::MediaStreamType type) {
+		&instance(), [=](vrd::IdHandle uid, bytertc::MediaStreamType type) {
+			videocall::SubscriptionManager::instance().onScreenPublished(uid, true);
 			emit instance().sigOnShareScreenStatusChanged(uid, true);
 		});
     QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnUserUnPublishScreen,
-        &instance(), [=](std::string uid, bytertc::MediaStreamType type) {
+        &instance(), [=](vrd::IdHandle uid, bytertc::MediaStreamType type) {
+			videocall::SubscriptionManager::instance().onScreenPublished(uid, false);
 			emit instance().sigOnShareScreenStatusChanged(uid, false);
         });
 
@@ -106,10 +118,22 @@ int VideoCallRtcEngineWrap::init() {
                 }
         });
 
+    QObject::connect(
+        &RtcEngineWrap::instance(), &RtcEngineWrap::sigOnDeviceListChanged,
+        &engine_wrap,
+        [=](vrd::DeviceKind kind) {
+                if (kind == vrd::DeviceKind::kVideoCapture) {
+                    instance().onVideoDevicesChanged();
+                }
+                else if (kind == vrd::DeviceKind::kAudioInput) {
+                    instance().onAudioDevicesChanged();
+                }
+        });
+
     QObject::connect(
         &RtcEngineWrap::instance(), &RtcEngineWrap::sigOnRemoteAudioVolumeIndication,
         &engine_wrap,
-        [=](std::vector<AudioVolumeInfoWrap> speakers, int totalVolume) {
+        [=](AudioVolumeSnapshot speakers, int totalVolume) {
             videocall::DataMgr::instance().setRemoteVolumes(std::move(speakers));
             emit instance().sigOnAudioVolumeUpdate();
         });
@@ -117,58 +141,54 @@ int VideoCallRtcEngineWrap::init() {
     QObject::connect(
         &RtcEngineWrap::instance(), &RtcEngineWrap::sigOnLocalAudioVolumeIndication,
         &engine_wrap,
-        [=](std::vector<AudioVolumeInfoWrap> speakers) {
+        [=](AudioVolumeSnapshot speakers) {
             videocall::DataMgr::instance().setLocalVolumes(std::move(speakers));
             emit instance().sigOnAudioVolumeUpdate();
         });
 
-	
-
-	QObject::connect(&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnLocalStreamStats,
-		&engine_wrap, [=](bytertc::LocalStreamStats stats) {
-			videocall::StreamInfo info =
-				videocall::DataMgr::instance().local_stream_info();
-			info.audio_kbitrate = stats.audio_stats.send_kbitrate;
-			info.video_kbitrate = stats.video_stats.sent_kbitrate;
-			info.video_fps = stats.video_stats.sent_frame_rate;
-			info.width = stats.video_stats.encoded_frame_width;
-			info.height = stats.video_stats.encoded_frame_height;
-			info.audio_loss_rate = stats.audio_stats.audio_loss_rate;
-			info.video_loss_rate = stats.video_stats.video_loss_rate;
-			info.audio_delay = stats.audio_stats.rtt;
-			info.video_delay = stats.video_stats.rtt;
-			info.natwork_quality = stats.local_rx_quality;
-
-			videocall::DataMgr::instance().setLocalStreamInfo(info);
-			emit instance().sigUpdateInfo(videocall::DataMgr::instance().user_id());
-		});
+    videocall::CanvasBindings::instance().setRequestSink(
+        [](const videocall::CanvasBindings::Request& request) {
+            const auto& key = request.key;
+            if (key.screen) {
+                return setRemoteScreenView(vrd::IdTable::instance().str(key.uid), request.view);
+            }
+            if (key.local) {
+                return setupLocalView(request.view, bytertc::RenderMode::kRenderModeHidden, "local");
+            }
+            return setupRemoteView(request.view, bytertc::RenderMode::kRenderModeHidden,
+                vrd::IdTable::instance().str(key.uid));
+        });
 
-	QObject::connect(
-		&RtcEngineWrap::instance(), &RtcEngineWrap::sigOnRemoteStreamStats,
-		&engine_wrap, [=](RemoteStreamStatsWrap stats) {
-			auto& infos = videocall::DataMgr::instance().ref_remote_stream_infos();
-			auto iter = std::find_if(infos.begin(), infos.end(), [&stats](const videocall::StreamInfo& streamInfo) {
-				return streamInfo.user_id == stats.uid;
-				});
-			if (iter != infos.end()) {
-				iter->video_kbitrate = stats.video_stats.received_kbitrate;
-				iter->audio_kbitrate = stats.audio_stats.received_kbitrate;
-				iter->audio_loss_rate = stats.audio_stats.audio_loss_rate * 100;
-				iter->video_loss_rate = stats.video_stats.video_loss_rate * 100;
-				iter->video_delay = stats.video_stats.rtt;
-				iter->audio_delay = stats.audio_stats.rtt;
-				iter->video_fps = stats.video_stats.renderer_output_frame_rate;
-				iter->natwork_quality = stats.remote_rx_quality;
-                iter->width = stats.video_stats.width;
-                iter->height = stats.video_stats.height;
-
-				emit instance().sigUpdateInfo(stats.uid);
+    videocall::SubscriptionManager::instance().setRequestSink(
+        [](const videocall::SubscriptionManager::Request& request) {
+            const auto& uid = vrd::IdTable::instance().str(request.uid);
+            if (!request.subscribe) {
+                return RtcEngineWrap::instance().unSubscribeVideoStream(uid, request.is_screen,
+                    bytertc::MediaStreamType::kMediaStreamTypeVideo);
             }
-		});
+            // Audio is already auto-subscribed, asking for both only adds the video
+            bytertc::SubscribeConfig config;
+            config.is_screen = request.is_screen;
+            config.sub_video = true;
+            config.sub_audio = true;
+            config.video_index = request.is_screen ? 0 : request.layer;
+            return RtcEngineWrap::instance().subscribeVideoStream(uid, config);
+        });
+
+	// Stream stats are pulled at a fixed rate instead of being pushed per report
+	if (!engine_wrap.stats_timer_) {
+		engine_wrap.stats_timer_ = new QTimer(&engine_wrap);
+		QObject::connect(engine_wrap.stats_timer_, &QTimer::timeout,
+			&engine_wrap, &VideoCallRtcEngineWrap::pullStreamStats);
+	}
+	engine_wrap.stats_timer_->start(kStreamStatsRefreshInterval);
 	return ret;
 }
 
 int VideoCallRtcEngineWrap::unInit() {
+	if (instance().stats_timer_) {
+		instance().stats_timer_->stop();
+	}
 	QObject::disconnect(&RtcEngineWrap::instance(), nullptr, &instance(), nullptr);
 	RtcEngineWrap::instance().resetDevices();
 	return 0;
@@ -230,24 +250,25 @@ int VideoCallRtcEngineWrap::login(const std::string& roomid,
   auto infoStdString = std::string(infoStr.toUtf8());
 
   bytertc::UserInfo user = {uid.c_str(), infoStdString.c_str()};
+  // Remote cameras are subscribed by the gallery for the tiles it shows
+  videocall::SubscriptionManager::instance().reset(vrd::IdTable::instance().intern(uid));
+  // Publishes the PublishPolicy ladder, subscribers pick a layer per tile
+  RtcEngineWrap::instance().enableSimulcastMode(true);
   return RtcEngineWrap::instance().joinRoom(
       token, roomid, user,
-      bytertc::RoomProfileType::kRoomProfileTypeCommunication);
+      bytertc::RoomProfileType::kRoomProfileTypeCommunication, ManualSubscribeMode);
 }
 
 int VideoCallRtcEngineWrap::logout() {
   auto& engine_wrap = instance();
+  videocall::SubscriptionManager::instance().reset(vrd::kInvalidIdHandle);
   return RtcEngineWrap::instance().leaveRoom();
 }
 
 int VideoCallRtcEngineWrap::setVideoProfiles(const videocall::VideoConfiger& vc) {
-    auto& engine_wrap = instance();
-    bytertc::VideoEncoderConfig config;
-    config.width = vc.resolution.width;
-    config.height = vc.resolution.height;
-    config.frame_rate = vc.fps;
-    config.max_bitrate = vc.kbps;
-    return RtcEngineWrap::instance().setVideoProfiles(config);
+    // The setting caps the simulcast ladder, the room size decides the rest
+    videocall::PublishPolicy::instance().setCameraProfile(vc);
+    return 0;
 }
 
 int VideoCallRtcEngineWrap::setAudioProfiles(const videocall::AudioQuality& aq) {
@@ -372,58 +393,56 @@ int VideoCallRtcEngineWrap::feedBack(const std::string& str) {
 
 void VideoCallRtcEngineWrap::onVideoStateChanged(std::string device_id,
     bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error) {
-	std::vector<RtcDevice> devices;
-	VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
-	if ((devices.empty() || error == bytertc::kMediaDeviceErrorDeviceNoPermission)
+	if (error == bytertc::kMediaDeviceErrorDeviceNoPermission
 		&& !videocall::DataMgr::instance().mute_video()) {
-		if (error == bytertc::kMediaDeviceErrorDeviceNoPermission) {
-			vrd::util::showToastInfo(QObject::tr("no_camera_permission").toStdString());
-		}
+		vrd::util::showToastInfo(QObject::tr("no_camera_permission").toStdString());
 		videocall::DataMgr::instance().setMuteVideo(true);
 		VideoCallRtcEngineWrap::muteLocalVideo(true);
 		emit instance().sigUpdateVideo();
-
-	} else {
-		VideoCallRtcEngineWrap::muteLocalVideo(
-			videocall::DataMgr::instance().mute_video());
 	}
 
+	// The device list itself is refreshed in the background, see onVideoDevicesChanged
 	switch (device_state) {
 		// Insert a new device
 		case bytertc::kMediaDeviceStateAdded:
 			vrd::util::showToastInfo(QObject::tr("new_camera_plugin").toStdString());
-			emit instance().sigUpdateVideoDevices();
 			break;
 		// Pull out the device
 		case bytertc::kMediaDeviceStateRemoved:
 			vrd::util::showToastInfo(QObject::tr("camera_unplugged").toStdString());
-			emit instance().sigUpdateVideoDevices();
-			VideoCallRtcEngineWrap::setVideoCaptureDevice(RtcEngineWrap::instance().getCurrentVideoCaptureDeviceIndex());
+			reselect_camera_ = true;
 			break;
 		default:
 			break;
 	}
 }
 
+void VideoCallRtcEngineWrap::onVideoDevicesChanged() {
+	std::vector<RtcDevice> devices;
+	VideoCallRtcEngineWrap::getVideoCaptureDevices(devices);
+	if (devices.empty() && !videocall::DataMgr::instance().mute_video()) {
+		videocall::DataMgr::instance().setMuteVideo(true);
+		VideoCallRtcEngineWrap::muteLocalVideo(true);
+		emit instance().sigUpdateVideo();
+	} else {
+		VideoCallRtcEngineWrap::muteLocalVideo(
+			videocall::DataMgr::instance().mute_video());
+	}
+
+	if (reselect_camera_) {
+		reselect_camera_ = false;
+		VideoCallRtcEngineWrap::setVideoCaptureDevice(RtcEngineWrap::instance().getCurrentVideoCaptureDeviceIndex());
+	}
+	emit instance().sigUpdateVideoDevices();
+}
+
 void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
     bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error) {
-    std::vector<RtcDevice> devices;
-    VideoCallRtcEngineWrap::getAudioInputDevices(devices);
-    if ((devices.empty()) && !videocall::DataMgr::instance().mute_audio()) {
-        videocall::DataMgr::instance().setMuteAudio(true);
-        VideoCallRtcEngineWrap::muteLocalAudio(true);
-        emit instance().sigUpdateAudio();
-    }
-    else {
-        VideoCallRtcEngineWrap::muteLocalAudio(
-            videocall::DataMgr::instance().mute_audio());
-    }
-
+	// The device list itself is refreshed in the background, see onAudioDevicesChanged
 	switch (device_state) {
 	// Insert a new device
 	case bytertc::kMediaDeviceStateAdded:  
 		vrd::util::showToastInfo(QObject::tr("new_mic_plugin").toStdString());
-		emit instance().sigUpdateAudioDevices();
 		break;
 	// Pull out the device
 	case bytertc::kMediaDeviceStateRemoved:
@@ -435,7 +454,6 @@ void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
 			RtcEngineWrap::instance().followSystemCaptureDevice(true);
 		}
         vrd::util::showToastInfo(QObject::tr("mic_unplugged").toStdString());
-        emit instance().sigUpdateAudioDevices();
 		break;
 	}
     case bytertc::kMediaDeviceStateRuntimeError:
@@ -459,79 +477,102 @@ void VideoCallRtcEngineWrap::onAudioStateChanged(std::string device_id,
 	}
 }
 
+void VideoCallRtcEngineWrap::onAudioDevicesChanged() {
+    std::vector<RtcDevice> devices;
+    VideoCallRtcEngineWrap::getAudioInputDevices(devices);
+    if (devices.empty() && !videocall::DataMgr::instance().mute_audio()) {
+        videocall::DataMgr::instance().setMuteAudio(true);
+        VideoCallRtcEngineWrap::muteLocalAudio(true);
+        emit instance().sigUpdateAudio();
+    }
+    else {
+        VideoCallRtcEngineWrap::muteLocalAudio(
+            videocall::DataMgr::instance().mute_audio());
+    }
+    emit instance().sigUpdateAudioDevices();
+}
+
 void VideoCallRtcEngineWrap::onUserJoinedVideoCall(UserInfoWrap user_info, int elapsed) {
+	const auto& uid = vrd::IdTable::instance().str(user_info.uid);
 	videocall::User newUser;
-	newUser.user_id = user_info.uid;
+	newUser.user_id = uid;
+	newUser.user_handle = user_info.uid;
 
     auto infoArray = QByteArray(user_info.extra_info.data(), 
 		static_cast<int>(user_info.extra_info.size()));
     auto infoJsonObj = QJsonDocument::fromJson(infoArray).object();
 	newUser.user_name = std::string(infoJsonObj["user_name"].toString().toUtf8());
-	if (newUser.user_name == "") newUser.user_name = user_info.uid;
-
-    auto& users = videocall::DataMgr::instance().ref_users();
-    auto iter = std::find_if(users.begin(), users.end(),
-        [newUser](const videocall::User& user) {
-            return user.user_id == newUser.user_id;
-        });
-    if (iter == users.end()) {
-        users.push_back(newUser);
-    }
+	if (newUser.user_name == "") newUser.user_name = uid;
 
-	auto& remoteStreamInfos = videocall::DataMgr::instance().ref_remote_stream_infos();
-	videocall::StreamInfo info;
-	info.user_id = user_info.uid;
-	info.user_name = std::string(infoJsonObj["user_name"].toString().toUtf8());
-	remoteStreamInfos.push_back(info);
+    // A user already in the room keeps its place and stats
+    videocall::DataMgr::instance().participants().add(newUser);
 	emit sigUpdateMainPageData();
 }
 
-void VideoCallRtcEngineWrap::onUserLeaveVideoCall(std::string uid, 
+void VideoCallRtcEngineWrap::onUserLeaveVideoCall(vrd::IdHandle uid, 
 	bytertc::UserOfflineReason reason) {
 
-    auto& users = videocall::DataMgr::instance().ref_users();
-    auto iter = std::find_if(users.begin(), users.end(),
-        [uid](const videocall::User& user) {
-			return user.user_id == uid;
-        });
-    if (iter != users.end()) {
-		users.erase(iter);
-    }
-
-    auto& remoteStreamInfos = videocall::DataMgr::instance().ref_remote_stream_infos();
-    auto infoIter = std::find_if(
-		remoteStreamInfos.begin(), remoteStreamInfos.end(),
-        [uid](const videocall::StreamInfo& info) { return info.user_id == uid; });
-    if (infoIter != remoteStreamInfos.end()) {
-		remoteStreamInfos.erase(infoIter);
-    }
+    videocall::DataMgr::instance().participants().remove(uid);
+    videocall::SubscriptionManager::instance().onUserLeft(uid);
 	emit sigUpdateMainPageData();
 }
 
-void VideoCallRtcEngineWrap::onUserCameraStatusChange(std::string uid, bool enabled) {
-    auto& users = videocall::DataMgr::instance().ref_users();
-    auto iter = std::find_if(users.begin(), users.end(),
-        [uid](const videocall::User& user) {
-            return user.user_id == uid;
-        });
-    if (iter != users.end()) {
-		iter->is_camera_on = enabled;
-    }
+void VideoCallRtcEngineWrap::onUserCameraStatusChange(vrd::IdHandle uid, bool enabled) {
+    videocall::DataMgr::instance().participants().update(uid, videocall::ParticipantStore::kUpdated,
+        [enabled](videocall::Participant& participant) { participant.user.is_camera_on = enabled; });
 	emit sigUpdateMainPageData();
 }
 
-void VideoCallRtcEngineWrap::onUserMicStatusChange(std::string uid, bool enabled) {
-    auto& users = videocall::DataMgr::instance().ref_users();
-    auto iter = std::find_if(users.begin(), users.end(),
-        [uid](const videocall::User& user) {
-            return user.user_id == uid;
-        });
-    if (iter != users.end()) {
-		iter->is_mic_on = enabled;
-    }
+void VideoCallRtcEngineWrap::onUserMicStatusChange(vrd::IdHandle uid, bool enabled) {
+    videocall::DataMgr::instance().participants().update(uid, videocall::ParticipantStore::kUpdated,
+        [enabled](videocall::Participant& participant) { participant.user.is_mic_on = enabled; });
 	emit sigUpdateMainPageData();
 }
 
+void VideoCallRtcEngineWrap::pullStreamStats() {
+	bytertc::LocalStreamStats stats;
+	uint64_t version = 0;
+	if (RtcEngineWrap::instance().latestLocalStreamStats(false, stats, &version)
+		&& version != local_stats_version_) {
+		local_stats_version_ = version;
+		videocall::DataMgr::instance().updateLocalStreamInfo([&stats](videocall::StreamInfo& info) {
+			info.audio_kbitrate = stats.audio_stats.send_kbitrate;
+			info.video_kbitrate = stats.video_stats.sent_kbitrate;
+			info.video_fps = stats.video_stats.sent_frame_rate;
+			info.width = stats.video_stats.encoded_frame_width;
+			info.height = stats.video_stats.encoded_frame_height;
+			info.audio_loss_rate = stats.audio_stats.audio_loss_rate;
+			info.video_loss_rate = stats.video_stats.video_loss_rate;
+			info.audio_delay = stats.audio_stats.rtt;
+			info.video_delay = stats.video_stats.rtt;
+			info.natwork_quality = stats.local_rx_quality;
+		});
+		emit sigUpdateInfo(videocall::DataMgr::instance().user_id());
+	}
+
+	RtcEngineWrap::instance().collectRemoteStreamStats(remote_stats_cursor_,
+		[this](const RemoteStreamStatsWrap& stats) {
+			if (stats.is_screen) return;
+			auto updated = videocall::DataMgr::instance().participants().update(stats.uid,
+				videocall::ParticipantStore::kStats, [&stats](videocall::Participant& participant) {
+				auto& info = participant.stats;
+				info.video_kbitrate = stats.video_stats.received_kbitrate;
+				info.audio_kbitrate = stats.audio_stats.received_kbitrate;
+				info.audio_loss_rate = stats.audio_stats.audio_loss_rate * 100;
+				info.video_loss_rate = stats.video_stats.video_loss_rate * 100;
+				info.video_delay = stats.video_stats.rtt;
+				info.audio_delay = stats.audio_stats.rtt;
+				info.video_fps = stats.video_stats.renderer_output_frame_rate;
+				info.natwork_quality = stats.remote_rx_quality;
+				info.width = stats.video_stats.width;
+				info.height = stats.video_stats.height;
+			});
+			if (updated) {
+				emit sigUpdateInfo(vrd::IdTable::instance().str(stats.uid));
+			}
+		});
+}
+
 VideoCallRtcEngineWrap::VideoCallRtcEngineWrap() : QObject(nullptr) {}
 
 VideoCallRtcEngineWrap::~VideoCallRtcEngineWrap() {}
@@ -5,6 +5,8 @@
 #include "core/rtc_engine_wrap.h"
 #include "videocall/core/videocall_model.h"
 
+class QTimer;
+
 /**
 * The RTC interface and callback encapsulation class that need to be used in this scene
 */
@@ -70,14 +72,18 @@ public:
         bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error);
     void onAudioStateChanged(std::string device_id,
         bytertc::MediaDeviceState device_state, bytertc::MediaDeviceError error);
+    // Device lists republished by the registry after a device change
+    void onVideoDevicesChanged();
+    void onAudioDevicesChanged();
     void onUserJoinedVideoCall(UserInfoWrap user_info, int elapsed);
-    void onUserLeaveVideoCall(std::string uid, bytertc::UserOfflineReason reason);
-    void onUserCameraStatusChange(std::string uid, bool enabled);
-    void onUserMicStatusChange(std::string uid, bool enabled);
+    void onUserLeaveVideoCall(vrd::IdHandle uid, bytertc::UserOfflineReason reason);
+    void onUserCameraStatusChange(vrd::IdHandle uid, bool enabled);
+    void onUserMicStatusChange(vrd::IdHandle uid, bool enabled);
+    void pullStreamStats();
 
 signals:
 	void sigOnRoomStateChanged(std::string room_id, std::string uid, int state, std::string extra_info);
-	void sigOnShareScreenStatusChanged(std::string uid, bool isSharing);
+	void sigOnShareScreenStatusChanged(vrd::IdHandle uid, bool isSharing);
 	void sigUpdateAudio();
 	void sigUpdateVideo();
 	void sigUpdateVideoDevices();
@@ -89,4 +95,14 @@ signals:
  protected:
 	 VideoCallRtcEngineWrap();
 	 ~VideoCallRtcEngineWrap();
+
+ private:
+	 // Refresh period of the call data page, the SDK reports stream stats every 2s
+	 static constexpr int kStreamStatsRefreshInterval = 1000;
+
+	 QTimer* stats_timer_ = nullptr;
+	 RemoteStreamStatsTable::Cursor remote_stats_cursor_;
+	 uint64_t local_stats_version_ = 0;
+	 // A camera was unplugged, select the current camera again once the list is refreshed
+	 bool reselect_camera_ = false;
 };
@@ -87,16 +87,17 @@ void VideoCallSession::joinCall( const std::string& userId,
         auto token = std::string(response["rtc_token"].toString().toUtf8());
         videocall::DataMgr::instance().setToken(token);
 
-        std::vector<videocall::User> users;
         videocall::User self;
         self.is_camera_on = !videocall::DataMgr::instance().mute_video();
         self.is_mic_on = !videocall::DataMgr::instance().mute_audio();
         self.is_sharing = false;
         self.created_at = room.duration;
         self.user_id = videocall::DataMgr::instance().user_id();
+        self.user_handle = videocall::DataMgr::instance().user_handle();
         self.user_name = videocall::DataMgr::instance().user_name();
-        users.push_back(std::move(self));
-        videocall::DataMgr::instance().setUsers(std::move(users));
+        auto& participants = videocall::DataMgr::instance().participants();
+        participants.clear();
+        participants.add(self);
 
         if (callback) {
             callback(code);
@@ -1,12 +1,15 @@
 #pragma once
-#include <QLabel>
-#include <QStackedWidget>
 #include <QWidget>
 
+namespace videocall {
+class TileSurface;
+}
+
 /**
 * Audio and video call video rendering block, including video and no video
 * 1, Render video or avatar
 * 2, Set username label and remote device status label
+* The overlay is painted by one TileSurface from cached pixmaps, setters never touch a stylesheet
 */
 class VideoCallVideoWidget : public QWidget {
 public:
@@ -22,56 +25,11 @@ public:
     void showVideo();
     void setHighLight(bool enabled);
     QPaintEngine* paintEngine() const { return nullptr; }
-    void setUserLogoSize();
-private:
-    QStackedWidget* stacked_widget_;
-
-class HasVideoWidget : public QWidget {
-public:
-    HasVideoWidget(QWidget* parent = nullptr);
-    ~HasVideoWidget() = default;
-    void* getVideoWinID();
-    void setVideoUpdateEnabled(bool enabled);
-    void setUserName(const QString& str);
-    void hideVideo();
-    void showVideo();
-    void setHighLight(bool enabled);
-    void setShare(bool enabled);
-    void setMic(bool enabled);
 
 protected:
+    // Tile size decides the simulcast layer the video is subscribed with
     void resizeEvent(QResizeEvent* e) override;
-    void showEvent(QShowEvent*) override;
-    void moveEvent(QMoveEvent*) override;
 
 private:
-    QWidget* info_content_;
-    QWidget* video_;
-    QLabel* lbl_share_logo_;
-    QLabel* lbl_user_name_;
-    QLabel* lbl_mic_state_;
-};
-
-class NoVideoWidget : public QWidget {
-public:
-    NoVideoWidget(QWidget* parent = nullptr);
-    ~NoVideoWidget() = default;
-
-    void setUserLogoSize();
-    void setUserName(const QString& str);
-    void setShare(bool enabled);
-    void setMic(bool enabled);
-    void setHighLight(bool enabled);
-protected:
-    void resizeEvent(QResizeEvent* e) override;
-    void showEvent(QShowEvent*) override;
-
-private:
-    QLabel* lbl_user_logo_;
-    QLabel* lbl_share_logo_;
-    QLabel* lbl_user_name_;
-    QLabel* lbl_mic_state_;
-    QWidget* info_content_;
-};
-
+    videocall::TileSurface* surface_;
 };
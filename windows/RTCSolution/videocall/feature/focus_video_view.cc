@@ -1,7 +1,9 @@
 #include "focus_video_view.h"
 #include "ui_focus_video_view.h"
 
+#include <algorithm>
 #include <QPainter>
+#include <QResizeEvent>
 #include <QScrollBar>
 #include <QStyleOption>
 #include <QTimer>
@@ -14,12 +16,13 @@ FocusVideoView::FocusVideoView(QWidget *parent)
     , ui(new Ui::FocusVideoView) {
 
     ui->setupUi(this);
-    ui->video_list->setLayout(new QVBoxLayout);
-    ui->video_list->layout()->setContentsMargins(0, 0, 0, 0);
-    ui->video_list->layout()->setSpacing(8);
     ui->big_view->setLayout(new QHBoxLayout);
     ui->big_view->layout()->setContentsMargins(0, 0, 0, 0);
     ui->big_view->layout()->setSpacing(0);
+    // Tiles scrolled out of the list are rebound to the users scrolled in
+    QObject::connect(ui->scrollArea->verticalScrollBar(), &QScrollBar::valueChanged, this, [this] {
+        layoutTiles();
+    });
 }
 
 FocusVideoView::~FocusVideoView() { 
@@ -28,30 +31,68 @@ FocusVideoView::~FocusVideoView() {
 
 void FocusVideoView::init() {
     auto list = videocall::VideoCallManager::getVideoList();
-    auto lay = ui->video_list->layout();
     for (int i = 0; i < list.size(); i++) {
-        lay->removeWidget(list[i].get());
-        list[i]->hide();
+        if (list[i]->parentWidget() == ui->video_list) {
+            list[i]->hide();
+        }
     }
     cnt_ = 0;
 }
 
 void FocusVideoView::showWidget(int cnt) {
-    auto list = videocall::VideoCallManager::getVideoList();
-    auto lay = ui->video_list->layout();
-    for (int i = cnt; i < cnt_; i++) {
-        list[i]->hide();
-    }
-    auto width = ui->scrollArea->width();
-    ui->big_view->layout()->addWidget(
-        videocall::VideoCallManager::getScreenVideo().get());
-    for (int i = 0; i < cnt; i++) {
-        lay->addWidget(list[i].get());
-        list[i]->setFixedSize(width, width / 16 * 9);
-        list[i]->show();
+    auto screen = videocall::VideoCallManager::getScreenVideo().get();
+    if (ui->big_view->layout()->indexOf(screen) < 0) {
+        ui->big_view->layout()->addWidget(screen);
     }
     cnt_ = cnt;
-    ui->video_list->layout()->setAlignment(Qt::AlignCenter);
+    layoutTiles();
+}
+
+void FocusVideoView::resizeEvent(QResizeEvent* e) {
+    QWidget::resizeEvent(e);
+    // The hidden page of the stack is resized too, it must not take the tiles from the grid
+    if (cnt_ > 0 && isVisible()) {
+        layoutTiles();
+    }
+}
+
+void FocusVideoView::layoutTiles() {
+    const int width = ui->scrollArea->viewport()->width();
+    const int height = width / 16 * 9;
+    const int pitch = height + kTileSpacing;
+    if (height <= 0) {
+        return;
+    }
+    ui->video_list->setMinimumHeight(std::max(0, cnt_ * pitch - kTileSpacing));
+
+    // Only the rows in the viewport plus one partially scrolled in get a tile
+    const int top = ui->scrollArea->verticalScrollBar()->value();
+    const int first = std::min(top / pitch, cnt_);
+    const int count = std::min(ui->scrollArea->viewport()->height() / pitch + 2, cnt_ - first);
+    videocall::VideoCallManager::bindVideos(first, count);
+    auto list = videocall::VideoCallManager::getVideoList();
+    for (int i = 0; i < static_cast<int>(list.size()); i++) {
+        auto video = list[i].get();
+        if (i >= count) {
+            if (video->parentWidget() == ui->video_list) video->hide();
+            continue;
+        }
+        // Rows that keep their tile and position are left alone
+        if (video->parentWidget() != ui->video_list) {
+            video->setParent(ui->video_list);
+        }
+        if (video->minimumSize() != QSize(width, height) || video->maximumSize() != QSize(width, height)) {
+            video->setFixedSize(width, height);
+        }
+        QPoint pos(0, (first + i) * pitch);
+        if (video->pos() != pos) {
+            video->move(pos);
+        }
+        if (video->isHidden()) {
+            video->show();
+        }
+    }
+    videocall::VideoCallManager::updateSubscriptions();
 }
 
 void FocusVideoView::wheelEvent(QWheelEvent *e) {
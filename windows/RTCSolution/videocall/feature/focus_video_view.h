@@ -11,7 +11,8 @@ class FocusVideoView;
 
 /**
 * The video rendering area class including shared content, 
-* the left side is the shared content, and the right side is the user's video arranged vertically
+* the left side is the shared content, and the right side is the user's video arranged vertically.
+* The list is virtual, only the rows in view hold a tile
 */
 class FocusVideoView : public QWidget {
   Q_OBJECT
@@ -25,8 +26,13 @@ class FocusVideoView : public QWidget {
 
  protected:
   void paintEvent(QPaintEvent *) override;
+  void resizeEvent(QResizeEvent *) override;
 
  private:
+  static constexpr int kTileSpacing = 8;
+
+  void layoutTiles();
+
   Ui::FocusVideoView* ui;
   int cnt_ = 0;
 };
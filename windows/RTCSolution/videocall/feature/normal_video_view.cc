@@ -1,28 +1,36 @@
 #include "normal_video_view.h"
 #include "ui_normal_video_view.h"
 
+#include <algorithm>
 #include <QPainter>
 #include <QStyleOption>
 #include <QTimer>
+#include <QBoxLayout>
 #include <QGridLayout>
 #include <QButtonGroup>
+#include <QPushButton>
 
+#include "videocall/core/data_mgr.h"
 #include "videocall/core/videocall_manager.h"
+#include "videocall/feature/tile_grid.h"
 
 NormalVideoView::NormalVideoView(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::NormalVideoView) {
     ui->setupUi(this);
-    auto group = new QButtonGroup(this);
-    group->addButton(ui->page1);
-    group->addButton(ui->page2);
-    group->addButton(ui->page3);
-
+    grid_.reset(new TileGrid(ui->gridLayout, this, [](QWidget* tile, bool shown) {
+        auto video = static_cast<VideoCallVideoWidget*>(tile);
+        if (shown) {
+            // The focus list fixes the tile size
+            video->setMinimumSize(0, 0);
+            video->setMaximumSize(16777215, 16777215);
+        }
+        video->setVideoUpdateEnabled(!shown);
+    }));
+    page_group_ = new QButtonGroup(this);
     ui->pageControlWidget->hide();
-    QObject::connect(ui->page1, &QPushButton::clicked, this, [this] {showWidgetWithIndex(0); });
-    QObject::connect(ui->page2, &QPushButton::clicked, this, [this] {showWidgetWithIndex(4); });
-    QObject::connect(ui->page3, &QPushButton::clicked, this, [this] {showWidgetWithIndex(8); });
-
+    QObject::connect(page_group_, static_cast<void (QButtonGroup::*)(QAbstractButton*)>(&QButtonGroup::buttonClicked),
+        this, [this](QAbstractButton* button) { showWidgetWithIndex(page_group_->id(button) * pageSize()); });
 }
 
 NormalVideoView::~NormalVideoView() {
@@ -31,124 +39,91 @@ NormalVideoView::~NormalVideoView() {
 
 void NormalVideoView::showWidget(int cnt, bool forceUpdated) {
     // If the number of people does not change, do not update
-    if (!forceUpdated && cnt == cnt_) { 
+    if (!forceUpdated && cnt == cnt_) {
         return;
     }
 
     cnt_ = cnt;
-    auto lay = ui->gridLayout;
-    auto list = videocall::VideoCallManager::getVideoList();
-    for (auto w : list) {
-        if (w) {
-            w->setMaximumSize(16777215, 16777215);
-        }
+    if (cnt > 4) {
+        ui->pageControlWidget->show();
+        updatePageButtons();
+        // Stay on the current page unless it no longer exists
+        showWidgetWithIndex(std::min(first_video_index_, (cnt - 1) / pageSize() * pageSize()));
+        return;
     }
 
-    if (cnt <= 4) {
-        ui->pageControlWidget->hide();
-        first_video_index_ = 0;
-
-        QLayoutItem* childItem;
-        while ((childItem = lay->takeAt(0)) != 0) {
-            if (auto widget = dynamic_cast<VideoCallVideoWidget*>(childItem->widget())) {
-                lay->removeWidget(widget);
-                widget->setVideoUpdateEnabled(true);
-                widget->hide();
-            }
-            else {
-                childItem->widget()->hide();
-                delete childItem;
-            }
-        }
-    }
+    ui->pageControlWidget->hide();
+    first_video_index_ = 0;
+    ui->gridLayout->setContentsMargins(cnt == 1 ? QMargins() : QMargins(8, 8, 8, 8));
+    videocall::VideoCallManager::bindVideos(0, cnt);
+    // One tile fills the view, two sit side by side, three and four share a 2x2 grid
+    grid_->apply(boundTiles(cnt), cnt == 1 ? 1 : 2, cnt);
+    videocall::VideoCallManager::updateSubscriptions();
+}
 
-    switch (cnt) {
-    case 1:
-        lay->setContentsMargins(0, 0, 0, 0);
-        lay->addWidget(list[0].get(), 0, 0);
-        list[0]->show();
-        list[0]->setVideoUpdateEnabled(false);
-        break;
-    case 2:
-        lay->setContentsMargins(8, 8, 8, 8);
-        lay->addWidget(list[0].get(), 0, 0);
-        lay->addWidget(list[1].get(), 0, 1);
-        list[0]->show();
-        list[1]->show();
-        list[0]->setVideoUpdateEnabled(false);
-        list[1]->setVideoUpdateEnabled(false);
-        break;
-    case 3:
-    case 4:
-        for (int i = 0; i < cnt; i++) {
-            lay->addWidget(list[i].get(), i / 2, i % 2);
-            list[i]->show();
-            list[i]->setVideoUpdateEnabled(false);
-        }
-        break;
-    default:
-        ui->pageControlWidget->show();
-        if (cnt < 9) {
-            ui->page1->show();
-            ui->page2->show();
-            ui->page3->hide();
-        }
-        else if (cnt <= 12) {
-            ui->page1->show();
-            ui->page2->show();
-            ui->page3->show();
-        }
-        showWidgetWithIndex(first_video_index_);
-        break;
+void NormalVideoView::showWidgetWithIndex(int firstIndex) {
+    const int page_size = pageSize();
+    videocall::VideoCallManager::bindVideos(firstIndex, page_size);
+    ui->gridLayout->setContentsMargins(8, 8, 8, 8);
+    grid_->apply(boundTiles(std::min(page_size, cnt_ - firstIndex)), columns_, page_size);
+    first_video_index_ = firstIndex;
+    if (auto button = page_group_->button(firstIndex / page_size)) {
+        button->setChecked(true);
     }
+    videocall::VideoCallManager::updateSubscriptions();
 }
 
-void NormalVideoView::showWidgetWithIndex(int firstIndex) {
-    auto lay = ui->gridLayout;
-    auto list = videocall::VideoCallManager::getVideoList();
+void NormalVideoView::init() {
+    grid_->clear();
+    cnt_ = 0;
+    first_video_index_ = 0;
+    setGridColumns(videocall::DataMgr::instance().setting()->grid_columns);
+    updatePageButtons();
+}
 
-    QLayoutItem* childItem;
-    while ((childItem = lay->takeAt(0)) != 0) {
-        if (auto widget = dynamic_cast<VideoCallVideoWidget*>(childItem->widget())) {
-            lay->removeWidget(widget);
-            widget->setVideoUpdateEnabled(true);
-            widget->hide();
-        }
-        else {
-            childItem->widget()->hide();
-            delete childItem;
-        }
+void NormalVideoView::setGridColumns(int columns) {
+    columns = std::max(2, std::min(columns, 4));
+    if (columns == columns_) return;
+    columns_ = columns;
+    // A hidden view is paged by the showWidget that brings it back, the focus view owns the tiles meanwhile
+    if (cnt_ > 4 && isVisible()) {
+        updatePageButtons();
+        showWidgetWithIndex(first_video_index_ / pageSize() * pageSize());
     }
+}
 
-    auto index = firstIndex;
-    for (int i = 0; i < 4; i++) {
-        if (index < cnt_) {
-            lay->addWidget(list[index].get(), i / 2, i % 2);
-            list[index]->show();
-            list[index]->setVideoUpdateEnabled(false);
-        }
-        else {
-            // Empty widget, only takes up space
-            auto placeHolder = new QWidget(this);
-            placeHolder->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-            lay->addWidget(placeHolder, i / 2, i % 2);
-            placeHolder->show();
-        }
-        index++;
-    }
-    first_video_index_ = firstIndex;
+int NormalVideoView::pageSize() const {
+    return columns_ * columns_;
 }
 
-void NormalVideoView::init() {
+std::vector<QWidget*> NormalVideoView::boundTiles(int count) const {
     auto list = videocall::VideoCallManager::getVideoList();
-    auto lay = ui->gridLayout;
-    for (int i = first_video_index_; i < first_video_index_ + 4; i++) {
-        lay->removeWidget(list[i].get());
-        list[i]->hide();
+    std::vector<QWidget*> tiles;
+    for (int i = 0; i < count && i < static_cast<int>(list.size()); i++) {
+        tiles.push_back(list[i].get());
+    }
+    return tiles;
+}
+
+void NormalVideoView::updatePageButtons() {
+    const int pages = cnt_ > 4 ? (cnt_ + pageSize() - 1) / pageSize() : 0;
+    auto buttons = page_group_->buttons();
+    // Indicators shrink so 25 pages of a 100 people room still fit in one row
+    const int width = pages <= 6 ? 80 : std::max(12, 480 / pages);
+    for (int page = buttons.size(); page < pages; page++) {
+        auto button = new QPushButton(ui->pageControlWidget);
+        button->setCheckable(true);
+        page_group_->addButton(button, page);
+        // Keep the spacer after the buttons
+        static_cast<QBoxLayout*>(ui->pageControlWidget->layout())->insertWidget(page + 1, button);
+    }
+    buttons = page_group_->buttons();
+    for (auto button : buttons) {
+        auto page = page_group_->id(button);
+        button->setMinimumWidth(width);
+        button->setMaximumWidth(width);
+        button->setVisible(page < pages);
     }
-    cnt_ = 0;
-    first_video_index_ = 0;
-    ui->page1->setChecked(true);
 }
 
 void NormalVideoView::paintEvent(QPaintEvent *e) {
@@ -2,6 +2,11 @@
 
 #include "videocall/core/videocall_model.h"
 #include <QWidget>
+#include <memory>
+#include <vector>
+
+class QButtonGroup;
+class TileGrid;
 
 namespace Ui {
 class NormalVideoView;
@@ -9,7 +14,8 @@ class NormalVideoView;
 
 /**
 * Video rendering area class, user videos arranged in a grid layout, 
-* a maximum of 4 videos on one screen, and pages can be turned if there are more than 4
+* up to 4 users fill the view, larger rooms are paged with 2x2, 3x3 or 4x4 tiles per page.
+* Only the tiles of the current page exist, they are rebound to other users when the page turns
 */
 
 class NormalVideoView : public QWidget {
@@ -21,11 +27,21 @@ public:
     void showWidget(int cnt, bool forceUpdated = false);
     void showWidgetWithIndex(int firstIndex);
     void init();
+    // 2 to 4, a paged room on screen is paged again right away and keeps its first user in view
+    void setGridColumns(int columns);
 protected:
     void paintEvent(QPaintEvent* event);
 
 private:
+    int pageSize() const;
+    // The first count pooled tiles, bound by VideoCallManager::bindVideos
+    std::vector<QWidget*> boundTiles(int count) const;
+    void updatePageButtons();
+
     Ui::NormalVideoView* ui;
+    std::unique_ptr<TileGrid> grid_;
+    QButtonGroup* page_group_ = nullptr;
     int cnt_ = 0;
     int first_video_index_ = 0;
+    int columns_ = 3;
 };
@@ -106,7 +106,7 @@ bool ShareButtonBar::eventFilter(QObject *watched, QEvent *e) {
 void ShareButtonBar::initConnections() {
     connect(ui->btn_share, &QPushButton::clicked, this, [=] {
         auto cur_share_uid =
-            videocall::DataMgr::instance().room().screen_shared_uid;
+            videocall::DataMgr::instance().room()->screen_shared_uid;
         if (!cur_share_uid.empty() ) {
             vrd::util::showToastInfo(QObject::tr("switch_sharing").toStdString());
             return;
@@ -118,7 +118,7 @@ void ShareButtonBar::initConnections() {
         [=] { emit sigShareStateChanged(false); });
 
     connect(ui->btn_setting, &QPushButton::clicked, this, [=] {
-        if (videocall::DataMgr::instance().room().screen_shared_uid ==
+        if (videocall::DataMgr::instance().room()->screen_shared_uid ==
             videocall::DataMgr::instance().user_id()) {
             vrd::util::showToastInfo(QObject::tr("sharing_enter_settings").toStdString());
             return;
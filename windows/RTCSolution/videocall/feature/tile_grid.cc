@@ -0,0 +1,96 @@
+#include "tile_grid.h"
+
+#include <QGridLayout>
+#include <algorithm>
+
+namespace {
+
+int cellKey(int row, int column) {
+    return row << 16 | column;
+}
+
+}  // namespace
+
+TileGrid::TileGrid(QGridLayout* layout, QWidget* owner, VisibilityHandler on_visibility)
+    : layout_(layout), owner_(owner), on_visibility_(std::move(on_visibility)) {}
+
+void TileGrid::apply(const std::vector<QWidget*>& tiles, int columns, int min_cells) {
+    columns = std::max(1, columns);
+    const size_t cells = std::max(tiles.size(), static_cast<size_t>(std::max(0, min_cells)));
+    std::vector<QWidget*> target(tiles);
+    for (size_t i = 0; target.size() < cells; i++) {
+        if (i == placeholders_.size()) {
+            // Empty widget, only takes up space
+            auto placeholder = new QWidget(owner_);
+            placeholder->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+            placeholder->hide();
+            placeholders_.push_back(placeholder);
+        }
+        target.push_back(placeholders_[i]);
+    }
+
+    std::unordered_map<QWidget*, int> next;
+    for (size_t i = 0; i < target.size(); i++) {
+        next[target[i]] = cellKey(static_cast<int>(i) / columns, static_cast<int>(i) % columns);
+    }
+    std::vector<QWidget*> leaving;
+    for (const auto& entry : cells_) {
+        if (!next.count(entry.first)) leaving.push_back(entry.first);
+    }
+    for (auto widget : leaving) {
+        remove(widget);
+    }
+
+    for (size_t i = 0; i < target.size(); i++) {
+        auto widget = target[i];
+        auto cell = next[widget];
+        bool in_layout = placed(widget);
+        if (in_layout && cells_[widget] == cell) continue;
+        if (in_layout) {
+            layout_->removeWidget(widget);
+        }
+        layout_->addWidget(widget, cell >> 16, cell & 0xffff);
+        stats_.moves++;
+        if (!in_layout) {
+            widget->show();
+            if (on_visibility_ && !isPlaceholder(widget)) on_visibility_(widget, true);
+        }
+    }
+    cells_ = std::move(next);
+}
+
+void TileGrid::clear() {
+    std::vector<QWidget*> widgets;
+    for (const auto& entry : cells_) {
+        widgets.push_back(entry.first);
+    }
+    for (auto widget : widgets) {
+        remove(widget);
+    }
+    cells_.clear();
+}
+
+TileGrid::Stats TileGrid::stats() const {
+    auto stats = stats_;
+    stats.placeholders = placeholders_.size();
+    return stats;
+}
+
+bool TileGrid::placed(QWidget* widget) const {
+    // A tile reparented by another view has silently left the layout
+    return cells_.count(widget) && layout_->indexOf(widget) >= 0;
+}
+
+bool TileGrid::isPlaceholder(QWidget* widget) const {
+    return std::find(placeholders_.begin(), placeholders_.end(), widget) != placeholders_.end();
+}
+
+void TileGrid::remove(QWidget* widget) {
+    if (placed(widget)) {
+        layout_->removeWidget(widget);
+        widget->hide();
+        stats_.removals++;
+        if (on_visibility_ && !isPlaceholder(widget)) on_visibility_(widget, false);
+    }
+    cells_.erase(widget);
+}
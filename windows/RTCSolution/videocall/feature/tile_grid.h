@@ -0,0 +1,49 @@
+#pragma once
+#include <QWidget>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class QGridLayout;
+
+/**
+* Places tiles in a QGridLayout by diffing against the previous placement
+* Only tiles whose cell changed are removed and re-added, empty cells are filled from a pool of
+* placeholders owned by the view, so a long call never accumulates widgets
+*/
+class TileGrid {
+public:
+    struct Stats {
+        // Widgets added to the layout at a new cell
+        uint64_t moves = 0;
+        // Widgets taken out of the layout
+        uint64_t removals = 0;
+        size_t placeholders = 0;
+    };
+
+    // Called when a tile enters or leaves the grid, not for placeholders
+    using VisibilityHandler = std::function<void(QWidget* tile, bool shown)>;
+
+    TileGrid(QGridLayout* layout, QWidget* owner, VisibilityHandler on_visibility);
+
+    // Tile i goes to cell i, row by row, cells beyond the tiles up to min_cells get a placeholder
+    void apply(const std::vector<QWidget*>& tiles, int columns, int min_cells);
+    // Takes everything out of the layout
+    void clear();
+    Stats stats() const;
+
+private:
+    bool placed(QWidget* widget) const;
+    bool isPlaceholder(QWidget* widget) const;
+    void remove(QWidget* widget);
+
+    QGridLayout* layout_;
+    QWidget* owner_;
+    VisibilityHandler on_visibility_;
+    // Current cell of every widget in the layout, row << 16 | column
+    std::unordered_map<QWidget*, int> cells_;
+    std::vector<QWidget*> placeholders_;
+    Stats stats_;
+};
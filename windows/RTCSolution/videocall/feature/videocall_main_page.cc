@@ -47,16 +47,9 @@ VideoCallMainPage::~VideoCallMainPage() {
 }
 
 void VideoCallMainPage::updateVideoWidget() {
-    auto vec = videocall::DataMgr::instance().users();
-    for (size_t i = 0; i < vec.size(); i++) {
-        if (vec[i].user_id == videocall::DataMgr::instance().user_id()) {
-            videocall::VideoCallManager::setLocalVideoWidget(vec[i], i);
-        }
-        else {
-            videocall::VideoCallManager::setRemoteVideoWidget(vec[i], i);
-        }
-    }
-    showWidget(vec.size());
+    // Only the tiles on screen are bound, the views pick the range when the count changes
+    videocall::VideoCallManager::refreshVideos();
+    showWidget(videocall::DataMgr::instance().participants().size());
 }
 
 void VideoCallMainPage::showWidget(int cnt) {
@@ -77,7 +70,7 @@ void VideoCallMainPage::init() {
     setMicState(!videocall::DataMgr::instance().mute_audio());
     setBasicBeauty(true);
 
-    tick_count_ = videocall::DataMgr::instance().room().duration;
+    tick_count_ = videocall::DataMgr::instance().room()->duration;
     const auto& roomId = videocall::DataMgr::instance().room_id();
     auto find_pos = roomId.find("call_");
     if (find_pos != std::string::npos) {
@@ -119,10 +112,15 @@ void VideoCallMainPage::changeViewMode(int mode) {
     updateVideoWidget();
     if (current_page_ == kNormalPage) {
         static_cast<NormalVideoView*>(ui->stackedWidget->widget(current_page_))
-            ->showWidget(videocall::DataMgr::instance().users().size(), true);
+            ->showWidget(videocall::DataMgr::instance().participants().size(), true);
     }
 }
 
+void VideoCallMainPage::setGridColumns(int columns) {
+    static_cast<NormalVideoView*>(ui->stackedWidget->widget(VideoCallMainPage::kNormalPage))
+        ->setGridColumns(columns);
+}
+
 int VideoCallMainPage::viewMode() { 
     return current_page_; 
 }
@@ -178,7 +176,7 @@ void VideoCallMainPage::initConnections() {
 
     connect(ui->shareBtn, &QToolButton::clicked, this, [=] {
         auto cur_share_uid =
-            videocall::DataMgr::instance().room().screen_shared_uid;
+            videocall::DataMgr::instance().room()->screen_shared_uid;
         if (!cur_share_uid.empty() &&
                 cur_share_uid != videocall::DataMgr::instance().user_id()) {
             vrd::util::showToastInfo(QObject::tr("grab_sharing").toStdString());
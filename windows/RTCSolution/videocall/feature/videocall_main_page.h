@@ -28,6 +28,8 @@ public:
 	void setCameraState(bool on);
 	void setMicState(bool on);
 	void setBasicBeauty(bool enabled);
+	// Page size of the gallery, see NormalVideoView::setGridColumns
+	void setGridColumns(int columns);
 
 signals:
 	void sigClose();
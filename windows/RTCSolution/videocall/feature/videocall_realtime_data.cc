@@ -44,37 +44,36 @@ void VideoCallData::initView() {
         delete child;
     }
 
-    auto& localInfo = videocall::DataMgr::instance().ref_local_stream_info();
-    localInfo.user_id = videocall::DataMgr::instance().user_id();
-    localInfo.user_name = videocall::DataMgr::instance().user_name();
+    videocall::DataMgr::instance().updateLocalStreamInfo([](videocall::StreamInfo& info) {
+        info.user_id = videocall::DataMgr::instance().user_id();
+        info.user_name = videocall::DataMgr::instance().user_name();
+    });
     auto localDataWidget = new realTimeDataUnit(this);
-    localDataWidget->updateInfo(localInfo, mIsVideoInfo);
+    localDataWidget->updateInfo(*videocall::DataMgr::instance().local_stream_info(), mIsVideoInfo);
     m_infos[videocall::DataMgr::instance().user_id()] = localDataWidget;
     ui->content_widget->layout()->addWidget(localDataWidget);
 
-    auto remoteStreamInfos = videocall::DataMgr::instance().remote_stream_infos();
-    for (auto& info : remoteStreamInfos) {
+    const auto self = videocall::DataMgr::instance().user_handle();
+    videocall::DataMgr::instance().participants().forEach([this, self](const videocall::Participant& participant) {
+        if (participant.user.user_handle == self) return;
         auto remoteInfoWidget = new realTimeDataUnit(this);
-        remoteInfoWidget->updateInfo(info, mIsVideoInfo);
-        m_infos[info.user_id] = remoteInfoWidget;
+        remoteInfoWidget->updateInfo(participant.stats, mIsVideoInfo);
+        m_infos[participant.stats.user_id] = remoteInfoWidget;
         ui->content_widget->layout()->addWidget(remoteInfoWidget);
-    }
+    });
 }
 
 void VideoCallData::updateData(const std::string& uid) {
     if (this->isVisible() && m_infos.contains(uid)) {
-        auto remoteStreamInfos = videocall::DataMgr::instance().remote_stream_infos();
-        auto iter = std::find_if(remoteStreamInfos.begin(), 
-            remoteStreamInfos.end(), [uid](const videocall::StreamInfo& streamInfo) {
-            return streamInfo.user_id == uid;
-            });
-        if (iter != remoteStreamInfos.end()) {
-            m_infos[uid]->updateInfo(*iter, mIsVideoInfo);
-        }
-
         if (uid == videocall::DataMgr::instance().user_id()) {
             auto localInfo = videocall::DataMgr::instance().local_stream_info();
-            m_infos[localInfo.user_id]->updateInfo(localInfo, mIsVideoInfo);
+            m_infos[localInfo->user_id]->updateInfo(*localInfo, mIsVideoInfo);
+            return;
+        }
+        auto participant = videocall::DataMgr::instance().participants().find(
+            vrd::IdTable::instance().find(uid));
+        if (participant) {
+            m_infos[uid]->updateInfo(participant->stats, mIsVideoInfo);
         }
     }
 }
@@ -82,13 +81,14 @@ void VideoCallData::updateData(const std::string& uid) {
 void VideoCallData::updateData() {
     if (this->isVisible()) {
         auto localInfo = videocall::DataMgr::instance().local_stream_info();
-        m_infos[localInfo.user_id]->updateInfo(localInfo, mIsVideoInfo);
+        m_infos[localInfo->user_id]->updateInfo(*localInfo, mIsVideoInfo);
 
-        auto remoteStreamInfos = videocall::DataMgr::instance().remote_stream_infos();
-        for (auto& info : remoteStreamInfos) {
-            if(m_infos.contains(info.user_id))
-            m_infos[info.user_id]->updateInfo(info, mIsVideoInfo);
-        }
+        const auto self = videocall::DataMgr::instance().user_handle();
+        videocall::DataMgr::instance().participants().forEach([this, self](const videocall::Participant& participant) {
+            const auto& info = participant.stats;
+            if (participant.user.user_handle != self && m_infos.contains(info.user_id))
+                m_infos[info.user_id]->updateInfo(info, mIsVideoInfo);
+        });
     }
 }
 
@@ -1,6 +1,8 @@
 ﻿#include "videocall_setting.h"
 #include "ui_videocall_setting.h"
 
+#include <algorithm>
+
 #include <QCloseEvent>
 #include <QDateTime>
 #include <QDesktopServices>
@@ -55,6 +57,7 @@ VideoCallSetting::VideoCallSetting(QWidget* parent)
 
     set_combobox(ui->cmb_quality);
     set_combobox(ui->cmb_resolution);
+    set_combobox(ui->cmb_grid);
 
     auto set_resoultion_data = [](QComboBox* cmb) {
         for (auto item : video_resolutions) {
@@ -73,8 +76,16 @@ VideoCallSetting::VideoCallSetting(QWidget* parent)
         }
     };
 
+    // Tiles per page once the room has more than 4 people
+    auto set_grid_data = [](QComboBox* cmb) {
+        for (int columns = 2; columns <= 4; columns++) {
+            cmb->addItem(QString("%1*%1").arg(columns), columns);
+        }
+    };
+
     set_resoultion_data(ui->cmb_resolution);
     set_quality_data(ui->cmb_quality);
+    set_grid_data(ui->cmb_grid);
     initConnect();
 }
 
@@ -108,6 +119,11 @@ void VideoCallSetting::initConnect() {
                 static_cast<videocall::AudioQuality>(ui->cmb_quality->currentIndex());
         });
 
+    connect(ui->cmb_grid, QOverload<int>::of(&QComboBox::currentIndexChanged),
+        this, [=](int idx) {
+            setting_.grid_columns = ui->cmb_grid->currentData().toInt();
+        });
+
     connect(ui->mirror_camera_btn, &CheckButton::sigChecked, this,
         [=](bool checked) { setting_.enable_camera_mirror = checked; });
 }
@@ -119,13 +135,15 @@ void VideoCallSetting::initUITranslations() {
     ui->lbl_resolutions->setText(QObject::tr("resolution"));
     ui->lbl_quality->setText(QObject::tr("call_sound_quality"));
     ui->lbl_mirror_camera->setText(QObject::tr("local_mirror"));
+    ui->lbl_grid->setText(QObject::tr("gallery_layout"));
 }
 
 void VideoCallSetting::initView() {
-    setting_ = videocall::DataMgr::instance().setting();
+    setting_ = *videocall::DataMgr::instance().setting();
     ui->cmb_quality->setCurrentIndex(static_cast<int>(setting_.audio_quality));
     ui->mirror_camera_btn->setChecked(setting_.enable_camera_mirror);
     ui->cmb_resolution->setCurrentIndex(getIdxFromResolution(setting_.camera.resolution));
+    ui->cmb_grid->setCurrentIndex(std::max(0, ui->cmb_grid->findData(setting_.grid_columns)));
 }
 
 VideoCallSetting::~VideoCallSetting() { 
@@ -8,7 +8,7 @@ namespace Ui {
 }
 
 /**
-* Audio and video call setting page, used to set resolution, audio quality, mirroring or not
+* Audio and video call setting page, used to set resolution, audio quality, gallery page size, mirroring or not
 */
 class VideoCallSetting : public QDialog {
     Q_OBJECT
@@ -7,6 +7,7 @@
 #include "videocall/core/videocall_session.h"
 #include "videocall/core/data_mgr.h"
 #include "core/component/share_view_wnd.h"
+#include "core/thumbnail_provider.h"
 
 #include <QDebug>
 
@@ -17,6 +18,15 @@ VideoCallShareWidget::VideoCallShareWidget(QWidget* parent)
     setWindowFlags(Qt::Dialog | Qt::FramelessWindowHint);
     ui->screen_views->setMinimumWidth(width());
     ui->window_views->setMinimumWidth(width());
+    connect(&vrd::ThumbnailProvider::instance(), &vrd::ThumbnailProvider::sigThumbnailReady, this,
+        [=](uint64_t request, int index, QImage image) {
+            if (request != thumbnail_request_ || index >= static_cast<int>(thumbnail_slots_.size())) {
+                return;
+            }
+            auto slot = thumbnail_slots_[index];
+            auto container = slot.first ? ui->screen_views : ui->window_views;
+            container->updateItem(slot.second, QPixmap::fromImage(image));
+        });
     updateData();
     connect(ui->btn_close, &QPushButton::clicked, this, [=] { this->reject(); });
     connect(ui->screen_views, &ShareViewContainer::sigItemPressed, this,
@@ -31,9 +41,9 @@ VideoCallShareWidget::VideoCallShareWidget(QWidget* parent)
                     vrd::util::showToastInfo(QObject::tr("somebody_is_sharing_screen").toStdString());
                     return;
                 }
-                auto r = videocall::DataMgr::instance().room();
-                r.screen_shared_uid = videocall::DataMgr::instance().user_id();
-                videocall::DataMgr::instance().setRoom(std::move(r));
+                videocall::DataMgr::instance().updateRoom([](videocall::VideoCallRoom& room) {
+                    room.screen_shared_uid = videocall::DataMgr::instance().user_id();
+                });
                 std::vector<void*> excluded;
                 VideoCallRtcEngineWrap::instance().startScreenCapture(
                     attr.source_id, excluded);
@@ -55,9 +65,9 @@ VideoCallShareWidget::VideoCallShareWidget(QWidget* parent)
                     vrd::util::showToastInfo(QObject::tr("somebody_is_sharing_screen").toStdString());
                     return;
                 }
-                auto r = videocall::DataMgr::instance().room();
-                r.screen_shared_uid = videocall::DataMgr::instance().user_id();
-                videocall::DataMgr::instance().setRoom(std::move(r));
+                videocall::DataMgr::instance().updateRoom([](videocall::VideoCallRoom& room) {
+                    room.screen_shared_uid = videocall::DataMgr::instance().user_id();
+                });
                 VideoCallRtcEngineWrap::instance().startScreenCaptureByWindowId(
                     attr.source_id);
                 VideoCallRtcEngineWrap::instance().startScreenAudioCapture();
@@ -67,6 +77,7 @@ VideoCallShareWidget::VideoCallShareWidget(QWidget* parent)
 }
 
 VideoCallShareWidget::~VideoCallShareWidget() { 
+    vrd::ThumbnailProvider::instance().cancel(thumbnail_request_);
     delete ui; 
 }
 
@@ -75,23 +86,30 @@ void VideoCallShareWidget::updateData() {
     VideoCallRtcEngineWrap::getShareList(vec);
     ui->screen_views->clear();
     ui->window_views->clear();
-    for (auto& attr : vec) {
+
+    // Cached thumbnails show up right away, the rest are filled in as the captures finish
+    std::vector<QImage> cached;
+    thumbnail_request_ = vrd::ThumbnailProvider::instance().request(vec, 160, 90, cached);
+    thumbnail_slots_.clear();
+    int screen_count = 0;
+    int window_count = 0;
+    for (size_t i = 0; i < vec.size(); i++) {
+        auto& attr = vec[i];
+        auto pixmap = cached[i].isNull() ? QPixmap() : QPixmap::fromImage(cached[i]);
         if (attr.type == SnapshotAttr::kScreen) {
-            ui->screen_views->addItem(attr,
-                std::move(VideoCallRtcEngineWrap::getThumbnail(
-                    attr.type, attr.source_id, 160, 90)));
+            thumbnail_slots_.emplace_back(true, screen_count++);
+            ui->screen_views->addItem(attr, std::move(pixmap));
         }
         else {
-            ui->window_views->addItem(attr,
-                std::move(VideoCallRtcEngineWrap::getThumbnail(
-                    attr.type, attr.source_id, 160, 90)));
+            thumbnail_slots_.emplace_back(false, window_count++);
+            ui->window_views->addItem(attr, std::move(pixmap));
         }
     }
 }
 
 bool VideoCallShareWidget::canStartSharing() {
     auto cur_share_uid =
-        videocall::DataMgr::instance().room().screen_shared_uid;
+        videocall::DataMgr::instance().room()->screen_shared_uid;
     if (!cur_share_uid.empty() &&
         cur_share_uid != videocall::DataMgr::instance().user_id()) {
         vrd::util::showToastInfo(QObject::tr("grab_sharing").toStdString());
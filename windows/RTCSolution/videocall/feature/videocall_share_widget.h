@@ -1,6 +1,9 @@
 #pragma once
 
 #include <QDialog>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 namespace Ui {
     class VideoCallShareWidget;
@@ -23,5 +26,8 @@ private:
     void initTranslations();
 
     Ui::VideoCallShareWidget *ui;
+    uint64_t thumbnail_request_ = 0;
+    // Position of each requested source in its container, screens and windows are numbered separately
+    std::vector<std::pair<bool, int>> thumbnail_slots_;
 };
 
@@ -78,6 +78,10 @@
 		<source>local_mirror</source>
 		<translation>Mirroring</translation>
 	</message>
+	<message>
+		<source>gallery_layout</source>
+		<translation>Gallery</translation>
+	</message>
 	<message>
 		<source>leave_room</source>
 		<translation>Are you going to leave the room?</translation>
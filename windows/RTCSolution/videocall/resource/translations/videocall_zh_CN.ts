@@ -78,6 +78,10 @@
 		<source>local_mirror</source>
 		<translation>本地镜像</translation>
 	</message>
+	<message>
+		<source>gallery_layout</source>
+		<translation>宫格布局</translation>
+	</message>
 	<message>
 		<source>leave_room</source>
 		<translation>请再次确认是否要离开房间？</translation>
@@ -41,6 +41,8 @@ void VideoCallModule::open() {
     videocall::DataMgr::init();
     videocall::DataMgr::instance().setUserName(vrd::DataMgr::instance().user_name());
     videocall::DataMgr::instance().setUserID(vrd::DataMgr::instance().user_id());
+    videocall::DataMgr::instance().setUserHandle(
+        vrd::IdTable::instance().intern(vrd::DataMgr::instance().user_id()));
 
     vrd::VideoCallSession::instance().initSceneConfig([]() {
         VideoCallRtcEngineWrap::init();